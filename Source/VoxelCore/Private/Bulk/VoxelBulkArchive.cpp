@@ -131,7 +131,12 @@ bool FVoxelBulkArchive::GatherHashes_RequiresLock(
 	checkVoxelSlow(HashToMetadata_CriticalSection.IsLocked_Read());
 
 	Hashes.Reserve(16384);
-	HashToBulkPtr.Reserve(1024);
+
+	// HashToBulkPtr is built at the end, Hashes ensures there are no duplicates
+	TVoxelArray<FVoxelBulkHash> LoadedHashes;
+	TVoxelArray<FVoxelBulkPtr> LoadedBulkPtrs;
+	LoadedHashes.Reserve(1024);
+	LoadedBulkPtrs.Reserve(1024);
 
 	TVoxelArray<FVoxelBulkPtr> BulkPtrQueue;
 	BulkPtrQueue.Reserve(256);
@@ -198,7 +203,8 @@ bool FVoxelBulkArchive::GatherHashes_RequiresLock(
 			return false;
 		}
 
-		HashToBulkPtr.Add_EnsureNew(BulkPtr.GetHash(), BulkPtr);
+		LoadedHashes.Add(BulkPtr.GetHash());
+		LoadedBulkPtrs.Add(BulkPtr);
 
 		for (const FVoxelBulkPtr& Dependency : BulkPtr.GetDependencies())
 		{
@@ -210,6 +216,9 @@ bool FVoxelBulkArchive::GatherHashes_RequiresLock(
 		}
 	}
 
+	HashToBulkPtr.BuildFromArrays(LoadedHashes, LoadedBulkPtrs);
+	ensure(HashToBulkPtr.Num() == LoadedHashes.Num());
+
 	if (VOXEL_DEBUG)
 	{
 		for (const FVoxelBulkHash& Hash : Hashes)
@@ -262,259 +262,299 @@ void FVoxelAABBTree::Initialize(FElementArray&& Elements)
 			FVector3f(RootNode.MaxX, RootNode.MaxY, RootNode.MaxZ));
 	}
 
-	int32 Depth = 0;
-	while (NewNodesToProcess.Num() > 0)
+	struct FSplit
 	{
-		//VOXEL_SCOPE_COUNTER_FORMAT("Depth %d Nodes=%d", Depth, NewNodesToProcess.Num());
-		Depth++;
-
-		Swap(NewNodesToProcess, LastNodesToProcess);
-		NewNodesToProcess.Reset();
+		bool bIsLeaf = true;
+		FNodeToProcess Child0;
+		FNodeToProcess Child1;
+	};
 
-		for (FNodeToProcess& Parent : LastNodesToProcess)
+	const auto SplitNode = [&](const FNodeToProcess& Parent, FSplit& Split)
+	{
+		if (Parent.Num() <= MaxChildrenInLeaf ||
+			Parent.NodeLevel >= MaxTreeDepth)
 		{
-			Nodes.ReserveGrow(2);
+			Split.bIsLeaf = true;
+			return;
+		}
 
-			// Check Node will not be invalidated
-			const int32 CurrentNodesMax = Nodes.Max();
-			ON_SCOPE_EXIT
+		const EVoxelAxis SplitAxis = INLINE_LAMBDA
+		{
+			if (Parent.VarianceX > Parent.VarianceY &&
+				Parent.VarianceX > Parent.VarianceZ)
 			{
-				checkVoxelSlow(CurrentNodesMax == Nodes.Max());
-			};
-
-			FNode& ParentNode = Nodes[Parent.NodeIndex];
-
-			if (Parent.Num() <= MaxChildrenInLeaf ||
-				Parent.NodeLevel >= MaxTreeDepth)
+				return EVoxelAxis::X;
+			}
+			else if (Parent.VarianceY > Parent.VarianceZ)
 			{
-				ParentNode.bLeaf = true;
-				ParentNode.LeafIndex = Leaves.Add(FLeaf
-				{
-					Parent.StartIndex,
-					Parent.EndIndex
-				});
-				continue;
+				return EVoxelAxis::Y;
 			}
+			else
+			{
+				return EVoxelAxis::Z;
+			}
+		};
 
-			FNodeToProcess& Child0 = NewNodesToProcess.Emplace_GetRef();
-			FNodeToProcess& Child1 = NewNodesToProcess.Emplace_GetRef();
-
-			Child0.NodeIndex = Nodes.Emplace_EnsureNoGrow();
-			Child1.NodeIndex = Nodes.Emplace_EnsureNoGrow();
-
-			const EVoxelAxis SplitAxis = INLINE_LAMBDA
+		const float SplitValue = INLINE_LAMBDA
+		{
+			switch (SplitAxis)
 			{
-				if (Parent.VarianceX > Parent.VarianceY &&
-					Parent.VarianceX > Parent.VarianceZ)
-				{
-					return EVoxelAxis::X;
-				}
-				else if (Parent.VarianceY > Parent.VarianceZ)
-				{
-					return EVoxelAxis::Y;
-				}
-				else
-				{
-					return EVoxelAxis::Z;
-				}
-			};
+			default: VOXEL_ASSUME(false);
+			case EVoxelAxis::X: return Parent.AverageX;
+			case EVoxelAxis::Y: return Parent.AverageY;
+			case EVoxelAxis::Z: return Parent.AverageZ;
+			}
+		};
 
-			const float SplitValue = INLINE_LAMBDA
+		const TConstVoxelArrayView<float> Min = INLINE_LAMBDA -> TConstVoxelArrayView<float>
+		{
+			switch (SplitAxis)
 			{
-				switch (SplitAxis)
-				{
-				default: VOXEL_ASSUME(false);
-				case EVoxelAxis::X: return Parent.AverageX;
-				case EVoxelAxis::Y: return Parent.AverageY;
-				case EVoxelAxis::Z: return Parent.AverageZ;
-				}
-			};
+			default: VOXEL_ASSUME(false);
+			case EVoxelAxis::X: return Elements.MinX;
+			case EVoxelAxis::Y: return Elements.MinY;
+			case EVoxelAxis::Z: return Elements.MinZ;
+			}
+		};
 
-			const TConstVoxelArrayView<float> Min = INLINE_LAMBDA -> TConstVoxelArrayView<float>
+		const TConstVoxelArrayView<float> Max = INLINE_LAMBDA -> TConstVoxelArrayView<float>
+		{
+			switch (SplitAxis)
 			{
-				switch (SplitAxis)
-				{
-				default: VOXEL_ASSUME(false);
-				case EVoxelAxis::X: return Elements.MinX;
-				case EVoxelAxis::Y: return Elements.MinY;
-				case EVoxelAxis::Z: return Elements.MinZ;
-				}
-			};
+			default: VOXEL_ASSUME(false);
+			case EVoxelAxis::X: return Elements.MaxX;
+			case EVoxelAxis::Y: return Elements.MaxY;
+			case EVoxelAxis::Z: return Elements.MaxZ;
+			}
+		};
+
+		FNodeToProcess& Child0 = Split.Child0;
+		FNodeToProcess& Child1 = Split.Child1;
 
-			const TConstVoxelArrayView<float> Max = INLINE_LAMBDA -> TConstVoxelArrayView<float>
+		{
+			const float SplitValueTimes2 = SplitValue * 2.f;
+
+			const auto Is0 = [&](const int32 Index)
 			{
-				switch (SplitAxis)
-				{
-				default: VOXEL_ASSUME(false);
-				case EVoxelAxis::X: return Elements.MaxX;
-				case EVoxelAxis::Y: return Elements.MaxY;
-				case EVoxelAxis::Z: return Elements.MaxZ;
-				}
+				// return (Min[Index] + Max[Index]) / 2.f <= SplitValue;
+				return Min[Index] + Max[Index] <= SplitValueTimes2;
 			};
 
+			int32 SplitIndex;
+			if (Parent.Num() < 32)
 			{
-				const float SplitValueTimes2 = SplitValue * 2.f;
+				int32 Index0 = Parent.StartIndex;
+				int32 Index1 = Parent.EndIndex - 1;
 
-				const auto Is0 = [&](const int32 Index)
+				while (Index0 < Index1)
 				{
-					// return (Min[Index] + Max[Index]) / 2.f <= SplitValue;
-					return Min[Index] + Max[Index] <= SplitValueTimes2;
-				};
-
-				int32 SplitIndex;
-				if (Parent.Num() < 32)
-				{
-					int32 Index0 = Parent.StartIndex;
-					int32 Index1 = Parent.EndIndex - 1;
-
-					while (Index0 < Index1)
+					if (Is0(Index0))
 					{
-						if (Is0(Index0))
-						{
-							Index0++;
-							continue;
-						}
-						if (!Is0(Index1))
-						{
-							Index1--;
-							continue;
-						}
-
-						checkVoxelSlow(!Is0(Index0));
-						checkVoxelSlow(Is0(Index1));
+						Index0++;
+						continue;
+					}
+					if (!Is0(Index1))
+					{
+						Index1--;
+						continue;
+					}
 
-						checkVoxelSlow(Index0 != Index1);
+					checkVoxelSlow(!Is0(Index0));
+					checkVoxelSlow(Is0(Index1));
 
-						Swap(Elements.Payload[Index0], Elements.Payload[Index1]);
-						Swap(Elements.MinX[Index0], Elements.MinX[Index1]);
-						Swap(Elements.MinY[Index0], Elements.MinY[Index1]);
-						Swap(Elements.MinZ[Index0], Elements.MinZ[Index1]);
-						Swap(Elements.MaxX[Index0], Elements.MaxX[Index1]);
-						Swap(Elements.MaxY[Index0], Elements.MaxY[Index1]);
-						Swap(Elements.MaxZ[Index0], Elements.MaxZ[Index1]);
+					checkVoxelSlow(Index0 != Index1);
 
-						checkVoxelSlow(Is0(Index0));
-						checkVoxelSlow(!Is0(Index1));
+					Swap(Elements.Payload[Index0], Elements.Payload[Index1]);
+					Swap(Elements.MinX[Index0], Elements.MinX[Index1]);
+					Swap(Elements.MinY[Index0], Elements.MinY[Index1]);
+					Swap(Elements.MinZ[Index0], Elements.MinZ[Index1]);
+					Swap(Elements.MaxX[Index0], Elements.MaxX[Index1]);
+					Swap(Elements.MaxY[Index0], Elements.MaxY[Index1]);
+					Swap(Elements.MaxZ[Index0], Elements.MaxZ[Index1]);
 
-						Index0++;
-						Index1--;
-					}
+					checkVoxelSlow(Is0(Index0));
+					checkVoxelSlow(!Is0(Index1));
 
-					SplitIndex = Is0(Index0) ? Index0 + 1 : Index0;
-				}
-				else
-				{
-					SplitIndex = INLINE_LAMBDA
-					{
-						switch (SplitAxis)
-						{
-						default: VOXEL_ASSUME(false);
-						case EVoxelAxis::X:
-						{
-							return ispc::VoxelAABBTree_Split_X(
-								Elements.Payload.GetData(),
-								Elements.MinX.GetData(),
-								Elements.MinY.GetData(),
-								Elements.MinZ.GetData(),
-								Elements.MaxX.GetData(),
-								Elements.MaxY.GetData(),
-								Elements.MaxZ.GetData(),
-								SplitValue,
-								Parent.StartIndex,
-								Parent.EndIndex,
-								Elements.Max());
-						}
-						case EVoxelAxis::Y:
-						{
-							return ispc::VoxelAABBTree_Split_X(
-								Elements.Payload.GetData(),
-								Elements.MinY.GetData(),
-								Elements.MinZ.GetData(),
-								Elements.MinX.GetData(),
-								Elements.MaxY.GetData(),
-								Elements.MaxZ.GetData(),
-								Elements.MaxX.GetData(),
-								SplitValue,
-								Parent.StartIndex,
-								Parent.EndIndex,
-								Elements.Max());
-						}
-						case EVoxelAxis::Z:
-						{
-							return ispc::VoxelAABBTree_Split_X(
-								Elements.Payload.GetData(),
-								Elements.MinZ.GetData(),
-								Elements.MinX.GetData(),
-								Elements.MinY.GetData(),
-								Elements.MaxZ.GetData(),
-								Elements.MaxX.GetData(),
-								Elements.MaxY.GetData(),
-								SplitValue,
-								Parent.StartIndex,
-								Parent.EndIndex,
-								Elements.Max());
-						}
-						}
-					};
+					Index0++;
+					Index1--;
 				}
 
-				if (VOXEL_DEBUG)
+				SplitIndex = Is0(Index0) ? Index0 + 1 : Index0;
+			}
+			else
+			{
+				SplitIndex = INLINE_LAMBDA
 				{
-					for (int32 Index = Parent.StartIndex; Index < SplitIndex; Index++)
+					switch (SplitAxis)
 					{
-						check(Is0(Index));
+					default: VOXEL_ASSUME(false);
+					case EVoxelAxis::X:
+					{
+						return ispc::VoxelAABBTree_Split_X(
+							Elements.Payload.GetData(),
+							Elements.MinX.GetData(),
+							Elements.MinY.GetData(),
+							Elements.MinZ.GetData(),
+							Elements.MaxX.GetData(),
+							Elements.MaxY.GetData(),
+							Elements.MaxZ.GetData(),
+							SplitValue,
+							Parent.StartIndex,
+							Parent.EndIndex,
+							Elements.Max());
 					}
-					for (int32 Index = SplitIndex; Index < Parent.EndIndex; Index++)
+					case EVoxelAxis::Y:
 					{
-						check(!Is0(Index));
+						return ispc::VoxelAABBTree_Split_X(
+							Elements.Payload.GetData(),
+							Elements.MinY.GetData(),
+							Elements.MinZ.GetData(),
+							Elements.MinX.GetData(),
+							Elements.MaxY.GetData(),
+							Elements.MaxZ.GetData(),
+							Elements.MaxX.GetData(),
+							SplitValue,
+							Parent.StartIndex,
+							Parent.EndIndex,
+							Elements.Max());
 					}
-				}
-
-				Child0.StartIndex = Parent.StartIndex;
-				Child0.EndIndex = SplitIndex;
-
-				Child1.StartIndex = SplitIndex;
-				Child1.EndIndex = Parent.EndIndex;
+					case EVoxelAxis::Z:
+					{
+						return ispc::VoxelAABBTree_Split_X(
+							Elements.Payload.GetData(),
+							Elements.MinZ.GetData(),
+							Elements.MinX.GetData(),
+							Elements.MinY.GetData(),
+							Elements.MaxZ.GetData(),
+							Elements.MaxX.GetData(),
+							Elements.MaxY.GetData(),
+							SplitValue,
+							Parent.StartIndex,
+							Parent.EndIndex,
+							Elements.Max());
+					}
+					}
+				};
 			}
 
-			// Failed to split
-			if (Child0.Num() == 0 ||
-				Child1.Num() == 0)
+			if (VOXEL_DEBUG)
 			{
-#if VOXEL_DEBUG
-				TVoxelSet<FVoxelBox> Elements0;
-				TVoxelSet<FVoxelBox> Elements1;
-				for (int32 Index = Child0.StartIndex; Index < Child0.EndIndex; Index++)
+				for (int32 Index = Parent.StartIndex; Index < SplitIndex; Index++)
 				{
-					Elements0.Add(FVoxelBox(
-						FVector3f(Elements.MinX[Index], Elements.MinY[Index], Elements.MinZ[Index]),
-						FVector3f(Elements.MaxX[Index], Elements.MaxY[Index], Elements.MaxZ[Index])));
+					check(Is0(Index));
 				}
-				for (int32 Index = Child1.StartIndex; Index < Child1.EndIndex; Index++)
+				for (int32 Index = SplitIndex; Index < Parent.EndIndex; Index++)
 				{
-					Elements1.Add(FVoxelBox(
-						FVector3f(Elements.MinX[Index], Elements.MinY[Index], Elements.MinZ[Index]),
-						FVector3f(Elements.MaxX[Index], Elements.MaxY[Index], Elements.MaxZ[Index])));
+					check(!Is0(Index));
 				}
-				ensure(
-					Elements0.Num() != Child0.Num() ||
-					Elements1.Num() != Child1.Num());
+			}
+
+			Child0.StartIndex = Parent.StartIndex;
+			Child0.EndIndex = SplitIndex;
+
+			Child1.StartIndex = SplitIndex;
+			Child1.EndIndex = Parent.EndIndex;
+		}
+
+		// Failed to split
+		if (Child0.Num() == 0 ||
+			Child1.Num() == 0)
+		{
+#if VOXEL_DEBUG
+			TVoxelSet<FVoxelBox> Elements0;
+			TVoxelSet<FVoxelBox> Elements1;
+			for (int32 Index = Child0.StartIndex; Index < Child0.EndIndex; Index++)
+			{
+				Elements0.Add(FVoxelBox(
+					FVector3f(Elements.MinX[Index], Elements.MinY[Index], Elements.MinZ[Index]),
+					FVector3f(Elements.MaxX[Index], Elements.MaxY[Index], Elements.MaxZ[Index])));
+			}
+			for (int32 Index = Child1.StartIndex; Index < Child1.EndIndex; Index++)
+			{
+				Elements1.Add(FVoxelBox(
+					FVector3f(Elements.MinX[Index], Elements.MinY[Index], Elements.MinZ[Index]),
+					FVector3f(Elements.MaxX[Index], Elements.MaxY[Index], Elements.MaxZ[Index])));
+			}
+			ensure(
+				Elements0.Num() != Child0.Num() ||
+				Elements1.Num() != Child1.Num());
 #endif
 
+			Split.bIsLeaf = true;
+			return;
+		}
+
+		Child0.ComputeVariance(Elements);
+		Child1.ComputeVariance(Elements);
+
+		Split.bIsLeaf = false;
+	};
+
+	TVoxelArray<FSplit> Splits;
+
+	int32 Depth = 0;
+	while (NewNodesToProcess.Num() > 0)
+	{
+		//VOXEL_SCOPE_COUNTER_FORMAT("Depth %d Nodes=%d", Depth, NewNodesToProcess.Num());
+		Depth++;
+
+		Swap(NewNodesToProcess, LastNodesToProcess);
+		NewNodesToProcess.Reset();
+
+		Splits.Reset();
+		Splits.SetNum(LastNodesToProcess.Num());
+
+		// Nodes of the same level own disjoint element ranges and can be split in parallel
+		// Only worth it on the top levels, where nodes are few but large
+		const int32 AverageNodeSize = NumElements / LastNodesToProcess.Num();
+		if (LastNodesToProcess.Num() > 1 &&
+			AverageNodeSize >= 4096)
+		{
+			Voxel::ParallelFor(Splits, [&](FSplit& Split, const int32 Index)
+			{
+				SplitNode(LastNodesToProcess[Index], Split);
+			});
+		}
+		else
+		{
+			for (int32 Index = 0; Index < Splits.Num(); Index++)
+			{
+				SplitNode(LastNodesToProcess[Index], Splits[Index]);
+			}
+		}
+
+		for (int32 Index = 0; Index < Splits.Num(); Index++)
+		{
+			const FNodeToProcess& Parent = LastNodesToProcess[Index];
+			const FSplit& Split = Splits[Index];
+
+			Nodes.ReserveGrow(2);
+
+			// Check Node will not be invalidated
+			const int32 CurrentNodesMax = Nodes.Max();
+			ON_SCOPE_EXIT
+			{
+				checkVoxelSlow(CurrentNodesMax == Nodes.Max());
+			};
+
+			FNode& ParentNode = Nodes[Parent.NodeIndex];
+
+			if (Split.bIsLeaf)
+			{
 				ParentNode.bLeaf = true;
 				ParentNode.LeafIndex = Leaves.Add(FLeaf
 				{
 					Parent.StartIndex,
 					Parent.EndIndex
 				});
-
-				NewNodesToProcess.Pop_Discard();
-				NewNodesToProcess.Pop_Discard();
 				continue;
 			}
 
-			Child0.ComputeVariance(Elements);
-			Child1.ComputeVariance(Elements);
+			FNodeToProcess& Child0 = NewNodesToProcess.Emplace_GetRef(Split.Child0);
+			FNodeToProcess& Child1 = NewNodesToProcess.Emplace_GetRef(Split.Child1);
+
+			Child0.NodeIndex = Nodes.Emplace_EnsureNoGrow();
+			Child1.NodeIndex = Nodes.Emplace_EnsureNoGrow();
 
 			ParentNode.bLeaf = false;
 
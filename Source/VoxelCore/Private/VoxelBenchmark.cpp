@@ -0,0 +1,405 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelBenchmark.h"
+#include "VoxelPluginVersion.h"
+#include "Serialization/JsonSerializer.h"
+
+FVoxelBenchmarkSettings FVoxelBenchmarkSettings::FromCommandLine(const TCHAR* CommandLine)
+{
+	FVoxelBenchmarkSettings Settings;
+
+	FParse::Value(CommandLine, TEXT("-Filter="), Settings.Filter);
+	FParse::Value(CommandLine, TEXT("-WarmupRuns="), Settings.NumWarmupRuns);
+	FParse::Value(CommandLine, TEXT("-MinSamples="), Settings.MinNumSamples);
+	FParse::Value(CommandLine, TEXT("-MaxSamples="), Settings.MaxNumSamples);
+	FParse::Value(CommandLine, TEXT("-MinTime="), Settings.MinTime);
+
+	FString NumThreads;
+	if (FParse::Value(CommandLine, TEXT("-Threads="), NumThreads))
+	{
+		TArray<FString> Values;
+		NumThreads.ParseIntoArray(Values, TEXT(","));
+
+		Settings.NumThreads.Reset();
+		for (const FString& Value : Values)
+		{
+			Settings.NumThreads.Add(FMath::Max(0, FCString::Atoi(*Value)));
+		}
+	}
+
+	if (Settings.NumThreads.Num() == 0)
+	{
+		Settings.NumThreads.Add(0);
+	}
+
+	Settings.NumWarmupRuns = FMath::Max(Settings.NumWarmupRuns, 0);
+	Settings.MinNumSamples = FMath::Max(Settings.MinNumSamples, 1);
+	Settings.MaxNumSamples = FMath::Max(Settings.MaxNumSamples, Settings.MinNumSamples);
+
+	return Settings;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FString FVoxelBenchmarkResult::GetKey() const
+{
+	return FString::Printf(TEXT("%s/Size=%d/Threads=%d"), *Name, Size, NumThreads);
+}
+
+TSharedRef<FJsonObject> FVoxelBenchmarkResult::ToJson() const
+{
+	const TSharedRef<FJsonObject> JsonObject = MakeShared<FJsonObject>();
+	JsonObject->SetStringField(TEXT("Name"), Name);
+	JsonObject->SetNumberField(TEXT("Size"), Size);
+	JsonObject->SetNumberField(TEXT("NumThreads"), NumThreads);
+	JsonObject->SetNumberField(TEXT("NumSamples"), NumSamples);
+	JsonObject->SetNumberField(TEXT("Min"), Min);
+	JsonObject->SetNumberField(TEXT("Mean"), Mean);
+	JsonObject->SetNumberField(TEXT("Median"), Median);
+	JsonObject->SetNumberField(TEXT("P95"), P95);
+	JsonObject->SetNumberField(TEXT("MAD"), MAD);
+	return JsonObject;
+}
+
+TOptional<FVoxelBenchmarkResult> FVoxelBenchmarkResult::FromJson(const FJsonObject& JsonObject)
+{
+	FVoxelBenchmarkResult Result;
+	if (!JsonObject.TryGetStringField(TEXT("Name"), Result.Name) ||
+		!JsonObject.TryGetNumberField(TEXT("Size"), Result.Size) ||
+		!JsonObject.TryGetNumberField(TEXT("NumThreads"), Result.NumThreads) ||
+		!JsonObject.TryGetNumberField(TEXT("Median"), Result.Median) ||
+		!JsonObject.TryGetNumberField(TEXT("MAD"), Result.MAD))
+	{
+		return {};
+	}
+
+	JsonObject.TryGetNumberField(TEXT("NumSamples"), Result.NumSamples);
+	JsonObject.TryGetNumberField(TEXT("Min"), Result.Min);
+	JsonObject.TryGetNumberField(TEXT("Mean"), Result.Mean);
+	JsonObject.TryGetNumberField(TEXT("P95"), Result.P95);
+
+	return Result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelBenchmarkContext::Measure(const TFunctionRef<void()> Lambda)
+{
+	MeasureImpl([] {}, Lambda, true);
+}
+
+void FVoxelBenchmarkContext::Measure(
+	const TFunctionRef<void()> Initialize,
+	const TFunctionRef<void()> Lambda)
+{
+	// Lambda might rely on Initialize being called before every run, eg when sorting
+	MeasureImpl(Initialize, Lambda, false);
+}
+
+void FVoxelBenchmarkContext::MeasureImpl(
+	const TFunctionRef<void()> Initialize,
+	const TFunctionRef<void()> Lambda,
+	const bool bAllowBatching)
+{
+	if (!ensureMsgf(Samples.Num() == 0, TEXT("Measure can only be called once per benchmark")))
+	{
+		return;
+	}
+
+	double WarmupTime = 0;
+	for (int32 Run = 0; Run < Settings.NumWarmupRuns; Run++)
+	{
+		Initialize();
+
+		const double StartTime = FPlatformTime::Seconds();
+		Lambda();
+		WarmupTime = FPlatformTime::Seconds() - StartTime;
+	}
+
+	// Batch fast lambdas to stay above the timer resolution
+	int32 NumIterations = 1;
+	if (bAllowBatching &&
+		WarmupTime > 0 &&
+		WarmupTime < Settings.MinSampleTime)
+	{
+		NumIterations = FMath::Min(FMath::CeilToInt(Settings.MinSampleTime / WarmupTime), 1 << 20);
+	}
+
+	double TotalTime = 0;
+	while (
+		Samples.Num() < Settings.MaxNumSamples &&
+		(Samples.Num() < Settings.MinNumSamples || TotalTime < Settings.MinTime))
+	{
+		Initialize();
+
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < NumIterations; Iteration++)
+		{
+			Lambda();
+		}
+		const double Time = FPlatformTime::Seconds() - StartTime;
+
+		TotalTime += Time;
+		Samples.Add(Time / NumIterations);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+struct FVoxelBenchmarkEntry
+{
+	FString Name;
+	TVoxelArray<int32> Sizes;
+	FVoxelBenchmarkRegistry::FBenchmark Benchmark;
+};
+
+TVoxelArray<FVoxelBenchmarkEntry>& GetVoxelBenchmarkEntries()
+{
+	static TVoxelArray<FVoxelBenchmarkEntry> Entries;
+	return Entries;
+}
+
+void FVoxelBenchmarkRegistry::Register(
+	const FString& Name,
+	const TConstVoxelArrayView<int32> Sizes,
+	FBenchmark Benchmark)
+{
+	check(IsInGameThread());
+
+	GetVoxelBenchmarkEntries().Add(FVoxelBenchmarkEntry
+	{
+		Name,
+		TVoxelArray<int32>(Sizes),
+		MoveTemp(Benchmark)
+	});
+}
+
+TVoxelArray<FVoxelBenchmarkResult> FVoxelBenchmarkRegistry::Run(const FVoxelBenchmarkSettings& Settings)
+{
+	VOXEL_FUNCTION_COUNTER();
+	check(IsInGameThread());
+
+	TVoxelArray<FVoxelBenchmarkEntry> Entries = GetVoxelBenchmarkEntries();
+	Entries.Sort([](const FVoxelBenchmarkEntry& A, const FVoxelBenchmarkEntry& B)
+	{
+		return A.Name < B.Name;
+	});
+
+	const int32 PreviousMaxNumThreads = GVoxelParallelForMaxNumThreads;
+	ON_SCOPE_EXIT
+	{
+		GVoxelParallelForMaxNumThreads = PreviousMaxNumThreads;
+	};
+
+	TVoxelArray<FVoxelBenchmarkResult> Results;
+	for (const FVoxelBenchmarkEntry& Entry : Entries)
+	{
+		if (!Settings.Filter.IsEmpty() &&
+			!Entry.Name.Contains(Settings.Filter))
+		{
+			continue;
+		}
+
+		TVoxelArray<int32> Sizes = Entry.Sizes;
+		if (Sizes.Num() == 0)
+		{
+			Sizes.Add(0);
+		}
+
+		for (const int32 NumThreads : Settings.NumThreads)
+		{
+			for (const int32 Size : Sizes)
+			{
+				GVoxelParallelForMaxNumThreads = NumThreads;
+
+				FVoxelBenchmarkContext Context(Settings, Size);
+				Entry.Benchmark(Context);
+
+				TVoxelArray<double> Samples = MoveTemp(Context.Samples);
+				if (!ensureMsgf(Samples.Num() > 0, TEXT("%s didn't call Measure"), *Entry.Name))
+				{
+					continue;
+				}
+
+				Samples.Sort();
+
+				const auto GetPercentile = [&](const TConstVoxelArrayView<double> SortedValues, const double Percentile)
+				{
+					return SortedValues[FMath::Clamp(FMath::FloorToInt(Percentile * (SortedValues.Num() - 1) + 0.5), 0, SortedValues.Num() - 1)];
+				};
+
+				FVoxelBenchmarkResult& Result = Results.Emplace_GetRef();
+				Result.Name = Entry.Name;
+				Result.Size = Size;
+				Result.NumThreads = NumThreads;
+				Result.NumSamples = Samples.Num();
+				Result.Min = Samples[0];
+				Result.Median = GetPercentile(Samples, 0.5);
+				Result.P95 = GetPercentile(Samples, 0.95);
+
+				double Sum = 0;
+				for (const double Sample : Samples)
+				{
+					Sum += Sample;
+				}
+				Result.Mean = Sum / Samples.Num();
+
+				TVoxelArray<double> Deviations;
+				Deviations.Reserve(Samples.Num());
+				for (const double Sample : Samples)
+				{
+					Deviations.Add_EnsureNoGrow(FMath::Abs(Sample - Result.Median));
+				}
+				Deviations.Sort();
+				Result.MAD = GetPercentile(Deviations, 0.5);
+
+				LOG_VOXEL(Display, "%-60s median %-12s p95 %-12s MAD %-12s (%d samples)",
+					*Result.GetKey(),
+					*FVoxelUtilities::SecondsToString(Result.Median),
+					*FVoxelUtilities::SecondsToString(Result.P95),
+					*FVoxelUtilities::SecondsToString(Result.MAD),
+					Result.NumSamples);
+			}
+		}
+	}
+
+	return Results;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FString FVoxelBenchmarkRegistry::ToJson(const TConstVoxelArrayView<FVoxelBenchmarkResult> Results)
+{
+	TArray<TSharedPtr<FJsonValue>> Values;
+	for (const FVoxelBenchmarkResult& Result : Results)
+	{
+		Values.Add(MakeShared<FJsonValueObject>(Result.ToJson()));
+	}
+
+	const TSharedRef<FJsonObject> JsonObject = MakeShared<FJsonObject>();
+	JsonObject->SetStringField(TEXT("CPU"), FPlatformMisc::GetCPUBrand());
+	JsonObject->SetStringField(TEXT("Version"), FVoxelUtilities::GetPluginVersion().ToString_UserFacing());
+	JsonObject->SetBoolField(TEXT("DoCheck"), DO_CHECK != 0);
+	JsonObject->SetBoolField(TEXT("VoxelDebug"), VOXEL_DEBUG != 0);
+	JsonObject->SetArrayField(TEXT("Results"), Values);
+
+	return FVoxelUtilities::JsonToString(JsonObject, true);
+}
+
+FString FVoxelBenchmarkRegistry::ToCsv(const TConstVoxelArrayView<FVoxelBenchmarkResult> Results)
+{
+	FString Csv = "Name,Size,NumThreads,NumSamples,Min,Mean,Median,P95,MAD\n";
+
+	for (const FVoxelBenchmarkResult& Result : Results)
+	{
+		Csv += FString::Printf(TEXT("\"%s\",%d,%d,%d,%.9g,%.9g,%.9g,%.9g,%.9g\n"),
+			*Result.Name.Replace(TEXT("\""), TEXT("\"\"")),
+			Result.Size,
+			Result.NumThreads,
+			Result.NumSamples,
+			Result.Min,
+			Result.Mean,
+			Result.Median,
+			Result.P95,
+			Result.MAD);
+	}
+
+	return Csv;
+}
+
+bool FVoxelBenchmarkRegistry::FromJson(
+	const FString& Json,
+	TVoxelArray<FVoxelBenchmarkResult>& OutResults)
+{
+	const TSharedPtr<FJsonObject> JsonObject = FVoxelUtilities::StringToJson(Json);
+	if (!JsonObject)
+	{
+		return false;
+	}
+
+	const TArray<TSharedPtr<FJsonValue>>* Values = nullptr;
+	if (!JsonObject->TryGetArrayField(TEXT("Results"), Values))
+	{
+		return false;
+	}
+
+	for (const TSharedPtr<FJsonValue>& Value : *Values)
+	{
+		const TSharedPtr<FJsonObject>* ResultObject = nullptr;
+		if (!Value ||
+			!Value->TryGetObject(ResultObject))
+		{
+			return false;
+		}
+
+		const TOptional<FVoxelBenchmarkResult> Result = FVoxelBenchmarkResult::FromJson(**ResultObject);
+		if (!Result)
+		{
+			return false;
+		}
+
+		OutResults.Add(*Result);
+	}
+
+	return true;
+}
+
+int32 FVoxelBenchmarkRegistry::Compare(
+	const TConstVoxelArrayView<FVoxelBenchmarkResult> Baseline,
+	const TConstVoxelArrayView<FVoxelBenchmarkResult> Results,
+	const double Threshold)
+{
+	TVoxelMap<FString, const FVoxelBenchmarkResult*> KeyToBaseline;
+	KeyToBaseline.Reserve(Baseline.Num());
+
+	for (const FVoxelBenchmarkResult& Result : Baseline)
+	{
+		KeyToBaseline.FindOrAdd(Result.GetKey()) = &Result;
+	}
+
+	int32 NumRegressions = 0;
+	for (const FVoxelBenchmarkResult& Result : Results)
+	{
+		const FVoxelBenchmarkResult* const* BaselinePtr = KeyToBaseline.Find(Result.GetKey());
+		if (!BaselinePtr)
+		{
+			LOG_VOXEL(Display, "%-60s not in baseline", *Result.GetKey());
+			continue;
+		}
+		const FVoxelBenchmarkResult& BaselineResult = **BaselinePtr;
+
+		const double Ratio = Result.Median / FMath::Max(BaselineResult.Median, UE_DOUBLE_SMALL_NUMBER);
+		// 1.4826 * MAD estimates the standard deviation of a normal distribution
+		const double Noise = 3 * 1.4826 * (Result.MAD + BaselineResult.MAD);
+
+		if (Ratio > 1 + Threshold &&
+			Result.Median - BaselineResult.Median > Noise)
+		{
+			NumRegressions++;
+
+			LOG_VOXEL(Error, "%-60s REGRESSION: %s -> %s (%.2fx)",
+				*Result.GetKey(),
+				*FVoxelUtilities::SecondsToString(BaselineResult.Median),
+				*FVoxelUtilities::SecondsToString(Result.Median),
+				Ratio);
+		}
+		else
+		{
+			LOG_VOXEL(Display, "%-60s %s -> %s (%.2fx)",
+				*Result.GetKey(),
+				*FVoxelUtilities::SecondsToString(BaselineResult.Median),
+				*FVoxelUtilities::SecondsToString(Result.Median),
+				Ratio);
+		}
+	}
+
+	return NumRegressions;
+}
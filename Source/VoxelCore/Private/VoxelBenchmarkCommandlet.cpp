@@ -0,0 +1,61 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelBenchmarkCommandlet.h"
+#include "VoxelBenchmark.h"
+
+int32 UVoxelBenchmarkCommandlet::Main(const FString& Params)
+{
+	const FVoxelBenchmarkSettings Settings = FVoxelBenchmarkSettings::FromCommandLine(*Params);
+
+	LOG_VOXEL(Display, "CPU: %s", *FPlatformMisc::GetCPUBrand());
+	LOG_VOXEL(Display, "DO_CHECK=%d VOXEL_DEBUG=%d", DO_CHECK, VOXEL_DEBUG);
+
+	const TVoxelArray<FVoxelBenchmarkResult> Results = FVoxelBenchmarkRegistry::Run(Settings);
+
+	FString JsonPath;
+	if (FParse::Value(*Params, TEXT("-Json="), JsonPath))
+	{
+		if (!FFileHelper::SaveStringToFile(FVoxelBenchmarkRegistry::ToJson(Results), *JsonPath))
+		{
+			LOG_VOXEL(Error, "Failed to write %s", *JsonPath);
+			return 1;
+		}
+	}
+
+	FString CsvPath;
+	if (FParse::Value(*Params, TEXT("-Csv="), CsvPath))
+	{
+		if (!FFileHelper::SaveStringToFile(FVoxelBenchmarkRegistry::ToCsv(Results), *CsvPath))
+		{
+			LOG_VOXEL(Error, "Failed to write %s", *CsvPath);
+			return 1;
+		}
+	}
+
+	FString BaselinePath;
+	if (!FParse::Value(*Params, TEXT("-Baseline="), BaselinePath))
+	{
+		return 0;
+	}
+
+	FString BaselineJson;
+	TVoxelArray<FVoxelBenchmarkResult> Baseline;
+	if (!FFileHelper::LoadFileToString(BaselineJson, *BaselinePath) ||
+		!FVoxelBenchmarkRegistry::FromJson(BaselineJson, Baseline))
+	{
+		LOG_VOXEL(Error, "Failed to load baseline %s", *BaselinePath);
+		return 1;
+	}
+
+	double Threshold = 0.1;
+	FParse::Value(*Params, TEXT("-Threshold="), Threshold);
+
+	const int32 NumRegressions = FVoxelBenchmarkRegistry::Compare(Baseline, Results, Threshold);
+	if (NumRegressions > 0)
+	{
+		LOG_VOXEL(Error, "%d regressions", NumRegressions);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,21 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "VoxelMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "VoxelBenchmarkCommandlet.generated.h"
+
+// Runs the benchmarks registered with VOXEL_BENCHMARK
+// -run=VoxelBenchmark -Filter=RadixSort -Threads=1,0 -Json=Results.json -Csv=Results.csv -Baseline=Baseline.json -Threshold=0.1
+// Returns 1 if regressions were found against the baseline
+UCLASS()
+class UVoxelBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	//~ Begin UCommandlet Interface
+	virtual int32 Main(const FString& Params) override;
+	//~ End UCommandlet Interface
+};
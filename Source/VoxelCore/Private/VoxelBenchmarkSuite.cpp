@@ -0,0 +1,221 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelMinimal.h"
+#include "VoxelBenchmark.h"
+#include "VoxelMeshOptimizer.h"
+
+// Core benchmarks tracked release to release, see UVoxelBenchmarkCommandlet
+// Keep the setup deterministic so that results are comparable across runs
+
+VOXEL_BENCHMARK("FVoxelUtilities::RadixSort uint64", 1024, 64 * 1024, 1024 * 1024)
+{
+	FRandomStream Stream(1337);
+
+	TVoxelArray<uint64> RandomKeys;
+	FVoxelUtilities::SetNumFast(RandomKeys, Context.Size);
+	for (uint64& Key : RandomKeys)
+	{
+		Key = (uint64(Stream.GetUnsignedInt()) << 32) | Stream.GetUnsignedInt();
+	}
+
+	TVoxelArray<uint64> Keys;
+	Context.Measure(
+		[&]
+		{
+			Keys = RandomKeys;
+		},
+		[&]
+		{
+			FVoxelUtilities::RadixSort(Keys);
+		});
+}
+
+VOXEL_BENCHMARK("FVoxelUtilities::ExclusiveScan", 1024, 1024 * 1024)
+{
+	TVoxelArray<int32> Data;
+	FVoxelUtilities::SetNum(Data, Context.Size);
+	for (int32 Index = 0; Index < Data.Num(); Index++)
+	{
+		Data[Index] = Index % 3;
+	}
+
+	TVoxelArray<int32> Result;
+	FVoxelUtilities::SetNumFast(Result, Context.Size);
+
+	Context.Measure([&]
+	{
+		FVoxelUtilities::ExclusiveScan(Data, Result);
+	});
+}
+
+VOXEL_BENCHMARK("FVoxelBitArray::CountSetBits", 1024 * 1024)
+{
+	FRandomStream Stream(1337);
+
+	FVoxelBitArray Array;
+	Array.Reserve(Context.Size);
+	for (int32 Index = 0; Index < Context.Size; Index++)
+	{
+		Array.Add(Stream.GetFraction() < 0.5f);
+	}
+
+	int32 Count = 0;
+	Context.Measure([&]
+	{
+		Count += Array.CountSetBits();
+	});
+}
+
+VOXEL_BENCHMARK("FVoxelBitArray::GetSetBitIndices", 1024 * 1024)
+{
+	FRandomStream Stream(1337);
+
+	FVoxelBitArray Array;
+	Array.Reserve(Context.Size);
+	for (int32 Index = 0; Index < Context.Size; Index++)
+	{
+		Array.Add(Stream.GetFraction() < 0.1f);
+	}
+
+	Context.Measure([&]
+	{
+		(void)Array.GetSetBitIndices();
+	});
+}
+
+// Heightfield of Size x Size quads, with triangles shuffled
+static void MakeShuffledHeightfield(
+	const int32 Size,
+	TVoxelArray<int32>& OutIndices,
+	TVoxelArray<FVector3f>& OutVertices)
+{
+	OutVertices.Reset();
+	for (int32 Y = 0; Y <= Size; Y++)
+	{
+		for (int32 X = 0; X <= Size; X++)
+		{
+			OutVertices.Add(FVector3f(X, Y, FMath::Sin(X / 4.f) * FMath::Cos(Y / 4.f) * 4.f));
+		}
+	}
+
+	OutIndices.Reset();
+	for (int32 Y = 0; Y < Size; Y++)
+	{
+		for (int32 X = 0; X < Size; X++)
+		{
+			const int32 Index = X + Y * (Size + 1);
+			OutIndices.Append({ Index, Index + Size + 1, Index + 1 });
+			OutIndices.Append({ Index + 1, Index + Size + 1, Index + Size + 2 });
+		}
+	}
+
+	FRandomStream Stream(1337);
+	for (int32 Triangle = OutIndices.Num() / 3 - 1; Triangle > 0; Triangle--)
+	{
+		const int32 Other = Stream.RandRange(0, Triangle);
+		for (int32 Corner = 0; Corner < 3; Corner++)
+		{
+			OutIndices.Swap(3 * Triangle + Corner, 3 * Other + Corner);
+		}
+	}
+}
+
+VOXEL_BENCHMARK("FVoxelMeshOptimizer::OptimizeVertexCache", 32, 128)
+{
+	TVoxelArray<int32> ShuffledIndices;
+	TVoxelArray<FVector3f> Vertices;
+	MakeShuffledHeightfield(Context.Size, ShuffledIndices, Vertices);
+
+	TVoxelArray<int32> Indices;
+	Context.Measure(
+		[&]
+		{
+			Indices = ShuffledIndices;
+		},
+		[&]
+		{
+			FVoxelMeshOptimizer::OptimizeVertexCache(Indices, Vertices.Num());
+		});
+
+	// Not timed, logged to compare the passes
+	const float ShuffledACMR = FVoxelMeshOptimizer::ComputeACMR(ShuffledIndices, Vertices.Num());
+	const float OptimizedACMR = FVoxelMeshOptimizer::ComputeACMR(Indices, Vertices.Num());
+	LOG_VOXEL(Display, "OptimizeVertexCache %d: ACMR %.3f -> %.3f", Context.Size, ShuffledACMR, OptimizedACMR);
+}
+
+// Cheaper than OptimizeVertexCache when only BVH/Nanite locality matters
+VOXEL_BENCHMARK("FVoxelMeshOptimizer::SortTrianglesSpatially", 32, 128)
+{
+	TVoxelArray<int32> ShuffledIndices;
+	TVoxelArray<FVector3f> Vertices;
+	MakeShuffledHeightfield(Context.Size, ShuffledIndices, Vertices);
+
+	TVoxelArray<int32> Indices;
+	Context.Measure(
+		[&]
+		{
+			Indices = ShuffledIndices;
+		},
+		[&]
+		{
+			FVoxelMeshOptimizer::SortTrianglesSpatially(Indices, Vertices);
+		});
+
+	const float ShuffledACMR = FVoxelMeshOptimizer::ComputeACMR(ShuffledIndices, Vertices.Num());
+	const float SortedACMR = FVoxelMeshOptimizer::ComputeACMR(Indices, Vertices.Num());
+	LOG_VOXEL(Display, "SortTrianglesSpatially %d: ACMR %.3f -> %.3f", Context.Size, ShuffledACMR, SortedACMR);
+}
+
+VOXEL_BENCHMARK("FVoxelUtilities::GetUnitVectors FVoxelOctahedron", 1024 * 1024)
+{
+	FRandomStream Stream(1337);
+
+	TVoxelArray<FVector3f> Vectors;
+	for (int32 Index = 0; Index < Context.Size; Index++)
+	{
+		Vectors.Add(FVector3f(Stream.GetUnitVector()));
+	}
+
+	const TVoxelArray<FVoxelOctahedron> Octahedrons = FVoxelUtilities::MakeOctahedrons(Vectors);
+
+	TVoxelArray<FVector3f> UnitVectors;
+	Context.Measure([&]
+	{
+		UnitVectors = FVoxelUtilities::GetUnitVectors(Octahedrons);
+	});
+}
+
+VOXEL_BENCHMARK("FVoxelUtilities::MakeOctahedrons", 1024 * 1024)
+{
+	FRandomStream Stream(1337);
+
+	TVoxelArray<FVector3f> Vectors;
+	for (int32 Index = 0; Index < Context.Size; Index++)
+	{
+		Vectors.Add(FVector3f(Stream.GetUnitVector()));
+	}
+
+	TVoxelArray<FVoxelOctahedron> Octahedrons;
+	Context.Measure([&]
+	{
+		Octahedrons = FVoxelUtilities::MakeOctahedrons(Vectors);
+	});
+}
+
+// Tests the 4 nearest octahedrons, compare with FVoxelUtilities::MakeOctahedrons
+VOXEL_BENCHMARK("FVoxelUtilities::MakeOctahedrons_Precise", 1024 * 1024)
+{
+	FRandomStream Stream(1337);
+
+	TVoxelArray<FVector3f> Vectors;
+	for (int32 Index = 0; Index < Context.Size; Index++)
+	{
+		Vectors.Add(FVector3f(Stream.GetUnitVector()));
+	}
+
+	TVoxelArray<FVoxelOctahedron> Octahedrons;
+	Context.Measure([&]
+	{
+		Octahedrons = FVoxelUtilities::MakeOctahedrons_Precise(Vectors);
+	});
+}
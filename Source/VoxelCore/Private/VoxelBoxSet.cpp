@@ -0,0 +1,548 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelBoxSet.h"
+#include "VoxelAABBTree.h"
+
+namespace Voxel::BoxSet
+{
+	FORCEINLINE double GetVolume(const FVoxelBox& Box)
+	{
+		const FVector Size = Box.Size();
+		return Size.X * Size.Y * Size.Z;
+	}
+	FORCEINLINE double GetOverlapVolume(const FVoxelBox& A, const FVoxelBox& B)
+	{
+		const FVector Size = FVector::Max(FVector::Min(A.Max, B.Max) - FVector::Max(A.Min, B.Min), FVector::ZeroVector);
+		return Size.X * Size.Y * Size.Z;
+	}
+	// Upper bound of the volume added to the region when replacing A and B by their union
+	FORCEINLINE double GetMergeCost(const FVoxelBox& A, const FVoxelBox& B)
+	{
+		return FMath::Max(GetVolume(A.UnionWith(B)) - GetVolume(A) - GetVolume(B) + GetOverlapVolume(A, B), 0.);
+	}
+	// Positive volume intersection, unlike FVoxelBox::Intersects
+	FORCEINLINE bool OverlapsStrictly(const FVoxelBox& A, const FVoxelBox& B)
+	{
+		return
+			A.Min.X < B.Max.X && B.Min.X < A.Max.X &&
+			A.Min.Y < B.Max.Y && B.Min.Y < A.Max.Y &&
+			A.Min.Z < B.Max.Z && B.Min.Z < A.Max.Z;
+	}
+
+	void RemoveContainedBoxes(TVoxelArray<FVoxelBox>& Boxes)
+	{
+		VOXEL_FUNCTION_COUNTER_NUM(Boxes.Num(), 128);
+
+		// Only visit the nodes containing the box, tree bounds are conservative
+		const TSharedRef<FVoxelAABBTree> Tree = FVoxelAABBTree::Create(Boxes);
+
+		TVoxelArray<FVoxelBox> NewBoxes;
+		NewBoxes.Reserve(Boxes.Num());
+
+		for (int32 Index = 0; Index < Boxes.Num(); Index++)
+		{
+			const FVoxelBox& Box = Boxes[Index];
+
+			bool bIsContained = false;
+			Tree->Traverse(
+				[&](const FVoxelFastBox& Bounds)
+				{
+					return
+						!bIsContained &&
+						Bounds.GetBox().Contains(Box);
+				},
+				[&](const int32 OtherIndex)
+				{
+					if (OtherIndex == Index ||
+						!Boxes[OtherIndex].Contains(Box))
+					{
+						return;
+					}
+
+					// Of identical boxes, only keep the first one
+					if (Boxes[OtherIndex] == Box &&
+						OtherIndex > Index)
+					{
+						return;
+					}
+
+					bIsContained = true;
+				});
+
+			if (!bIsContained)
+			{
+				NewBoxes.Add_EnsureNoGrow(Box);
+			}
+		}
+
+		Boxes = MoveTemp(NewBoxes);
+	}
+
+	// Merge boxes with the same extent on the two other axes that overlap or touch along Axis
+	bool MergeAlongAxis(TVoxelArray<FVoxelBox>& Boxes, const int32 Axis)
+	{
+		VOXEL_FUNCTION_COUNTER_NUM(Boxes.Num(), 128);
+
+		const int32 AxisA = (Axis + 1) % 3;
+		const int32 AxisB = (Axis + 2) % 3;
+
+		Boxes.Sort([&](const FVoxelBox& A, const FVoxelBox& B)
+		{
+			if (A.Min[AxisA] != B.Min[AxisA]) { return A.Min[AxisA] < B.Min[AxisA]; }
+			if (A.Max[AxisA] != B.Max[AxisA]) { return A.Max[AxisA] < B.Max[AxisA]; }
+			if (A.Min[AxisB] != B.Min[AxisB]) { return A.Min[AxisB] < B.Min[AxisB]; }
+			if (A.Max[AxisB] != B.Max[AxisB]) { return A.Max[AxisB] < B.Max[AxisB]; }
+			return A.Min[Axis] < B.Min[Axis];
+		});
+
+		TVoxelArray<FVoxelBox> NewBoxes;
+		NewBoxes.Reserve(Boxes.Num());
+
+		for (const FVoxelBox& Box : Boxes)
+		{
+			if (NewBoxes.Num() > 0)
+			{
+				FVoxelBox& LastBox = NewBoxes.Last();
+
+				if (LastBox.Min[AxisA] == Box.Min[AxisA] &&
+					LastBox.Max[AxisA] == Box.Max[AxisA] &&
+					LastBox.Min[AxisB] == Box.Min[AxisB] &&
+					LastBox.Max[AxisB] == Box.Max[AxisB] &&
+					Box.Min[Axis] <= LastBox.Max[Axis])
+				{
+					LastBox.Max[Axis] = FMath::Max(LastBox.Max[Axis], Box.Max[Axis]);
+					continue;
+				}
+			}
+
+			NewBoxes.Add_EnsureNoGrow(Box);
+		}
+
+		const bool bMerged = NewBoxes.Num() < Boxes.Num();
+		Boxes = MoveTemp(NewBoxes);
+		return bMerged;
+	}
+
+	// Sort boxes along a Morton curve of their center so that consecutive boxes are close to each other
+	void SortByMortonCode(TVoxelArray<FVoxelBox>& Boxes, const FVoxelBox& Bounds)
+	{
+		VOXEL_FUNCTION_COUNTER_NUM(Boxes.Num(), 128);
+
+		const double Scale = 1023. / FMath::Max(Bounds.Size().GetMax(), UE_DOUBLE_SMALL_NUMBER);
+		const auto Quantize = [&](const double Value)
+		{
+			return uint32(FMath::Clamp(FMath::FloorToInt32(Value * Scale), 0, 1023));
+		};
+
+		TVoxelArray<TPair<uint32, FVoxelBox>> CodeToBox;
+		CodeToBox.Reserve(Boxes.Num());
+		for (const FVoxelBox& Box : Boxes)
+		{
+			const FVector Position = Box.GetCenter() - Bounds.Min;
+
+			const uint32 Code =
+				(FMath::MortonCode3(Quantize(Position.X)) << 0) |
+				(FMath::MortonCode3(Quantize(Position.Y)) << 1) |
+				(FMath::MortonCode3(Quantize(Position.Z)) << 2);
+
+			CodeToBox.Add_EnsureNoGrow({ Code, Box });
+		}
+
+		CodeToBox.Sort([](const TPair<uint32, FVoxelBox>& A, const TPair<uint32, FVoxelBox>& B)
+		{
+			return A.Key < B.Key;
+		});
+
+		for (int32 Index = 0; Index < CodeToBox.Num(); Index++)
+		{
+			Boxes[Index] = CodeToBox[Index].Value;
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelBoxSet::FVoxelBoxSet(const TConstVoxelArrayView<FVoxelBox> Boxes)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Boxes.Num(), 128);
+
+	Reserve(Boxes.Num());
+
+	for (const FVoxelBox& Box : Boxes)
+	{
+		if (ensureVoxelSlow(Box.IsValidAndNotEmpty()))
+		{
+			AddUnchecked(Box);
+		}
+	}
+}
+
+FVoxelBoxSet::FVoxelBoxSet(const TVoxelChunkedArray<FVoxelBox>& Boxes)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Boxes.Num(), 128);
+
+	Reserve(Boxes.Num());
+
+	for (const FVoxelBox& Box : Boxes)
+	{
+		if (ensureVoxelSlow(Box.IsValidAndNotEmpty()))
+		{
+			AddUnchecked(Box);
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+int64 FVoxelBoxSet::GetAllocatedSize() const
+{
+	return
+		MinX.GetAllocatedSize() +
+		MinY.GetAllocatedSize() +
+		MinZ.GetAllocatedSize() +
+		MaxX.GetAllocatedSize() +
+		MaxY.GetAllocatedSize() +
+		MaxZ.GetAllocatedSize();
+}
+
+FVoxelOptionalBox FVoxelBoxSet::GetBounds() const
+{
+	FVoxelOptionalBox Bounds;
+	for (int32 Index = 0; Index < Num(); Index++)
+	{
+		Bounds += GetBox(Index);
+	}
+	return Bounds;
+}
+
+TVoxelArray<FVoxelBox> FVoxelBoxSet::GetBoxes() const
+{
+	TVoxelArray<FVoxelBox> Boxes;
+	Boxes.Reserve(Num());
+
+	for (int32 Index = 0; Index < Num(); Index++)
+	{
+		Boxes.Add_EnsureNoGrow(GetBox(Index));
+	}
+
+	return Boxes;
+}
+
+double FVoxelBoxSet::GetVolume() const
+{
+	double Volume = 0;
+	for (int32 Index = 0; Index < Num(); Index++)
+	{
+		Volume += Voxel::BoxSet::GetVolume(GetBox(Index));
+	}
+	return Volume;
+}
+
+bool FVoxelBoxSet::Intersects(const FVoxelBox& Box) const
+{
+	constexpr int32 BlockSize = 16;
+
+	for (int32 BlockStart = 0; BlockStart < Num(); BlockStart += BlockSize)
+	{
+		const int32 BlockEnd = FMath::Min(BlockStart + BlockSize, Num());
+
+		// No early exit inside a block to let the compiler vectorize
+		bool bIntersects = false;
+		for (int32 Index = BlockStart; Index < BlockEnd; Index++)
+		{
+			bIntersects |=
+				(MinX[Index] <= Box.Max.X) & (Box.Min.X <= MaxX[Index]) &
+				(MinY[Index] <= Box.Max.Y) & (Box.Min.Y <= MaxY[Index]) &
+				(MinZ[Index] <= Box.Max.Z) & (Box.Min.Z <= MaxZ[Index]);
+		}
+
+		if (bIntersects)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelBoxSet::Add(const FVoxelBox& Box)
+{
+	if (!ensureVoxelSlow(Box.IsValidAndNotEmpty()))
+	{
+		return;
+	}
+
+	// No box is contained in another one: if Box is contained, no box can be contained in Box
+	for (int32 Index = Num() - 1; Index >= 0; Index--)
+	{
+		const FVoxelBox OtherBox = GetBox(Index);
+
+		if (OtherBox.Contains(Box))
+		{
+			return;
+		}
+
+		if (Box.Contains(OtherBox))
+		{
+			RemoveAtSwap(Index);
+		}
+	}
+
+	AddUnchecked(Box);
+}
+
+void FVoxelBoxSet::Add(const FVoxelBoxSet& Other)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Other.Num(), 128);
+
+	Reserve(Num() + Other.Num());
+
+	for (int32 Index = 0; Index < Other.Num(); Index++)
+	{
+		Add(Other.GetBox(Index));
+	}
+}
+
+void FVoxelBoxSet::Subtract(const FVoxelBox& Box)
+{
+	TVoxelInlineArray<FVoxelBox, 6> Pieces;
+
+	for (int32 Index = Num() - 1; Index >= 0; Index--)
+	{
+		FVoxelBox Remaining = GetBox(Index);
+		if (!Voxel::BoxSet::OverlapsStrictly(Remaining, Box))
+		{
+			continue;
+		}
+
+		RemoveAtSwap(Index);
+
+		// Peel off the parts of Remaining outside of Box, one axis at a time
+		for (int32 Axis = 0; Axis < 3; Axis++)
+		{
+			if (Remaining.Min[Axis] < Box.Min[Axis])
+			{
+				FVoxelBox Piece = Remaining;
+				Piece.Max[Axis] = Box.Min[Axis];
+				Pieces.Add(Piece);
+
+				Remaining.Min[Axis] = Box.Min[Axis];
+			}
+			if (Remaining.Max[Axis] > Box.Max[Axis])
+			{
+				FVoxelBox Piece = Remaining;
+				Piece.Min[Axis] = Box.Max[Axis];
+				Pieces.Add(Piece);
+
+				Remaining.Max[Axis] = Box.Max[Axis];
+			}
+		}
+	}
+
+	// Pieces are outside of Box, no need to check them
+	for (const FVoxelBox& Piece : Pieces)
+	{
+		AddUnchecked(Piece);
+	}
+}
+
+void FVoxelBoxSet::Subtract(const FVoxelBoxSet& Other)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Other.Num(), 128);
+
+	for (int32 Index = 0; Index < Other.Num(); Index++)
+	{
+		Subtract(Other.GetBox(Index));
+	}
+}
+
+void FVoxelBoxSet::Compact()
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Num(), 128);
+
+	if (Num() <= 1)
+	{
+		return;
+	}
+
+	TVoxelArray<FVoxelBox> Boxes = GetBoxes();
+	Voxel::BoxSet::RemoveContainedBoxes(Boxes);
+
+	// Merging along an axis can allow new merges along the other ones
+	for (int32 Iteration = 0; Iteration < 8; Iteration++)
+	{
+		bool bMerged = false;
+		for (int32 Axis = 0; Axis < 3; Axis++)
+		{
+			bMerged |= Voxel::BoxSet::MergeAlongAxis(Boxes, Axis);
+		}
+
+		if (!bMerged)
+		{
+			break;
+		}
+	}
+
+	SetBoxes(Boxes);
+}
+
+double FVoxelBoxSet::Approximate(
+	const int32 MaxNumBoxes,
+	const double MaxAddedVolumeRatio)
+{
+	check(MaxNumBoxes >= 1);
+	check(MaxAddedVolumeRatio >= 0.);
+
+	if (Num() <= MaxNumBoxes)
+	{
+		return 0.;
+	}
+
+	VOXEL_FUNCTION_COUNTER_NUM(Num(), 128);
+
+	const FVoxelBox Bounds = GetBounds().GetBox();
+	const double MaxAddedVolume = MaxAddedVolumeRatio * GetVolume();
+	TVoxelArray<FVoxelBox> Boxes = GetBoxes();
+
+	double AddedVolume = 0.;
+	while (Boxes.Num() > MaxNumBoxes)
+	{
+		Voxel::BoxSet::SortByMortonCode(Boxes, Bounds);
+
+		struct FMerge
+		{
+			double Cost;
+			int32 Index;
+		};
+		TVoxelArray<FMerge> Merges;
+		Merges.Reserve(Boxes.Num() - 1);
+
+		for (int32 Index = 0; Index < Boxes.Num() - 1; Index++)
+		{
+			Merges.Add_EnsureNoGrow(FMerge
+			{
+				Voxel::BoxSet::GetMergeCost(Boxes[Index], Boxes[Index + 1]),
+				Index
+			});
+		}
+
+		Merges.Sort([](const FMerge& A, const FMerge& B)
+		{
+			return A.Cost < B.Cost;
+		});
+
+		// Do the cheapest merges between neighbors, each box being merged at most once per pass
+		TVoxelArray<bool> IsMerged;
+		IsMerged.SetNumZeroed(Boxes.Num());
+
+		TVoxelArray<bool> IsRemoved;
+		IsRemoved.SetNumZeroed(Boxes.Num());
+
+		int32 NumMergesLeft = Boxes.Num() - MaxNumBoxes;
+		for (const FMerge& Merge : Merges)
+		{
+			if (NumMergesLeft == 0 ||
+				AddedVolume + Merge.Cost > MaxAddedVolume)
+			{
+				// Merges are sorted by cost, the next ones are over budget too
+				break;
+			}
+
+			if (IsMerged[Merge.Index] ||
+				IsMerged[Merge.Index + 1])
+			{
+				continue;
+			}
+
+			Boxes[Merge.Index] = Boxes[Merge.Index].UnionWith(Boxes[Merge.Index + 1]);
+			IsMerged[Merge.Index] = true;
+			IsMerged[Merge.Index + 1] = true;
+			IsRemoved[Merge.Index + 1] = true;
+
+			AddedVolume += Merge.Cost;
+			NumMergesLeft--;
+		}
+
+		if (NumMergesLeft == Boxes.Num() - MaxNumBoxes)
+		{
+			// Even the cheapest merge is over budget
+			break;
+		}
+
+		TVoxelArray<FVoxelBox> NewBoxes;
+		NewBoxes.Reserve(Boxes.Num());
+
+		for (int32 Index = 0; Index < Boxes.Num(); Index++)
+		{
+			if (!IsRemoved[Index])
+			{
+				NewBoxes.Add_EnsureNoGrow(Boxes[Index]);
+			}
+		}
+
+		Boxes = MoveTemp(NewBoxes);
+	}
+
+	SetBoxes(Boxes);
+
+	return AddedVolume;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelBoxSet::Reserve(const int32 Number)
+{
+	MinX.Reserve(Number);
+	MinY.Reserve(Number);
+	MinZ.Reserve(Number);
+	MaxX.Reserve(Number);
+	MaxY.Reserve(Number);
+	MaxZ.Reserve(Number);
+}
+
+void FVoxelBoxSet::AddUnchecked(const FVoxelBox& Box)
+{
+	MinX.Add(Box.Min.X);
+	MinY.Add(Box.Min.Y);
+	MinZ.Add(Box.Min.Z);
+	MaxX.Add(Box.Max.X);
+	MaxY.Add(Box.Max.Y);
+	MaxZ.Add(Box.Max.Z);
+}
+
+void FVoxelBoxSet::RemoveAtSwap(const int32 Index)
+{
+	MinX.RemoveAtSwap(Index);
+	MinY.RemoveAtSwap(Index);
+	MinZ.RemoveAtSwap(Index);
+	MaxX.RemoveAtSwap(Index);
+	MaxY.RemoveAtSwap(Index);
+	MaxZ.RemoveAtSwap(Index);
+}
+
+void FVoxelBoxSet::SetBoxes(const TConstVoxelArrayView<FVoxelBox> Boxes)
+{
+	MinX.Reset();
+	MinY.Reset();
+	MinZ.Reset();
+	MaxX.Reset();
+	MaxY.Reset();
+	MaxZ.Reset();
+
+	Reserve(Boxes.Num());
+
+	for (const FVoxelBox& Box : Boxes)
+	{
+		AddUnchecked(Box);
+	}
+}
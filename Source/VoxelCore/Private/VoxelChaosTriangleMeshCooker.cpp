@@ -9,6 +9,12 @@ VOXEL_CONSOLE_VARIABLE(
 	"voxel.collision.FastCooking",
 	"Custom cooking for Chaos collision meshes");
 
+VOXEL_CONSOLE_VARIABLE(
+	VOXELCORE_API, int32, GVoxelCollisionCookCacheSizeMB, 0,
+	"voxel.collision.CookCacheSizeMB",
+	"Max memory used to cache cooked Chaos collision meshes by content hash, in MB. 0 to disable the cache. "
+	"Every cook hashes its whole mesh and eviction is a linear scan under a global lock, only enable if many identical meshes are cooked");
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -72,46 +78,52 @@ struct Chaos::FTriangleMeshOverlapVisitorNoMTD<void>
 		}
 
 		TVoxelArray<TVector<IndexType, 3>> Triangles;
+		TVoxelArray<uint16> TriangleMaterials;
 		{
 			VOXEL_SCOPE_COUNTER("Build triangles");
 
 			checkVoxelSlow(Indices.Num() % 3 == 0);
 			const int32 NumTriangles = Indices.Num() / 3;
 
-			Triangles.Reserve(NumTriangles);
+			TVoxelArray<bool> IsTriangleValid;
+			FVoxelUtilities::SetNumFast(IsTriangleValid, NumTriangles);
 
-			for (int32 Index = 0; Index < NumTriangles; Index++)
+			Voxel::ParallelFor(IsTriangleValid, [&](bool& bIsValid, const int32 Index)
 			{
-				const TVector<int32, 3> Triangle
-				{
-					Indices[3 * Index + 2],
-					Indices[3 * Index + 1],
-					Indices[3 * Index + 0]
-				};
+				const FVector3f VertexA = Vertices[Indices[3 * Index + 2]];
+				const FVector3f VertexB = Vertices[Indices[3 * Index + 1]];
+				const FVector3f VertexC = Vertices[Indices[3 * Index + 0]];
 
-				const FVector3f VertexA = Vertices[Triangle.X];
-				const FVector3f VertexB = Vertices[Triangle.Y];
-				const FVector3f VertexC = Vertices[Triangle.Z];
-
-				checkVoxelSlow(
-					FConvexBuilder::IsValidTriangle(
-						VertexA,
-						VertexB,
-						VertexC) ==
-					FVoxelUtilities::IsTriangleValid(
-						FVector(VertexA),
-						FVector(VertexB),
-						FVector(VertexC)));
-
-				if (!FVoxelUtilities::IsTriangleValid(
+				bIsValid = FVoxelUtilities::IsTriangleValid(
 					FVector(VertexA),
 					FVector(VertexB),
-					FVector(VertexC)))
+					FVector(VertexC));
+
+				checkVoxelSlow(FConvexBuilder::IsValidTriangle(VertexA, VertexB, VertexC) == bIsValid);
+			});
+
+			Triangles.Reserve(NumTriangles);
+			TriangleMaterials.Reserve(FaceMaterials.Num());
+
+			for (int32 Index = 0; Index < NumTriangles; Index++)
+			{
+				if (!IsTriangleValid[Index])
 				{
 					continue;
 				}
 
-				Triangles.Add_EnsureNoGrow(Triangle);
+				Triangles.Add_EnsureNoGrow(TVector<IndexType, 3>
+				{
+					IndexType(Indices[3 * Index + 2]),
+					IndexType(Indices[3 * Index + 1]),
+					IndexType(Indices[3 * Index + 0])
+				});
+
+				// Keep materials in sync with the triangles we skipped
+				if (FaceMaterials.Num() > 0)
+				{
+					TriangleMaterials.Add_EnsureNoGrow(FaceMaterials[Index]);
+				}
 			}
 		}
 
@@ -127,7 +139,7 @@ struct Chaos::FTriangleMeshOverlapVisitorNoMTD<void>
 			return new FTriangleMeshImplicitObject(
 				MoveTemp(Particles),
 				MoveTemp(Triangles),
-				TArray<uint16>(FaceMaterials),
+				TArray<uint16>(TriangleMaterials),
 				nullptr,
 				nullptr,
 				true);
@@ -150,7 +162,7 @@ struct Chaos::FTriangleMeshOverlapVisitorNoMTD<void>
 			{
 				VOXEL_SCOPE_COUNTER("Build Elements");
 
-				for (int32 Index = 0; Index < Triangles.Num(); Index++)
+				Voxel::ParallelFor(Triangles.Num(), [&](const int32 Index)
 				{
 					const TVector<IndexType, 3>& Triangle = Triangles[Index];
 					const FVector3f VertexA = Vertices[Triangle.X];
@@ -166,7 +178,7 @@ struct Chaos::FTriangleMeshOverlapVisitorNoMTD<void>
 					Elements.MaxX[Index] = FMath::Max3(VertexA.X, VertexB.X, VertexC.X);
 					Elements.MaxY[Index] = FMath::Max3(VertexA.Y, VertexB.Y, VertexC.Y);
 					Elements.MaxZ[Index] = FMath::Max3(VertexA.Z, VertexB.Z, VertexC.Z);
-				}
+				});
 			}
 			Tree.Initialize(MoveTemp(Elements));
 		}
@@ -197,16 +209,11 @@ struct Chaos::FTriangleMeshOverlapVisitorNoMTD<void>
 			const TConstVoxelArrayView<FVoxelAABBTree::FNode> Nodes = Tree.GetNodes();
 			const TConstVoxelArrayView<FVoxelAABBTree::FLeaf> Leaves = Tree.GetLeaves();
 
-			const bool bHasMaterialIndices = FaceMaterials.Num() > 0;
+			const bool bHasMaterialIndices = TriangleMaterials.Num() > 0;
 
 			TVoxelArray<TVec3<IndexType>> NewTriangles;
-			NewTriangles.Reserve(Triangles.Num());
-
 			TVoxelArray<uint16> NewFaceMaterials;
-			NewFaceMaterials.Reserve(FaceMaterials.Num());
-
 			TVoxelArray<FVoxelFastBox> TriangleBounds;
-			TriangleBounds.Reserve(Triangles.Num());
 
 			TVoxelArray<FTrimeshBVH::FNode> NewNodes;
 			NewNodes.Reserve(Nodes.Num() - Leaves.Num());
@@ -219,6 +226,52 @@ struct Chaos::FTriangleMeshOverlapVisitorNoMTD<void>
 				Result->FastBVH.Nodes = MoveTemp(NewNodes);
 			};
 
+			// Leaves are laid out in traversal order, their triangles are copied in parallel once the layout is known
+			struct FLeafToCopy
+			{
+				int32 LeafIndex = 0;
+				int32 FirstTriangle = 0;
+			};
+			TVoxelArray<FLeafToCopy> LeavesToCopy;
+			LeavesToCopy.Reserve(Leaves.Num());
+
+			int32 NumNewTriangles = 0;
+
+			const auto CopyLeaves = [&]
+			{
+				VOXEL_SCOPE_COUNTER_NUM("Copy leaves", NumNewTriangles);
+				check(NumNewTriangles == Triangles.Num());
+
+				NewTriangles.SetNumUninitialized(NumNewTriangles);
+				FVoxelUtilities::SetNumFast(TriangleBounds, NumNewTriangles);
+
+				if (bHasMaterialIndices)
+				{
+					FVoxelUtilities::SetNumFast(NewFaceMaterials, NumNewTriangles);
+				}
+
+				Voxel::ParallelFor(LeavesToCopy, [&](const FLeafToCopy& LeafToCopy)
+				{
+					const FVoxelAABBTree::FLeaf& Leaf = Leaves[LeafToCopy.LeafIndex];
+
+					int32 WriteIndex = LeafToCopy.FirstTriangle;
+					for (int32 Index = Leaf.StartIndex; Index < Leaf.EndIndex; Index++)
+					{
+						const int32 TriangleIndex = Tree.GetPayload(Index);
+
+						TriangleBounds[WriteIndex] = Tree.GetBounds(Index);
+						NewTriangles[WriteIndex] = Triangles[TriangleIndex];
+
+						if (bHasMaterialIndices)
+						{
+							NewFaceMaterials[WriteIndex] = TriangleMaterials[TriangleIndex];
+						}
+
+						WriteIndex++;
+					}
+				});
+			};
+
 			// We're skipping leaf nodes below, handle the special case of having a single leaf node manually
 			if (Nodes.Num() == 1)
 			{
@@ -233,19 +286,10 @@ struct Chaos::FTriangleMeshOverlapVisitorNoMTD<void>
 				NewNode.Children.SetFaceCount(0, Leaf.Num());
 				NewNode.Children.SetBounds(0, Result->BoundingBox());
 
-				for (int32 Index = Leaf.StartIndex; Index < Leaf.EndIndex; Index++)
-				{
-					const int32 TriangleIndex = Tree.GetPayload(Index);
-
-					TriangleBounds.Add_EnsureNoGrow(Tree.GetBounds(Index));
-					NewTriangles.Add_EnsureNoGrow(Triangles[TriangleIndex]);
-
-					if (bHasMaterialIndices)
-					{
-						NewFaceMaterials.Add(FaceMaterials[TriangleIndex]);
-					}
-				}
+				LeavesToCopy.Add_EnsureNoGrow(FLeafToCopy{ RootNode.LeafIndex, 0 });
+				NumNewTriangles = Leaf.Num();
 
+				CopyLeaves();
 				return;
 			}
 			checkVoxelSlow(Nodes.Num() > 0);
@@ -290,21 +334,11 @@ struct Chaos::FTriangleMeshOverlapVisitorNoMTD<void>
 					const FVoxelAABBTree::FLeaf& Leaf = Leaves[ChildNode.LeafIndex];
 					checkVoxelSlow(Leaf.Num() > 0);
 
-					ChildData.SetChildOrFaceIndex(ChildIndex, NewTriangles.Num());
+					ChildData.SetChildOrFaceIndex(ChildIndex, NumNewTriangles);
 					ChildData.SetFaceCount(ChildIndex, Leaf.Num());
 
-					for (int32 Index = Leaf.StartIndex; Index < Leaf.EndIndex; Index++)
-					{
-						const int32 TriangleIndex = Tree.GetPayload(Index);
-
-						TriangleBounds.Add_EnsureNoGrow(Tree.GetBounds(Index));
-						NewTriangles.Add_EnsureNoGrow(Triangles[TriangleIndex]);
-
-						if (bHasMaterialIndices)
-						{
-							NewFaceMaterials.Add(FaceMaterials[TriangleIndex]);
-						}
-					}
+					LeavesToCopy.Add_EnsureNoGrow(FLeafToCopy{ ChildNode.LeafIndex, NumNewTriangles });
+					NumNewTriangles += Leaf.Num();
 				};
 
 				AddChildNode.template operator()<0>();
@@ -330,6 +364,8 @@ struct Chaos::FTriangleMeshOverlapVisitorNoMTD<void>
 					ChildData.SetChildOrFaceIndex(ChildIndex, NewIndex);
 				}
 			}
+
+			CopyLeaves();
 		};
 
 		return Result;
@@ -340,6 +376,92 @@ struct Chaos::FTriangleMeshOverlapVisitorNoMTD<void>
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
+// Cached triangle meshes are shared between all the callers cooking the same content
+class FVoxelChaosTriangleMeshCache
+{
+public:
+	TRefCountPtr<Chaos::FTriangleMeshImplicitObject> Find(const uint64 Hash)
+	{
+		VOXEL_SCOPE_LOCK(CriticalSection);
+
+		FEntry* Entry = HashToEntry_RequiresLock.Find(Hash);
+		if (!Entry)
+		{
+			return nullptr;
+		}
+
+		Entry->LastAccess = ++AccessCounter_RequiresLock;
+		return Entry->TriangleMesh;
+	}
+	void Add(
+		const uint64 Hash,
+		const TRefCountPtr<Chaos::FTriangleMeshImplicitObject>& TriangleMesh,
+		const int64 MaxAllocatedSize)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		const int64 NewAllocatedSize = FVoxelChaosTriangleMeshCooker::GetAllocatedSize(*TriangleMesh);
+		if (NewAllocatedSize > MaxAllocatedSize)
+		{
+			return;
+		}
+
+		VOXEL_SCOPE_LOCK(CriticalSection);
+
+		if (HashToEntry_RequiresLock.Contains(Hash))
+		{
+			// Cooked concurrently by another thread
+			return;
+		}
+
+		while (
+			HashToEntry_RequiresLock.Num() > 0 &&
+			AllocatedSize_RequiresLock + NewAllocatedSize > MaxAllocatedSize)
+		{
+			// Evict the least recently used entry
+			uint64 OldestHash = 0;
+			int64 OldestAccess = MAX_int64;
+			for (const auto& It : HashToEntry_RequiresLock)
+			{
+				if (It.Value.LastAccess < OldestAccess)
+				{
+					OldestHash = It.Key;
+					OldestAccess = It.Value.LastAccess;
+				}
+			}
+
+			AllocatedSize_RequiresLock -= HashToEntry_RequiresLock[OldestHash].AllocatedSize;
+			HashToEntry_RequiresLock.RemoveChecked(OldestHash);
+		}
+
+		HashToEntry_RequiresLock.Add_CheckNew(Hash, FEntry
+		{
+			TriangleMesh,
+			NewAllocatedSize,
+			++AccessCounter_RequiresLock
+		});
+		AllocatedSize_RequiresLock += NewAllocatedSize;
+	}
+
+private:
+	struct FEntry
+	{
+		TRefCountPtr<Chaos::FTriangleMeshImplicitObject> TriangleMesh;
+		int64 AllocatedSize = 0;
+		int64 LastAccess = 0;
+	};
+
+	FVoxelCriticalSection CriticalSection;
+	TVoxelMap<uint64, FEntry> HashToEntry_RequiresLock;
+	int64 AllocatedSize_RequiresLock = 0;
+	int64 AccessCounter_RequiresLock = 0;
+};
+FVoxelChaosTriangleMeshCache GVoxelChaosTriangleMeshCache;
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
 TRefCountPtr<Chaos::FTriangleMeshImplicitObject> FVoxelChaosTriangleMeshCooker::Create(
 	const TConstVoxelArrayView<int32> Indices,
 	const TConstVoxelArrayView<FVector3f> Vertices,
@@ -354,16 +476,62 @@ TRefCountPtr<Chaos::FTriangleMeshImplicitObject> FVoxelChaosTriangleMeshCooker::
 		return nullptr;
 	}
 
-	using FCooker = Chaos::FTriangleMeshOverlapVisitorNoMTD<void>;
+	const int64 MaxCacheSize = int64(GVoxelCollisionCookCacheSizeMB) * 1024 * 1024;
 
-	if (Vertices.Num() < MAX_uint16)
+	uint64 Hash = 0;
+	if (MaxCacheSize > 0)
 	{
-		return FCooker::CookTriangleMesh<false>(Indices, Vertices, FaceMaterials);
+		VOXEL_SCOPE_COUNTER("Hash");
+
+		Hash = FVoxelUtilities::MurmurHashMulti(
+			FVoxelUtilities::MurmurHashView(Indices),
+			FVoxelUtilities::MurmurHashView(Vertices),
+			FVoxelUtilities::MurmurHashView(FaceMaterials),
+			Indices.Num(),
+			Vertices.Num(),
+			FaceMaterials.Num(),
+			GVoxelCollisionFastCooking);
+
+		if (TRefCountPtr<Chaos::FTriangleMeshImplicitObject> CachedTriangleMesh = GVoxelChaosTriangleMeshCache.Find(Hash))
+		{
+			return CachedTriangleMesh;
+		}
 	}
-	else
+
+	using FCooker = Chaos::FTriangleMeshOverlapVisitorNoMTD<void>;
+
+	const TRefCountPtr<Chaos::FTriangleMeshImplicitObject> TriangleMesh =
+		Vertices.Num() < MAX_uint16
+		? FCooker::CookTriangleMesh<false>(Indices, Vertices, FaceMaterials)
+		: FCooker::CookTriangleMesh<true>(Indices, Vertices, FaceMaterials);
+
+	if (MaxCacheSize > 0 &&
+		TriangleMesh)
 	{
-		return FCooker::CookTriangleMesh<true>(Indices, Vertices, FaceMaterials);
+		GVoxelChaosTriangleMeshCache.Add(Hash, TriangleMesh, MaxCacheSize);
 	}
+
+	return TriangleMesh;
+}
+
+TVoxelArray<TRefCountPtr<Chaos::FTriangleMeshImplicitObject>> FVoxelChaosTriangleMeshCooker::Create(const TConstVoxelArrayView<FMesh> Meshes)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Meshes.Num());
+
+	TVoxelArray<TRefCountPtr<Chaos::FTriangleMeshImplicitObject>> Result;
+	Result.SetNum(Meshes.Num());
+
+	Voxel::ParallelFor(Result, [&](TRefCountPtr<Chaos::FTriangleMeshImplicitObject>& TriangleMesh, const int32 Index)
+	{
+		const FMesh& Mesh = Meshes[Index];
+
+		TriangleMesh = Create(
+			Mesh.Indices,
+			Mesh.Vertices,
+			Mesh.FaceMaterials);
+	});
+
+	return Result;
 }
 
 int64 FVoxelChaosTriangleMeshCooker::GetAllocatedSize(const Chaos::FTriangleMeshImplicitObject& TriangleMesh)
@@ -2,27 +2,76 @@
 
 #include "VoxelChunkedBitArrayTS.h"
 
+FVoxelChunkedBitArrayTS::FVoxelChunkedBitArrayTS()
+{
+	for (TVoxelAtomic<FPage*>& Page : Pages)
+	{
+		Page.Set(nullptr, std::memory_order_relaxed);
+	}
+}
+
+FVoxelChunkedBitArrayTS::~FVoxelChunkedBitArrayTS()
+{
+	const int32 NumChunks = NumChunks_Atomic.Get();
+
+	for (int32 ChunkIndex = 0; ChunkIndex < NumChunks; ChunkIndex++)
+	{
+		delete &GetChunk(ChunkIndex);
+	}
+
+	for (const TVoxelAtomic<FPage*>& Page : Pages)
+	{
+		delete Page.Get();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
 int64 FVoxelChunkedBitArrayTS::GetAllocatedSize() const
 {
+	const int32 NumChunks = NumChunks_Atomic.Get();
+	const int32 NumPages = FVoxelUtilities::DivideCeil(NumChunks, ChunksPerPage);
+
 	return
-		Chunks.GetAllocatedSize() +
-		Chunks.Num() * sizeof(FChunk);
+		sizeof(Pages) +
+		NumPages * sizeof(FPage) +
+		NumChunks * sizeof(FChunk);
 }
 
 void FVoxelChunkedBitArrayTS::SetNumChunks(const int32 NewNumChunks)
 {
 	VOXEL_FUNCTION_COUNTER();
-	VOXEL_SCOPE_WRITE_LOCK(CriticalSection);
 
-	if (Chunks.Num() >= NewNumChunks)
+	const int32 NumChunks = NumChunks_Atomic.Get(std::memory_order_relaxed);
+	if (NumChunks >= NewNumChunks)
 	{
 		return;
 	}
 
-	Chunks.Reserve(NewNumChunks);
+	// Bit indices are int32, this can only be reached by an invalid index
+	checkf(NewNumChunks <= MaxNumChunks, TEXT("Too many chunks: %d > %d"), NewNumChunks, MaxNumChunks);
 
-	while (Chunks.Num() < NewNumChunks)
+	for (int32 ChunkIndex = NumChunks; ChunkIndex < NewNumChunks; ChunkIndex++)
 	{
-		Chunks.Add(MakeUnique<FChunk>(ForceInit));
+		TVoxelAtomic<FPage*>& PagePtr = Pages[ChunkIndex >> ChunksPerPageLog2];
+
+		FPage* Page = PagePtr.Get(std::memory_order_relaxed);
+		if (!Page)
+		{
+			Page = new FPage(NoInit);
+			for (TVoxelAtomic<FChunk*>& Chunk : *Page)
+			{
+				Chunk.Set(nullptr, std::memory_order_relaxed);
+			}
+			PagePtr.Set(Page, std::memory_order_release);
+		}
+
+		TVoxelAtomic<FChunk*>& Chunk = (*Page)[ChunkIndex & (ChunksPerPage - 1)];
+		checkVoxelSlow(!Chunk.Get(std::memory_order_relaxed));
+		Chunk.Set(new FChunk(ForceInit), std::memory_order_release);
 	}
-}
\ No newline at end of file
+
+	NumChunks_Atomic.Set(NewNumChunks, std::memory_order_release);
+}
@@ -1,6 +1,13 @@
 // Copyright Voxel Plugin SAS. All Rights Reserved.
 
 #include "VoxelMinimal.h"
+#include "VoxelBoxSet.h"
+#include "VoxelInvokerChunkTracker.h"
+#include "VoxelFastOctree.h"
+#include "VoxelDependency.h"
+#include "VoxelInvalidationQueue.h"
+#include "VoxelTransvoxelMesher.h"
+#include "VoxelTaskContext.h"
 
 #if !UE_BUILD_SHIPPING
 VOXEL_RUN_ON_STARTUP_GAME()
@@ -81,5 +88,614 @@ VOXEL_RUN_ON_STARTUP_GAME()
 		}
 		check(Sum == NewSum);
 	}
+
+	{
+		TVoxelFastOctree<> OldTree(8);
+		TVoxelFastOctree<> NewTree(8);
+
+		OldTree.FindOrAddLeaf(FIntVector(0, 0, 0));
+		NewTree.FindOrAddLeaf(FIntVector(0, 0, 0));
+		NewTree.FindOrAddLeaf(FIntVector(-10, 20, 30));
+
+		const TVoxelFastOctree<>::FDiff Diff = TVoxelFastOctree<>::ParallelDiff(OldTree, NewTree, 2);
+		check(Diff.RemovedNodes.Num() == 0);
+		check(Diff.ResizedNodes.Num() == 0);
+		check(Diff.AddedNodes.Num() == NewTree.NumNodes() - OldTree.NumNodes());
+
+		FVoxelCounter32 NumNodes;
+		NewTree.ParallelTraverse([&](const TVoxelFastOctree<>::FNodeRef&)
+		{
+			NumNodes.Increment();
+		}, 2);
+		check(NumNodes.Get() == NewTree.NumNodes());
+	}
+
+	{
+		const TSharedRef<int32> Shared = MakeShared<int32>(0);
+		const TVoxelArray<int32> Array = { 1, 2, 3, 4 };
+
+		TVoxelUniqueFunction<int32(), 16> Small = [Shared] { return *Shared + 1; };
+		TVoxelUniqueFunction<int32(), 16> Large = [Shared, Array, Padding = FVector4d()] { return *Shared + Array.Num(); };
+		check(!Small.IsHeapAllocated());
+		check(Large.IsHeapAllocated());
+
+		// Inline to inline, inline to heap, heap to heap
+		TVoxelUniqueFunction<int32(), 64> LargeInline = [Shared, Array] { return *Shared + Array.Num(); };
+		TVoxelUniqueFunction<int32(), 8> Spilled = MoveTemp(LargeInline);
+		TVoxelUniqueFunction<int32(), 64> FromHeap = MoveTemp(Large);
+		TVoxelUniqueFunction<int32(), 64> FromSmall = MoveTemp(Small);
+		check(!LargeInline && !Large && !Small);
+		check(Spilled.IsHeapAllocated());
+		check(!FromSmall.IsHeapAllocated());
+
+		*Shared = 10;
+		check(Spilled() == 14);
+		check(FromHeap() == 14);
+		check(FromSmall() == 11);
+
+		Spilled = nullptr;
+		FromHeap = nullptr;
+		FromSmall = {};
+		check(Shared.GetSharedReferenceCount() == 1);
+
+		// Not bitwise relocatable: must be move constructed
+		struct FSelfPointer
+		{
+			FSelfPointer* Self = this;
+
+			FSelfPointer() = default;
+			FSelfPointer(FSelfPointer&&) {}
+			FSelfPointer& operator=(FSelfPointer&&) = delete;
+
+			int32 operator()() const
+			{
+				return Self == this ? 1 : 0;
+			}
+		};
+		checkStatic(!IsVoxelTriviallyRelocatable_V<FSelfPointer>);
+
+		TVoxelUniqueFunction<int32(), 16> SelfPointer = FSelfPointer();
+		check(!SelfPointer.IsHeapAllocated());
+		check(SelfPointer() == 1);
+
+		TVoxelUniqueFunction<int32(), 16> MovedSelfPointer = MoveTemp(SelfPointer);
+		check(MovedSelfPointer() == 1);
+
+		TVoxelUniqueFunction<int32(), 32> ResizedSelfPointer = MoveTemp(MovedSelfPointer);
+		check(!ResizedSelfPointer.IsHeapAllocated());
+		check(ResizedSelfPointer() == 1);
+	}
+
+	{
+		FVoxelBoxSet BoxSet;
+		BoxSet.Add(FVoxelBox(FVector(0, 0, 0), FVector(1, 1, 1)));
+		BoxSet.Add(FVoxelBox(FVector(1, 0, 0), FVector(2, 1, 1)));
+		BoxSet.Add(FVoxelBox(FVector(0.5, 0, 0), FVector(1.5, 1, 1)));
+		BoxSet.Add(FVoxelBox(FVector(0.25, 0.25, 0.25), FVector(0.75, 0.75, 0.75)));
+		check(BoxSet.Num() == 3);
+
+		BoxSet.Compact();
+		check(BoxSet.Num() == 1);
+		check(BoxSet.GetBox(0) == FVoxelBox(FVector(0, 0, 0), FVector(2, 1, 1)));
+
+		BoxSet.Subtract(FVoxelBox(FVector(0.5, 0.5, 0.5), FVector(1, 1, 1)));
+		check(FMath::IsNearlyEqual(BoxSet.GetVolume(), 2 - 0.125));
+		check(!BoxSet.Intersects(FVoxelBox(FVector(0.6, 0.6, 0.6), FVector(0.9, 0.9, 0.9))));
+
+		BoxSet.Add(FVoxelBox(FVector(10, 10, 10), FVector(11, 11, 11)));
+
+		// Merging with the far away box would add way more than the region volume
+		check(BoxSet.Approximate(1, 1.) <= 2 - 0.125 + 1);
+		check(BoxSet.Num() > 1);
+		check(BoxSet.GetVolume() <= 2 * (2 - 0.125 + 1) + KINDA_SMALL_NUMBER);
+
+		const double VolumeBefore = BoxSet.GetVolume();
+		const double AddedVolume = BoxSet.Approximate(1, MAX_dbl);
+		check(BoxSet.Num() == 1);
+		check(BoxSet.GetVolume() <= VolumeBefore + AddedVolume + KINDA_SMALL_NUMBER);
+	}
+
+	{
+		// Two unit boxes with a 0.5 gap: merging adds 0.5 for a volume of 2
+		FVoxelBoxSet BoxSet;
+		BoxSet.Add(FVoxelBox(FVector(0, 0, 0), FVector(1, 1, 1)));
+		BoxSet.Add(FVoxelBox(FVector(1.5, 0, 0), FVector(2.5, 1, 1)));
+
+		check(BoxSet.Approximate(1, 0.1) == 0.);
+		check(BoxSet.Num() == 2);
+
+		check(FMath::IsNearlyEqual(BoxSet.Approximate(1, 0.5), 0.5));
+		check(BoxSet.Num() == 1);
+		check(BoxSet.GetBox(0) == FVoxelBox(FVector(0, 0, 0), FVector(2.5, 1, 1)));
+	}
+
+	{
+		FRandomStream Stream(1337);
+
+		TVoxelArray<uint64> Keys;
+		TVoxelArray<int32> Values;
+		TVoxelArray<uint8> Mask;
+		for (int32 Index = 0; Index < 100000; Index++)
+		{
+			Keys.Add(uint64(Stream.RandRange(0, 1 << 20)) << 20);
+			Values.Add(Index);
+			Mask.Add(Stream.RandRange(0, 3) == 0);
+		}
+
+		TVoxelArray<uint64> SortedKeys = Keys;
+		SortedKeys.Sort();
+
+		FVoxelUtilities::RadixSort(Keys, Values);
+		check(Keys == SortedKeys);
+
+		for (int32 Index = 1; Index < Keys.Num(); Index++)
+		{
+			// Stable
+			check(Keys[Index - 1] != Keys[Index] || Values[Index - 1] < Values[Index]);
+		}
+
+		TVoxelArray<int32> Counts;
+		for (const uint8 Value : Mask)
+		{
+			Counts.Add(Value);
+		}
+
+		TVoxelArray<int32> Offsets;
+		FVoxelUtilities::SetNumFast(Offsets, Counts.Num());
+
+		const int32 NumSet = FVoxelUtilities::ExclusiveScan(Counts, Offsets);
+		const TVoxelArray<int32> Indices = FVoxelUtilities::CompactIndices(Mask);
+		check(Indices.Num() == NumSet);
+
+		for (int32 Index = 0; Index < Mask.Num(); Index++)
+		{
+			if (Mask[Index])
+			{
+				check(Indices[Offsets[Index]] == Index);
+			}
+		}
+
+		// Inclusive is exclusive shifted by one, in place
+		TVoxelArray<int32> InclusiveOffsets = Counts;
+		check(FVoxelUtilities::InclusiveScan(InclusiveOffsets, InclusiveOffsets) == NumSet);
+		check(InclusiveOffsets.Last() == NumSet);
+		for (int32 Index = 0; Index < Counts.Num(); Index++)
+		{
+			check(InclusiveOffsets[Index] == Offsets[Index] + Counts[Index]);
+		}
+
+		TVoxelArray<uint32> Bins;
+		TVoxelArray<int32> ExpectedHistogram;
+		ExpectedHistogram.SetNumZeroed(37);
+		for (int32 Index = 0; Index < 100000; Index++)
+		{
+			const uint32 Bin = Stream.RandRange(0, 36);
+			Bins.Add(Bin);
+			ExpectedHistogram[Bin]++;
+		}
+		check(FVoxelUtilities::Histogram(Bins, 37) == ExpectedHistogram);
+	}
+
+	{
+		FRandomStream Stream(1337);
+
+		TVoxelArray<FIntVector> ValuesA;
+		TVoxelArray<FIntVector> ValuesB;
+		TVoxelArray<int32> Indices;
+		for (int32 Index = 0; Index < 100000; Index++)
+		{
+			Indices.Add(Index);
+			ValuesA.Add(FIntVector(Stream.RandRange(0, 63), Stream.RandRange(0, 63), Stream.RandRange(0, 15)));
+			ValuesB.Add(FIntVector(Stream.RandRange(0, 63), Stream.RandRange(0, 63), Stream.RandRange(8, 23)));
+		}
+
+		TVoxelSet<FIntVector> SetA;
+		SetA.BuildFromArray(ValuesA);
+
+		TVoxelSet<FIntVector> SerialSetA;
+		for (const FIntVector& Value : ValuesA)
+		{
+			SerialSetA.Add(Value);
+		}
+		// Same order as serial adds
+		check(SetA.Array() == SerialSetA.Array());
+
+		for (const FIntVector& Value : ValuesA)
+		{
+			check(SetA.Contains(Value));
+		}
+
+		TVoxelSet<FIntVector> SetB;
+		SetB.BuildFromArray(ValuesB);
+
+		const TVoxelSet<FIntVector> Union = SetA.Union(SetB);
+		const TVoxelSet<FIntVector> Intersection = SetA.Intersect(SetB);
+		check(Union.Num() + Intersection.Num() == SetA.Num() + SetB.Num());
+
+		for (const FIntVector& Value : Intersection)
+		{
+			check(Value.Z >= 8 && Value.Z <= 15);
+			check(SetA.Contains(Value) && SetB.Contains(Value));
+		}
+
+		TVoxelMap<FIntVector, int32> Map;
+		Map.BuildFromArrays(ValuesA, Indices);
+		check(Map.Num() == SetA.Num());
+
+		for (int32 Index = 0; Index < ValuesA.Num(); Index++)
+		{
+			// First value is kept
+			check(Map[ValuesA[Index]] <= Index);
+		}
+	}
+
+	{
+		FVoxelInvokerChunkTracker Tracker(FTransform::Identity, 100, 1000000);
+
+		TVoxelMap<uint64, FVoxelChunkInvoker> Invokers;
+		Invokers.Add_CheckNew(0, FVoxelChunkInvoker{ FSphere(FVector(0, 0, 0), 500) });
+		Invokers.Add_CheckNew(1, FVoxelChunkInvoker{ FSphere(FVector(300, 0, 0), 400) });
+
+		FVoxelInvokerChunkDelta Delta;
+		Tracker.Update(Invokers, Delta);
+		check(Delta.RemovedChunks.Num() == 0);
+		check(Delta.AddedChunks.Num() == Tracker.NumChunks());
+
+		TVoxelSet<FIntVector> Chunks(Delta.AddedChunks);
+
+		for (int32 Step = 0; Step < 10; Step++)
+		{
+			Invokers[0].Sphere.Center.X += 37;
+			Invokers[1].Sphere.W += 13 * (Step % 2 ? 1 : -1);
+
+			Tracker.Update(Invokers, Delta);
+
+			for (const FIntVector& Chunk : Delta.RemovedChunks)
+			{
+				Chunks.Remove_Ensure(Chunk);
+			}
+			for (const FIntVector& Chunk : Delta.AddedChunks)
+			{
+				check(Chunks.TryAdd(Chunk));
+			}
+		}
+
+		FVoxelInvokerChunkTracker NewTracker(FTransform::Identity, 100, 1000000);
+		NewTracker.Update(Invokers, Delta);
+		check(Chunks.OrderIndependentEqual(TVoxelSet<FIntVector>(NewTracker.GetChunks())));
+		check(Chunks.OrderIndependentEqual(TVoxelSet<FIntVector>(Tracker.GetChunks())));
+
+		Invokers.Remove(1);
+		Tracker.Update(Invokers, Delta);
+		check(Delta.AddedChunks.Num() == 0);
+
+		FVoxelInvokerChunkTracker LimitedTracker(FTransform::Identity, 100, 10);
+		Invokers.Add_CheckNew(1, FVoxelChunkInvoker{ FSphere(FVector(0, 0, 0), 50), 1 });
+		LimitedTracker.Update(Invokers, Delta);
+		check(LimitedTracker.GetNumRejectedInvokers() == 1);
+		check(LimitedTracker.NumChunks() <= 10);
+	}
+
+	{
+		FRandomStream Stream(1234);
+
+		TVoxelArray<FVector3f> Vectors;
+		for (int32 Index = 0; Index < 10000; Index++)
+		{
+			Vectors.Add(FVector3f(Stream.GetUnitVector()));
+		}
+		Vectors.Add(FVector3f::UnitX());
+		Vectors.Add(-FVector3f::UnitZ());
+
+		const TVoxelArray<FVoxelOctahedron> Octahedrons = FVoxelUtilities::MakeOctahedrons(Vectors);
+		const TVoxelArray<FVoxelOctahedron> PreciseOctahedrons = FVoxelUtilities::MakeOctahedrons_Precise(Vectors);
+		const TVoxelArray<FVector3f> UnitVectors = FVoxelUtilities::GetUnitVectors(Octahedrons);
+		const TVoxelArray<FVector3f> PreciseUnitVectors = FVoxelUtilities::GetUnitVectors(PreciseOctahedrons);
+
+		const TVoxelArray<uint32> Quantized8 = FVoxelUtilities::MakeQuantizedOctahedrons(Octahedrons, 8);
+		const TVoxelArray<FVector3f> Quantized8Vectors = FVoxelUtilities::GetUnitVectors(Quantized8, 8);
+
+		const TVoxelArray<uint32> Quantized12 = FVoxelUtilities::MakeQuantizedOctahedrons(Vectors, 12);
+		const TVoxelArray<FVector3f> Quantized12Vectors = FVoxelUtilities::GetUnitVectors(Quantized12, 12);
+
+		const TVoxelArray<FVoxelOctahedron> PackedNormalOctahedrons = FVoxelUtilities::MakeOctahedrons(FVoxelUtilities::MakePackedNormals(PreciseOctahedrons));
+
+		for (int32 Index = 0; Index < Vectors.Num(); Index++)
+		{
+			const FVector3f Vector = Vectors[Index];
+
+			check(UnitVectors[Index].Equals(Octahedrons[Index].GetUnitVector(), 1.e-6f));
+			check(Quantized8Vectors[Index].Equals(UnitVectors[Index], 1.e-6f));
+			check(Quantized8[Index] == (Octahedrons[Index].X | (Octahedrons[Index].Y << 8)));
+
+			check(FVector3f::DotProduct(Vector, PreciseUnitVectors[Index]) >= FVector3f::DotProduct(Vector, UnitVectors[Index]) - 1.e-6f);
+			check(FVector3f::DotProduct(Vector, PreciseUnitVectors[Index]) > 0.9995f);
+			check(FVector3f::DotProduct(Vector, Quantized12Vectors[Index]) > 0.99999f);
+
+			check(FVector3f::DotProduct(PreciseUnitVectors[Index], PackedNormalOctahedrons[Index].GetUnitVector()) > 0.999f);
+		}
+
+		// Re-encoding a decoded octahedron is stable
+		const TVoxelArray<FVoxelOctahedron> ReencodedOctahedrons = FVoxelUtilities::MakeOctahedrons_Precise(PreciseUnitVectors);
+		for (int32 Index = 0; Index < Vectors.Num(); Index++)
+		{
+			check(FVector3f::DotProduct(PreciseUnitVectors[Index], ReencodedOctahedrons[Index].GetUnitVector()) > 0.99999f);
+		}
+	}
+
+	{
+		// Mesh a sphere with a low res chunk and its high res neighbors on +X and +Y,
+		// including the chunks along the edge where the two transition faces meet
+		constexpr int32 ChunkSize = 8;
+		constexpr int32 TransitionMask = (1 << 1) | (1 << 3);
+		const FVector3f Center(15.6f, 16.3f, 8.1f);
+		constexpr float Radius = 5.3f;
+
+		const auto GetDensity = [&](const FVector3f& Position)
+		{
+			return FVector3f::Distance(Position, Center) - Radius;
+		};
+
+		TVoxelArray<FVector3f> Vertices;
+		TVoxelArray<int32> Indices;
+
+		const auto AddChunk = [&](const FVector3f& Offset, const float VoxelSize, const int32 ChunkTransitionMask)
+		{
+			TVoxelArray<float> Densities;
+			for (int32 Z = -1; Z < ChunkSize + 2; Z++)
+			{
+				for (int32 Y = -1; Y < ChunkSize + 2; Y++)
+				{
+					for (int32 X = -1; X < ChunkSize + 2; X++)
+					{
+						Densities.Add(GetDensity(Offset + FVector3f(X, Y, Z) * VoxelSize));
+					}
+				}
+			}
+
+			FVoxelTransvoxelMesher Mesher;
+			Mesher.ChunkSize = ChunkSize;
+			Mesher.VoxelSize = VoxelSize;
+			Mesher.Densities = Densities;
+
+			TVoxelStaticArray<TVoxelArray<float>, 6> TransitionDensities;
+			for (int32 Face = 0; Face < 6; Face++)
+			{
+				if (!(ChunkTransitionMask & (1 << Face)))
+				{
+					continue;
+				}
+
+				const int32 Axis = Face / 2;
+				const int32 AxisU = (Axis + 1) % 3;
+				const int32 AxisV = (Axis + 2) % 3;
+
+				for (int32 V = 0; V < 2 * ChunkSize + 1; V++)
+				{
+					for (int32 U = 0; U < 2 * ChunkSize + 1; U++)
+					{
+						FVector3f Position = Offset;
+						Position[Axis] += (Face % 2 == 1 ? ChunkSize : 0) * VoxelSize;
+						Position[AxisU] += U * VoxelSize / 2.f;
+						Position[AxisV] += V * VoxelSize / 2.f;
+						TransitionDensities[Face].Add(GetDensity(Position));
+					}
+				}
+
+				Mesher.TransitionDensities[Face] = TransitionDensities[Face];
+			}
+
+			const TSharedRef<FVoxelTransvoxelMesh> Mesh = Mesher.CreateMesh();
+
+			const int32 FirstVertex = Vertices.Num();
+			for (const FVector3f& Vertex : Mesh->Vertices)
+			{
+				Vertices.Add(Offset + Vertex);
+			}
+			for (const int32 Index : Mesh->Indices)
+			{
+				Indices.Add(FirstVertex + Index);
+			}
+		};
+
+		AddChunk(FVector3f(0.f), 2.f, TransitionMask);
+
+		for (int32 A = 0; A < 2 * ChunkSize; A += ChunkSize)
+		{
+			for (int32 Z = 0; Z < 2 * ChunkSize; Z += ChunkSize)
+			{
+				AddChunk(FVector3f(2 * ChunkSize, A, Z), 1.f, 0);
+				AddChunk(FVector3f(A, 2 * ChunkSize, Z), 1.f, 0);
+			}
+			AddChunk(FVector3f(2 * ChunkSize, 2 * ChunkSize, A), 1.f, 0);
+		}
+
+		// Weld vertices across chunks
+		TVoxelMap<FIntVector, int32> PositionToVertex;
+		TVoxelArray<int32> VertexToWelded;
+		for (const FVector3f& Vertex : Vertices)
+		{
+			const FIntVector Position = FVoxelUtilities::RoundToInt(Vertex * 1024.f);
+			VertexToWelded.Add(PositionToVertex.FindOrAdd_WithDefault(Position, PositionToVertex.Num()));
+		}
+
+		// Watertight and consistently wound: every edge is used once in each direction
+		TVoxelMap<FIntPoint, int32> EdgeToCount;
+		float Volume = 0.f;
+		for (int32 Index = 0; Index < Indices.Num(); Index += 3)
+		{
+			const int32 A = VertexToWelded[Indices[Index + 0]];
+			const int32 B = VertexToWelded[Indices[Index + 1]];
+			const int32 C = VertexToWelded[Indices[Index + 2]];
+			if (A == B ||
+				A == C ||
+				B == C)
+			{
+				continue;
+			}
+
+			EdgeToCount.FindOrAdd(FIntPoint(A, B))++;
+			EdgeToCount.FindOrAdd(FIntPoint(B, C))++;
+			EdgeToCount.FindOrAdd(FIntPoint(C, A))++;
+
+			// Same convention as FVoxelUtilities::GetTriangleNormal, positive if triangles point outside
+			const FVector3f VertexA = Vertices[Indices[Index + 0]] - Center;
+			const FVector3f VertexB = Vertices[Indices[Index + 1]] - Center;
+			const FVector3f VertexC = Vertices[Indices[Index + 2]] - Center;
+			Volume += FVector3f::DotProduct(VertexA, FVector3f::CrossProduct(VertexC - VertexA, VertexB - VertexA)) / 6.f;
+		}
+		check(EdgeToCount.Num() > 0);
+		check(FMath::IsNearlyEqual(Volume, 4.f / 3.f * PI * FMath::Cube(Radius), 0.5f * FMath::Cube(Radius)));
+
+		for (const auto& It : EdgeToCount)
+		{
+			check(It.Value == 1);
+			check(EdgeToCount.FindRef(FIntPoint(It.Key.Y, It.Key.X)) == 1);
+		}
+	}
+
+	{
+		FVoxelArena Arena;
+
+		// Chunks are cache line aligned
+		void* A = Arena.Allocate(1, 1);
+		void* B = Arena.Allocate(8, 64);
+		check(IsAligned(B, 64));
+		check(Arena.GetUsedSize() == 64 + 8);
+		check(Arena.GetHighWaterMark() == 64 + 8);
+
+		// Freeing the last allocation also reclaims its padding
+		Arena.Free(B, 8);
+		check(Arena.GetUsedSize() == 1);
+		Arena.Free(A, 1);
+		check(Arena.GetUsedSize() == 0);
+
+		// Used size doesn't drift and memory is reused
+		for (int32 Index = 0; Index < 100; Index++)
+		{
+			void* C = Arena.Allocate(1, 1);
+			void* D = Arena.Allocate(8, 16 << (Index % 3));
+			check(C == A);
+			check(IsAligned(D, 16 << (Index % 3)));
+			Arena.Free(D, 8);
+			Arena.Free(C, 1);
+			check(Arena.GetUsedSize() == 0);
+		}
+		check(Arena.GetHighWaterMark() == 64 + 8);
+
+		void* Large = Arena.Allocate(FVoxelArena::MaxSmallAllocationSize + 1, 16);
+		check(Arena.GetHighWaterMark() == FVoxelArena::MaxSmallAllocationSize + 1);
+		Arena.Free(Large, FVoxelArena::MaxSmallAllocationSize + 1);
+		check(Arena.GetUsedSize() == 0);
+	}
+
+	{
+		const TSharedRef<FVoxelInvalidationQueue> InvalidationQueue = FVoxelInvalidationQueue::Create();
+
+		// Invalidated then freed right away: the next dependency reuses its index with a different serial number
+		FVoxelDependency2D::Create("Freed 2D")->Invalidate(FVoxelBox2D(FVector2D(0), FVector2D(2)));
+		const TSharedRef<FVoxelDependency2D> Dependency2D = FVoxelDependency2D::Create("Test 2D");
+
+		FVoxelDependency3D::Create("Freed 3D")->Invalidate(FVoxelBox(FVector(0), FVector(2)));
+		const TSharedRef<FVoxelDependency3D> Dependency3D = FVoxelDependency3D::Create("Test 3D");
+
+		const auto IsInvalidated2D = [&](const double X)
+		{
+			FVoxelDependencyCollector DependencyCollector(STATIC_FNAME("Test"));
+			DependencyCollector.AddDependency(*Dependency2D, FVoxelBox2D(FVector2D(X, 0), FVector2D(X + 2, 2)));
+			return DependencyCollector.Finalize(&InvalidationQueue.Get(), {})->IsInvalidated();
+		};
+		const auto IsInvalidated3D = [&](const double X)
+		{
+			FVoxelDependencyCollector DependencyCollector(STATIC_FNAME("Test"));
+			DependencyCollector.AddDependency(*Dependency3D, FVoxelBox(FVector(X, 0, 0), FVector(X + 2, 2, 2)));
+			return DependencyCollector.Finalize(&InvalidationQueue.Get(), {})->IsInvalidated();
+		};
+
+		check(!IsInvalidated2D(0));
+		check(!IsInvalidated3D(0));
+
+		// Boxes at X = 10 * Index, separated by gaps
+		const auto Invalidate = [&](const int32 StartIndex, const int32 EndIndex)
+		{
+			for (int32 Index = StartIndex; Index < EndIndex; Index++)
+			{
+				Dependency2D->Invalidate(FVoxelBox2D(FVector2D(10 * Index, 0), FVector2D(10 * Index + 2, 2)));
+				Dependency3D->Invalidate(FVoxelBox(FVector(10 * Index, 0, 0), FVector(10 * Index + 2, 2, 2)));
+			}
+		};
+
+		// Below MaxBoxesPerDependency, boxes are tested one by one
+		Invalidate(1, 10);
+		check(IsInvalidated2D(30));
+		check(IsInvalidated3D(30));
+		check(!IsInvalidated2D(35));
+		check(!IsInvalidated3D(35));
+		check(!IsInvalidated2D(0));
+		check(!IsInvalidated3D(0));
+
+		// Above it, boxes are moved to trees
+		Invalidate(10, 200);
+		// Contained in a box that was moved to a tree, skipped
+		Invalidate(50, 51);
+		check(IsInvalidated2D(30));
+		check(IsInvalidated3D(30));
+		check(IsInvalidated2D(1500));
+		check(IsInvalidated3D(1500));
+		check(!IsInvalidated2D(1505));
+		check(!IsInvalidated3D(1505));
+		check(!IsInvalidated2D(0));
+		check(!IsInvalidated3D(0));
+		check(!IsInvalidated2D(2000));
+		check(!IsInvalidated3D(2000));
+
+		// Many single box invalidations, going through tree merges
+		for (int32 Index = 200; Index < 5000; Index++)
+		{
+			Invalidate(Index, Index + 1);
+		}
+		check(IsInvalidated2D(30));
+		check(IsInvalidated3D(30));
+		check(IsInvalidated2D(41230));
+		check(IsInvalidated3D(41230));
+		check(!IsInvalidated2D(41235));
+		check(!IsInvalidated3D(41235));
+		check(!IsInvalidated2D(50000));
+		check(!IsInvalidated3D(50000));
+	}
+
+	{
+		const TSharedRef<FVoxelTaskContext> Context = FVoxelTaskContext::Create(STATIC_FNAME("GCSafeTaskTest"));
+
+		const auto RunGCSafeTask = [&]
+		{
+			TVoxelAtomic<bool> bRan = false;
+			TVoxelAtomic<bool> bRanOnGameThread = false;
+			{
+				FVoxelTaskScope Scope(*Context);
+
+				Voxel::GCSafeTask([&]
+				{
+					check(Voxel_CanAccessUObject());
+					bRanOnGameThread.Set(IsInGameThread());
+					bRan.Set(true);
+				});
+			}
+			Context->FlushAllTasks();
+
+			check(bRan.Get());
+			return bRanOnGameThread.Get();
+		};
+
+		if (!GVoxelNoAsync)
+		{
+			check(!RunGCSafeTask());
+		}
+
+		const bool bPreviousRunGCSafeTasksOnGameThread = GVoxelRunGCSafeTasksOnGameThread;
+		GVoxelRunGCSafeTasksOnGameThread = true;
+		check(RunGCSafeTask());
+		GVoxelRunGCSafeTasksOnGameThread = bPreviousRunGCSafeTasksOnGameThread;
+	}
 }
 #endif
\ No newline at end of file
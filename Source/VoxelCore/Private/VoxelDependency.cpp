@@ -5,12 +5,23 @@
 #include "VoxelInvalidationCallstack.h"
 #include "VoxelAABBTree.h"
 #include "VoxelAABBTree2D.h"
+#include "VoxelBoxSet.h"
 
 VOXEL_CONSOLE_VARIABLE(
 	VOXELCORE_API, bool, GVoxelLogInvalidations, false,
 	"voxel.LogInvalidations",
 	"Log whenever an invalidation happen. Useful to track what's causing the voxel terrain to refresh.");
 
+VOXEL_CONSOLE_VARIABLE(
+	VOXELCORE_API, int32, GVoxelMaxBatchedInvalidationBoxes, 256,
+	"voxel.MaxBatchedInvalidationBoxes",
+	"Max number of boxes per dependency when invalidating batched invalidations. Boxes are merged beyond this, invalidating slightly larger regions. 0 to disable");
+
+VOXEL_CONSOLE_VARIABLE(
+	VOXELCORE_API, float, GVoxelMaxBatchedInvalidationOverCoverage, 0.5f,
+	"voxel.MaxBatchedInvalidationOverCoverage",
+	"Max volume added when merging batched invalidation boxes, relative to the volume of the boxes. Merging stops beyond this, even if there are more than voxel.MaxBatchedInvalidationBoxes boxes");
+
 DEFINE_VOXEL_INSTANCE_COUNTER(FVoxelDependencyBase);
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -46,8 +57,10 @@ TSharedRef<FVoxelDependencyBase> FVoxelDependencyBase::CreateImpl(const FString&
 	});
 }
 
-template<typename LambdaType>
-void FVoxelDependencyBase::InvalidateTrackers(LambdaType ShouldInvalidate)
+template<typename QueueLambdaType, typename LambdaType>
+void FVoxelDependencyBase::InvalidateTrackers(
+	QueueLambdaType AddToQueue,
+	LambdaType ShouldInvalidate)
 {
 	VOXEL_FUNCTION_COUNTER();
 
@@ -59,29 +72,20 @@ void FVoxelDependencyBase::InvalidateTrackers(LambdaType ShouldInvalidate)
 
 		for (FVoxelInvalidationQueue* InvalidationQueue : GVoxelDependencyManager->GetInvalidationQueues_RequiresLock())
 		{
-			VOXEL_SCOPE_WRITE_LOCK(InvalidationQueue->CriticalSection);
-
-			InvalidationQueue->Invalidations_RequiresLock.Add(FVoxelInvalidationQueue::FInvalidation
-			{
-				MakeStrongPtrLambda(this, [this, ShouldInvalidate](const FVoxelDependencyTracker& Tracker)
-				{
-					// ShouldInvalidate can only be called if the tracker is actually referencing us
-					// InvalidationQueue doesn't check that, so manually check for references here
-					return
-						Tracker.AllDependencies.Contains(DependencyRef) &&
-						ShouldInvalidate(Tracker);
-				}),
-				Callstack
-			});
+			AddToQueue(*InvalidationQueue, Callstack);
 		}
 	}
 
+	// Small per-call scratch below is allocated from this
+	// Tracker index lists scale with the number of trackers and are filled from ParallelFor, so they stay off the arena
+	FVoxelArena Arena;
+
 	int32 NumBits;
 	int32 NumTrackersChecked;
 	int32 NumTrackersInvalidated;
-	TVoxelMap<FMinimalName, int32> CheckedTrackerNameToCount;
-	TVoxelMap<FMinimalName, int32> InvalidatedTrackerNameToCount;
-	TVoxelChunkedArray<FVoxelOnInvalidated> OnInvalidatedQueue;
+	TVoxelArenaMap<FMinimalName, int32> CheckedTrackerNameToCount;
+	TVoxelArenaMap<FMinimalName, int32> InvalidatedTrackerNameToCount;
+	TVoxelArenaArray<FVoxelOnInvalidated> OnInvalidatedQueue;
 
 	const double StartTime = FPlatformTime::Seconds();
 	{
@@ -196,10 +200,24 @@ void FVoxelDependencyBase::InvalidateTrackers(LambdaType ShouldInvalidate)
 
 			for (auto& It : LocalBatch.Dependency3DToBoundsToInvalidate)
 			{
-				if (const TSharedPtr<FVoxelDependency3D> Dependency = It.Key.Pin())
+				const TSharedPtr<FVoxelDependency3D> Dependency = It.Key.Pin();
+				if (!Dependency)
 				{
-					Dependency->Invalidate(FVoxelAABBTree::Create(It.Value));
+					continue;
 				}
+
+				// Stamps are often overlapping or adjacent, coalesce them to reduce tree size and tracker tests
+				FVoxelBoxSet BoxSet(It.Value);
+				BoxSet.Compact();
+
+				if (GVoxelMaxBatchedInvalidationBoxes > 0)
+				{
+					BoxSet.Approximate(
+						GVoxelMaxBatchedInvalidationBoxes,
+						GVoxelMaxBatchedInvalidationOverCoverage);
+				}
+
+				Dependency->Invalidate(FVoxelAABBTree::Create(BoxSet.GetBoxes()));
 			}
 			for (auto& It : LocalBatch.Dependency2DToBoundsToInvalidate)
 			{
@@ -292,7 +310,12 @@ void FVoxelDependency::Invalidate()
 		return;
 	}
 
-	InvalidateTrackers([&](const FVoxelDependencyTracker& Tracker)
+	InvalidateTrackers(
+	[&](FVoxelInvalidationQueue& InvalidationQueue, const TSharedRef<const FVoxelInvalidationCallstack>& Callstack)
+	{
+		InvalidationQueue.Invalidate(DependencyRef, Callstack);
+	},
+	[&](const FVoxelDependencyTracker& Tracker)
 	{
 		checkVoxelSlow(Tracker.Dependencies.Contains(DependencyRef));
 		return true;
@@ -324,7 +347,12 @@ void FVoxelDependency2D::Invalidate(const FVoxelBox2D& Bounds)
 		return;
 	}
 
-	InvalidateTrackers([=, this](const FVoxelDependencyTracker& Tracker)
+	InvalidateTrackers(
+	[&](FVoxelInvalidationQueue& InvalidationQueue, const TSharedRef<const FVoxelInvalidationCallstack>& Callstack)
+	{
+		InvalidationQueue.Invalidate(DependencyRef, Bounds, Callstack);
+	},
+	[=, this](const FVoxelDependencyTracker& Tracker)
 	{
 		const int32 Index = Tracker.Dependencies_2D.Find(DependencyRef);
 		checkVoxelSlow(Index != -1);
@@ -373,7 +401,12 @@ void FVoxelDependency2D::Invalidate(const TSharedRef<const FVoxelAABBTree2D>& Tr
 		return;
 	}
 
-	InvalidateTrackers([=, this](const FVoxelDependencyTracker& Tracker)
+	InvalidateTrackers(
+	[&](FVoxelInvalidationQueue& InvalidationQueue, const TSharedRef<const FVoxelInvalidationCallstack>& Callstack)
+	{
+		InvalidationQueue.Invalidate(DependencyRef, Tree, Callstack);
+	},
+	[=, this](const FVoxelDependencyTracker& Tracker)
 	{
 		const int32 Index = Tracker.Dependencies_2D.Find(DependencyRef);
 		checkVoxelSlow(Index != -1);
@@ -408,7 +441,12 @@ void FVoxelDependency3D::Invalidate(const FVoxelBox& Bounds)
 
 	const FVoxelFastBox FastBounds(Bounds);
 
-	InvalidateTrackers([=, this](const FVoxelDependencyTracker& Tracker)
+	InvalidateTrackers(
+	[&](FVoxelInvalidationQueue& InvalidationQueue, const TSharedRef<const FVoxelInvalidationCallstack>& Callstack)
+	{
+		InvalidationQueue.Invalidate(DependencyRef, Bounds, Callstack);
+	},
+	[=, this](const FVoxelDependencyTracker& Tracker)
 	{
 		const int32 Index = Tracker.Dependencies_3D.Find(DependencyRef);
 		checkVoxelSlow(Index != -1);
@@ -431,7 +469,11 @@ void FVoxelDependency3D::Invalidate(const TConstVoxelArrayView<FVoxelBox> Bounds
 		return;
 	}
 
-	Invalidate(FVoxelAABBTree::Create(BoundsArray));
+	// Exact, the invalidated region is unchanged
+	FVoxelBoxSet BoxSet(BoundsArray);
+	BoxSet.Compact();
+
+	Invalidate(FVoxelAABBTree::Create(BoxSet.GetBoxes()));
 }
 
 void FVoxelDependency3D::Invalidate(const TSharedRef<const FVoxelAABBTree>& Tree)
@@ -461,7 +503,12 @@ void FVoxelDependency3D::Invalidate(const TSharedRef<const FVoxelAABBTree>& Tree
 		return;
 	}
 
-	InvalidateTrackers([=, this](const FVoxelDependencyTracker& Tracker)
+	InvalidateTrackers(
+	[&](FVoxelInvalidationQueue& InvalidationQueue, const TSharedRef<const FVoxelInvalidationCallstack>& Callstack)
+	{
+		InvalidationQueue.Invalidate(DependencyRef, Tree, Callstack);
+	},
+	[=, this](const FVoxelDependencyTracker& Tracker)
 	{
 		const int32 Index = Tracker.Dependencies_3D.Find(DependencyRef);
 		checkVoxelSlow(Index != -1);
@@ -1,6 +1,7 @@
 // Copyright Voxel Plugin SAS. All Rights Reserved.
 
 #include "VoxelDistanceFieldWrapper.h"
+#include "VoxelDistanceFieldWrapperImpl.ispc.generated.h"
 
 void FVoxelDistanceFieldWrapper::FMip::Initialize(const FVoxelDistanceFieldWrapper& Wrapper)
 {
@@ -12,7 +13,8 @@ void FVoxelDistanceFieldWrapper::FMip::Initialize(const FVoxelDistanceFieldWrapp
 	const FVector TexelSize = Wrapper.LocalSpaceMeshBounds.GetSize() / FVector(NumUniqueVoxels - 2);
 
 	// Add TexelSize on all sides for MeshDistanceFieldObjectBorder
-	const FBox DistanceFieldVolumeBounds = Wrapper.LocalSpaceMeshBounds.ExpandBy(TexelSize);
+	DistanceFieldVolumeBounds = Wrapper.LocalSpaceMeshBounds.ExpandBy(TexelSize);
+	VoxelSize = DistanceFieldVolumeBounds.GetSize() / FVector(NumUniqueVoxels);
 
 	const FVector VolumeSpaceDistanceFieldVoxelSize = DistanceFieldVolumeBounds.GetSize() * LocalToVolumeScale / FVector(NumUniqueVoxels);
 
@@ -20,6 +22,34 @@ void FVoxelDistanceFieldWrapper::FMip::Initialize(const FVoxelDistanceFieldWrapp
 	DistanceFieldToVolumeScaleBias = FVector2D(2.0f * MaxDistanceForEncoding, -MaxDistanceForEncoding);
 }
 
+FInt32Interval FVoxelDistanceFieldWrapper::FMip::QuantizeDistances(
+	const TConstVoxelArrayView<float> Distances,
+	const TVoxelArrayView<uint8> OutDistances) const
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Distances.Num(), 4096);
+	check(Distances.Num() == OutDistances.Num());
+	checkVoxelSlow(DistanceField::DistanceFieldFormat == PF_G8);
+
+	FInt32Interval Result;
+	ispc::VoxelDistanceFieldWrapper_QuantizeDistances(
+		Distances.GetData(),
+		OutDistances.GetData(),
+		Distances.Num(),
+		LocalToVolumeScale,
+		DistanceFieldToVolumeScaleBias.X,
+		DistanceFieldToVolumeScaleBias.Y,
+		Result.Min,
+		Result.Max);
+	return Result;
+}
+
+FBox FVoxelDistanceFieldWrapper::FMip::GetBrickBounds(const FIntVector& Position) const
+{
+	// Bricks overlap by one voxel: a brick has BrickSize voxels but only UniqueDataBrickSize are unique
+	const FVector Min = DistanceFieldVolumeBounds.Min + FVector(Position * DistanceField::UniqueDataBrickSize) * VoxelSize;
+	return FBox(Min, Min + (DistanceField::BrickSize - 1) * VoxelSize);
+}
+
 bool FVoxelDistanceFieldWrapper::FMip::IsValidPosition(const FIntVector& Position) const
 {
 	return Bricks.IsValidIndex(FVoxelUtilities::Get3DIndex<int32>(IndirectionSize, Position));
@@ -69,102 +99,205 @@ void FVoxelDistanceFieldWrapper::SetSize(const FIntVector& Mip0IndirectionSize)
 	}
 }
 
-TSharedRef<FDistanceFieldVolumeData> FVoxelDistanceFieldWrapper::Build() const
+void FVoxelDistanceFieldWrapper::BuildBricks(
+	const FGetDistanceRange GetDistanceRange,
+	const FComputeDistances ComputeDistances)
 {
 	VOXEL_FUNCTION_COUNTER();
 
-	const TSharedRef<FDistanceFieldVolumeData> OutData = MakeShared<FDistanceFieldVolumeData>();
-
-	TArray<uint8> StreamableMipData;
-
-	for (int32 MipIndex = 0; MipIndex < DistanceField::NumMips; MipIndex++)
+	struct FBrickRef
 	{
-		VOXEL_SCOPE_COUNTER("Mip");
-
-		const FMip& Mip = Mips[MipIndex];
-
-		FSparseDistanceFieldMip& OutMip = OutData->Mips[MipIndex];
-		TVoxelArray<uint32> IndirectionTable;
-		IndirectionTable.Empty(Mip.IndirectionSize.X * Mip.IndirectionSize.Y * Mip.IndirectionSize.Z);
-		IndirectionTable.AddUninitialized(Mip.IndirectionSize.X * Mip.IndirectionSize.Y * Mip.IndirectionSize.Z);
+		int32 MipIndex = 0;
+		FIntVector Position = FIntVector(ForceInit);
+		int32 BrickIndex = 0;
+	};
+	TVoxelArray<FBrickRef> BrickRefs;
+	{
+		VOXEL_SCOPE_COUNTER("Find bricks");
 
-		for (int32 i = 0; i < IndirectionTable.Num(); i++)
+		int32 NumBricks = 0;
+		for (const FMip& Mip : Mips)
 		{
-			IndirectionTable[i] = DistanceField::InvalidBrickIndex;
+			NumBricks += Mip.Bricks.Num();
 		}
+		BrickRefs.Reserve(NumBricks);
 
-		uint32 NumBricks = 0;
-		for (const TSharedPtr<FBrick>& Brick : Mip.Bricks)
+		for (int32 MipIndex = 0; MipIndex < DistanceField::NumMips; MipIndex++)
 		{
-			if (Brick)
+			const FMip& Mip = Mips[MipIndex];
+			ensure(Mip.LocalToVolumeScale > 0.f);
+
+			for (int32 Z = 0; Z < Mip.IndirectionSize.Z; Z++)
 			{
-				NumBricks++;
+				for (int32 Y = 0; Y < Mip.IndirectionSize.Y; Y++)
+				{
+					for (int32 X = 0; X < Mip.IndirectionSize.X; X++)
+					{
+						const FIntVector Position(X, Y, Z);
+						const FBox Bounds = Mip.GetBrickBounds(Position);
+						const FFloatInterval Range = GetDistanceRange(Bounds);
+
+						// Conservative: the whole brick would quantize to 255 or to 0
+						if (Range.Min >= Mip.GetMaxEncodedDistance() ||
+							Range.Max <= -Mip.GetMaxEncodedDistance())
+						{
+							continue;
+						}
+
+						BrickRefs.Add_EnsureNoGrow(FBrickRef
+						{
+							MipIndex,
+							Position,
+							FVoxelUtilities::Get3DIndex<int32>(Mip.IndirectionSize, Position)
+						});
+					}
+				}
 			}
 		}
+	}
 
-		const uint32 BrickSizeBytes = DistanceField::BrickSize * DistanceField::BrickSize * DistanceField::BrickSize * GPixelFormats[DistanceField::DistanceFieldFormat].BlockBytes;
+	constexpr int32 BrickSize = DistanceField::BrickSize;
+	constexpr int32 NumVoxels = BrickSize * BrickSize * BrickSize;
 
-		TVoxelArray<uint8> DistanceFieldBrickData;
-		DistanceFieldBrickData.Empty(BrickSizeBytes * NumBricks);
-		DistanceFieldBrickData.AddUninitialized(BrickSizeBytes * NumBricks);
+	Voxel::ParallelFor(BrickRefs, [&](const FBrickRef& BrickRef)
+	{
+		FMip& Mip = Mips[BrickRef.MipIndex];
+		const FVector Min = Mip.GetBrickBounds(BrickRef.Position).Min;
 
-		int32 BrickIndex = 0;
-		for (int32 X = 0; X < Mip.IndirectionSize.X; X++)
+		TVoxelStaticArray<FVector3f, NumVoxels> Positions{ NoInit };
 		{
-			for (int32 Y = 0; Y < Mip.IndirectionSize.X; Y++)
+			int32 Index = 0;
+			for (int32 Z = 0; Z < BrickSize; Z++)
 			{
-				for (int32 Z = 0; Z < Mip.IndirectionSize.X; Z++)
+				for (int32 Y = 0; Y < BrickSize; Y++)
 				{
-					const int32 IndirectionIndex = FVoxelUtilities::Get3DIndex<int32>(Mip.IndirectionSize, X, Y, Z);
-					const TSharedPtr<FBrick>& Brick = Mip.Bricks[IndirectionIndex];
-
-					if (!Brick)
+					for (int32 X = 0; X < BrickSize; X++)
 					{
-						IndirectionTable[IndirectionIndex] = DistanceField::InvalidBrickIndex;
-						continue;
+						Positions[Index++] = FVector3f(Min + FVector(X, Y, Z) * Mip.VoxelSize);
 					}
-
-					IndirectionTable[IndirectionIndex] = BrickIndex;
-					FMemory::Memcpy(&DistanceFieldBrickData[BrickIndex * BrickSizeBytes], Brick->GetData(), Brick->Num() * Brick->GetTypeSize());
-
-					BrickIndex++;
 				}
 			}
 		}
-		check(BrickIndex == NumBricks);
 
-		const int32 IndirectionTableBytes = IndirectionTable.Num() * IndirectionTable.GetTypeSize();
-		const int32 MipDataBytes = IndirectionTableBytes + DistanceFieldBrickData.Num();
+		TVoxelStaticArray<float, NumVoxels> Distances{ NoInit };
+		ComputeDistances(Positions, Distances);
 
-		if (MipIndex == DistanceField::NumMips - 1)
+		const TSharedRef<FBrick> Brick = MakeShared<FBrick>(NoInit);
+		const FInt32Interval Range = Mip.QuantizeDistances(Distances, *Brick);
+
+		if (Range.Min == 255 ||
+			Range.Max == 0)
 		{
-			VOXEL_SCOPE_COUNTER("Copy");
+			// Uniformly far or fully inside
+			return;
+		}
+
+		// Each brick has its own slot, no need to lock
+		TSharedPtr<FBrick>& Ptr = Mip.Bricks[BrickRef.BrickIndex];
+		ensure(!Ptr);
+		Ptr = Brick;
+	});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+TSharedRef<FDistanceFieldVolumeData> FVoxelDistanceFieldWrapper::Build() const
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	const TSharedRef<FDistanceFieldVolumeData> OutData = MakeShared<FDistanceFieldVolumeData>();
+
+	constexpr uint32 BrickSizeBytes = DistanceField::BrickSize * DistanceField::BrickSize * DistanceField::BrickSize * sizeof(uint8);
+	checkVoxelSlow(GPixelFormats[DistanceField::DistanceFieldFormat].BlockBytes == sizeof(uint8));
 
-			OutData->AlwaysLoadedMip.Empty(MipDataBytes);
-			OutData->AlwaysLoadedMip.AddUninitialized(MipDataBytes);
+	TVoxelStaticArray<int32, DistanceField::NumMips> MipToNumBricks{ NoInit };
+	TVoxelStaticArray<int64, DistanceField::NumMips> MipToDataBytes{ NoInit };
+	TVoxelStaticArray<int64, DistanceField::NumMips> MipToOffset{ NoInit };
 
-			FPlatformMemory::Memcpy(&OutData->AlwaysLoadedMip[0], IndirectionTable.GetData(), IndirectionTableBytes);
+	int64 NumStreamableBytes = 0;
+	for (int32 MipIndex = 0; MipIndex < DistanceField::NumMips; MipIndex++)
+	{
+		const FMip& Mip = Mips[MipIndex];
 
-			if (DistanceFieldBrickData.Num() > 0)
+		int32 NumBricks = 0;
+		for (const TSharedPtr<FBrick>& Brick : Mip.Bricks)
+		{
+			if (Brick)
 			{
-				FPlatformMemory::Memcpy(&OutData->AlwaysLoadedMip[IndirectionTableBytes], DistanceFieldBrickData.GetData(), DistanceFieldBrickData.Num());
+				NumBricks++;
 			}
 		}
+
+		MipToNumBricks[MipIndex] = NumBricks;
+		MipToDataBytes[MipIndex] = Mip.Bricks.Num() * sizeof(uint32) + int64(NumBricks) * BrickSizeBytes;
+
+		if (MipIndex == DistanceField::NumMips - 1)
+		{
+			MipToOffset[MipIndex] = 0;
+		}
 		else
 		{
-			VOXEL_SCOPE_COUNTER("Copy");
+			MipToOffset[MipIndex] = NumStreamableBytes;
+			NumStreamableBytes += MipToDataBytes[MipIndex];
+		}
+	}
 
-			OutMip.BulkOffset = StreamableMipData.Num();
-			StreamableMipData.AddUninitialized(MipDataBytes);
-			OutMip.BulkSize = StreamableMipData.Num() - OutMip.BulkOffset;
-			check(OutMip.BulkSize > 0);
+	// Write the mips straight into their final storage
+	OutData->AlwaysLoadedMip.SetNumUninitialized(int32(MipToDataBytes[DistanceField::NumMips - 1]));
+
+	OutData->StreamableMips.Lock(LOCK_READ_WRITE);
+	uint8* StreamableData = static_cast<uint8*>(OutData->StreamableMips.Realloc(NumStreamableBytes));
+
+	for (int32 MipIndex = 0; MipIndex < DistanceField::NumMips; MipIndex++)
+	{
+		VOXEL_SCOPE_COUNTER("Mip");
 
-			FPlatformMemory::Memcpy(&StreamableMipData[OutMip.BulkOffset], IndirectionTable.GetData(), IndirectionTableBytes);
+		const FMip& Mip = Mips[MipIndex];
+		const int32 NumBricks = MipToNumBricks[MipIndex];
+
+		uint8* MipData =
+			MipIndex == DistanceField::NumMips - 1
+			? OutData->AlwaysLoadedMip.GetData()
+			: StreamableData + MipToOffset[MipIndex];
+
+		const TVoxelArrayView<uint32> IndirectionTable(reinterpret_cast<uint32*>(MipData), Mip.Bricks.Num());
+		uint8* BrickData = MipData + IndirectionTable.Num() * sizeof(uint32);
 
-			if (DistanceFieldBrickData.Num() > 0)
+		// Bricks are stored in indirection order
+		TVoxelArray<int32> BrickIndexToIndirectionIndex;
+		FVoxelUtilities::SetNumFast(BrickIndexToIndirectionIndex, NumBricks);
+		{
+			int32 BrickIndex = 0;
+			for (int32 IndirectionIndex = 0; IndirectionIndex < IndirectionTable.Num(); IndirectionIndex++)
 			{
-				FPlatformMemory::Memcpy(&StreamableMipData[OutMip.BulkOffset + IndirectionTableBytes], DistanceFieldBrickData.GetData(), DistanceFieldBrickData.Num());
+				if (!Mip.Bricks[IndirectionIndex])
+				{
+					IndirectionTable[IndirectionIndex] = DistanceField::InvalidBrickIndex;
+					continue;
+				}
+
+				IndirectionTable[IndirectionIndex] = BrickIndex;
+				BrickIndexToIndirectionIndex[BrickIndex] = IndirectionIndex;
+				BrickIndex++;
 			}
+			check(BrickIndex == NumBricks);
+		}
+
+		Voxel::ParallelFor(BrickIndexToIndirectionIndex, [&](const int32 IndirectionIndex, const int32 BrickIndex)
+		{
+			const FBrick& Brick = *Mip.Bricks[IndirectionIndex];
+			FMemory::Memcpy(BrickData + int64(BrickIndex) * BrickSizeBytes, Brick.GetData(), BrickSizeBytes);
+		});
+
+		FSparseDistanceFieldMip& OutMip = OutData->Mips[MipIndex];
+
+		if (MipIndex != DistanceField::NumMips - 1)
+		{
+			OutMip.BulkOffset = MipToOffset[MipIndex];
+			OutMip.BulkSize = MipToDataBytes[MipIndex];
+			check(OutMip.BulkSize > 0);
 
 			// HACK: set BulkSize to 0 so no read request is ever emitted as they crash in packaged
 			OutMip.BulkSize = 0;
@@ -183,15 +316,11 @@ TSharedRef<FDistanceFieldVolumeData> FVoxelDistanceFieldWrapper::Build() const
 		OutMip.VolumeToVirtualUVAdd = FVector3f(VirtualUVSize / 2.f + VirtualUVMin);
 	}
 
-	OutData->LocalSpaceMeshBounds = FBox3f(LocalSpaceMeshBounds);
-	OutData->bMostlyTwoSided = true;
-
-	VOXEL_SCOPE_COUNTER("Final copy");
-	OutData->StreamableMips.Lock(LOCK_READ_WRITE);
-	uint8* Ptr = static_cast<uint8*>(OutData->StreamableMips.Realloc(StreamableMipData.Num()));
-	FMemory::Memcpy(Ptr, StreamableMipData.GetData(), StreamableMipData.Num());
 	OutData->StreamableMips.Unlock();
 	OutData->StreamableMips.SetBulkDataFlags(BULKDATA_Force_NOT_InlinePayload);
 
+	OutData->LocalSpaceMeshBounds = FBox3f(LocalSpaceMeshBounds);
+	OutData->bMostlyTwoSided = true;
+
 	return OutData;
-}
\ No newline at end of file
+}
@@ -3,6 +3,11 @@
 #include "VoxelHeightmapImporter.h"
 #include "IImageWrapper.h"
 #include "IImageWrapperModule.h"
+#include "HAL/PlatformFileManager.h"
+
+THIRD_PARTY_INCLUDES_START
+#include "png.h"
+THIRD_PARTY_INCLUDES_END
 
 TSharedPtr<FVoxelHeightmapImporter> FVoxelHeightmapImporter::MakeImporter(const FString& Path)
 {
@@ -43,6 +48,73 @@ bool FVoxelHeightmapImporter::Import(const FString& Path, FString& OutError, FIn
 	return true;
 }
 
+bool FVoxelHeightmapImporter::ImportTilesImpl(
+	const int32 TileSize,
+	const FReadRows ReadRows,
+	const FOnTile& OnTile) const
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	if (!ensure(TileSize > 0) ||
+		!ensure(BitDepth == 8 || BitDepth == 16))
+	{
+		return false;
+	}
+
+	const int32 BytesPerPixel = BitDepth / 8;
+	const int64 RowSize = int64(Size.X) * BytesPerPixel;
+
+	// Double buffered: we read a band while the tiles of the previous one are emitted
+	TVoxelStaticArray<TVoxelArray64<uint8>, 2> Bands;
+	FVoxelParallelTaskScope Scope;
+
+	for (int32 BandIndex = 0; BandIndex * int64(TileSize) < Size.Y; BandIndex++)
+	{
+		const int32 StartY = BandIndex * TileSize;
+		const int32 NumRows = FMath::Min(TileSize, Size.Y - StartY);
+
+		// Tasks using this band were flushed in the previous iteration
+		TVoxelArray64<uint8>& Band = Bands[BandIndex % 2];
+		FVoxelUtilities::SetNumFast(Band, NumRows * RowSize);
+
+		{
+			VOXEL_SCOPE_COUNTER_FORMAT("ReadRows %d-%d", StartY, StartY + NumRows);
+
+			if (!ReadRows(StartY, NumRows, Band))
+			{
+				return false;
+			}
+		}
+
+		Scope.FlushTasks();
+
+		for (int32 StartX = 0; StartX < Size.X; StartX += TileSize)
+		{
+			Scope.AddTask([&OnTile, BandView = TConstVoxelArrayView64<uint8>(Band), RowSize, BytesPerPixel, TileSize, StartX, StartY, NumRows, SizeX = Size.X]
+			{
+				const FIntPoint TileSize2D(FMath::Min(TileSize, SizeX - StartX), NumRows);
+				VOXEL_SCOPE_COUNTER_FORMAT("FVoxelHeightmapImporter Tile %dx%d", TileSize2D.X, TileSize2D.Y);
+
+				const int64 TileRowSize = int64(TileSize2D.X) * BytesPerPixel;
+
+				TVoxelArray64<uint8> TileData;
+				FVoxelUtilities::SetNumFast(TileData, TileRowSize * TileSize2D.Y);
+
+				for (int32 Y = 0; Y < TileSize2D.Y; Y++)
+				{
+					FVoxelUtilities::Memcpy(
+						MakeVoxelArrayView(TileData).Slice(Y * TileRowSize, TileRowSize),
+						BandView.Slice(Y * RowSize + StartX * BytesPerPixel, TileRowSize));
+				}
+
+				OnTile(FIntPoint(StartX, StartY), TileSize2D, TileData);
+			});
+		}
+	}
+
+	return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -98,6 +170,145 @@ bool FVoxelHeightmapImporter_PNG::Import()
 	return true;
 }
 
+namespace Voxel::PNG
+{
+	struct FContext
+	{
+		IFileHandle* FileHandle = nullptr;
+		FString Error;
+	};
+
+	void OnError(const png_structp PNG, const png_const_charp Message)
+	{
+		static_cast<FContext*>(png_get_error_ptr(PNG))->Error = UTF8_TO_TCHAR(Message);
+		png_longjmp(PNG, 1);
+	}
+	void OnWarning(const png_structp PNG, const png_const_charp Message)
+	{
+		LOG_VOXEL(Verbose, "libpng: %s", UTF8_TO_TCHAR(Message));
+	}
+	void OnRead(const png_structp PNG, const png_bytep Data, const png_size_t Length)
+	{
+		FContext& Context = *static_cast<FContext*>(png_get_io_ptr(PNG));
+		if (!Context.FileHandle->Read(Data, Length))
+		{
+			png_error(PNG, "Failed to read file");
+		}
+	}
+
+	// libpng reports errors with longjmp: these must not have any object with a destructor on the stack
+
+	bool TryReadInfo(const png_structp PNG, const png_infop Info)
+	{
+		if (setjmp(png_jmpbuf(PNG)))
+		{
+			return false;
+		}
+
+		png_read_info(PNG, Info);
+
+		if (png_get_bit_depth(PNG, Info) == 16 &&
+			PLATFORM_LITTLE_ENDIAN)
+		{
+			png_set_swap(PNG);
+		}
+		png_read_update_info(PNG, Info);
+		return true;
+	}
+	bool TryReadRows(const png_structp PNG, uint8* Data, const int32 NumRows, const int64 RowSize)
+	{
+		if (setjmp(png_jmpbuf(PNG)))
+		{
+			return false;
+		}
+
+		for (int32 Row = 0; Row < NumRows; Row++)
+		{
+			png_read_row(PNG, Data + Row * RowSize, nullptr);
+		}
+		return true;
+	}
+}
+
+bool FVoxelHeightmapImporter_PNG::ImportTiles(const int32 TileSize, const FOnTile& OnTile)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	const TUniquePtr<IFileHandle> FileHandle(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*Path));
+	if (!FileHandle)
+	{
+		Error = "Failed to load " + Path;
+		return false;
+	}
+
+	Voxel::PNG::FContext Context;
+	Context.FileHandle = FileHandle.Get();
+
+	png_structp PNG = png_create_read_struct(PNG_LIBPNG_VER_STRING, &Context, Voxel::PNG::OnError, Voxel::PNG::OnWarning);
+	if (!ensure(PNG))
+	{
+		return false;
+	}
+
+	png_infop Info = png_create_info_struct(PNG);
+	ON_SCOPE_EXIT
+	{
+		png_destroy_read_struct(&PNG, Info ? &Info : nullptr, nullptr);
+	};
+
+	if (!ensure(Info))
+	{
+		return false;
+	}
+
+	png_set_read_fn(PNG, &Context, Voxel::PNG::OnRead);
+
+	if (!Voxel::PNG::TryReadInfo(PNG, Info))
+	{
+		Error = "Failed to decode " + Path + " as a png: " + Context.Error;
+		return false;
+	}
+
+	if (png_get_color_type(PNG, Info) != PNG_COLOR_TYPE_GRAY)
+	{
+		Error = Path + " needs to be a grayscale png";
+		return false;
+	}
+
+	if (png_get_bit_depth(PNG, Info) != 8 &&
+		png_get_bit_depth(PNG, Info) != 16)
+	{
+		Error = Path + " needs to be an 8 bit or 16 bit png";
+		return false;
+	}
+
+	if (png_get_interlace_type(PNG, Info) != PNG_INTERLACE_NONE)
+	{
+		Error = Path + ": interlaced pngs cannot be streamed, use Import instead";
+		return false;
+	}
+
+	Size.X = png_get_image_width(PNG, Info);
+	Size.Y = png_get_image_height(PNG, Info);
+	BitDepth = png_get_bit_depth(PNG, Info);
+
+	const int64 RowSize = int64(Size.X) * (BitDepth / 8);
+	if (!ensure(int64(png_get_rowbytes(PNG, Info)) == RowSize))
+	{
+		return false;
+	}
+
+	return ImportTilesImpl(TileSize, [&](const int32 StartY, const int32 NumRows, const TVoxelArrayView64<uint8> OutData)
+	{
+		if (!Voxel::PNG::TryReadRows(PNG, OutData.GetData(), NumRows, RowSize))
+		{
+			Error = Path + ": failed to decompress png data: " + Context.Error;
+			return false;
+		}
+		return true;
+	}, OnTile);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -113,15 +324,59 @@ bool FVoxelHeightmapImporter_Raw::Import()
 		return false;
 	}
 
-	if (RawData.Num() % 2 != 0)
+	if (!SetSizeFromFileSize(RawData.Num()))
+	{
+		return false;
+	}
+
+	Data = RawData;
+
+	return true;
+}
+
+bool FVoxelHeightmapImporter_Raw::ImportTiles(const int32 TileSize, const FOnTile& OnTile)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	const TUniquePtr<IFileHandle> FileHandle(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*Path));
+	if (!FileHandle)
+	{
+		Error = "Failed to load " + Path;
+		return false;
+	}
+
+	if (!SetSizeFromFileSize(FileHandle->Size()))
+	{
+		return false;
+	}
+
+	const int64 RowSize = int64(Size.X) * 2;
+
+	return ImportTilesImpl(TileSize, [&](const int32 StartY, const int32 NumRows, const TVoxelArrayView64<uint8> OutData)
+	{
+		checkVoxelSlow(OutData.Num() == NumRows * RowSize);
+
+		if (!FileHandle->Seek(StartY * RowSize) ||
+			!FileHandle->Read(OutData.GetData(), OutData.Num()))
+		{
+			Error = "Failed to read " + Path;
+			return false;
+		}
+		return true;
+	}, OnTile);
+}
+
+bool FVoxelHeightmapImporter_Raw::SetSizeFromFileSize(const int64 FileSize)
+{
+	if (FileSize % 2 != 0)
 	{
 		Error = "Invalid file size " + Path + ": possibly not 16 bit?";
 		return false;
 	}
 
-	const int64 NumPixels = RawData.Num() / 2;
+	const int64 NumPixels = FileSize / 2;
 	const int32 SquareSize = FMath::TruncToInt(FMath::Sqrt(double(NumPixels)));
-	if (NumPixels != SquareSize * SquareSize)
+	if (NumPixels != int64(SquareSize) * SquareSize)
 	{
 		Error = "Invalid file size " + Path + ": is it a 16 bit raw with the same height and width?";
 		return false;
@@ -130,7 +385,6 @@ bool FVoxelHeightmapImporter_Raw::Import()
 	Size.X = SquareSize;
 	Size.Y = SquareSize;
 	BitDepth = 16;
-	Data = RawData;
 
 	return true;
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include "VoxelInvalidationQueue.h"
 #include "VoxelDependencyManager.h"
 #include "VoxelInvalidationCallstack.h"
+#include "VoxelAABBTree.h"
+#include "VoxelAABBTree2D.h"
 
 DEFINE_VOXEL_INSTANCE_COUNTER(FVoxelInvalidationQueue);
 
@@ -30,15 +32,410 @@ TSharedPtr<const FVoxelInvalidationCallstack> FVoxelInvalidationQueue::FindInval
 	VOXEL_FUNCTION_COUNTER();
 	VOXEL_SCOPE_READ_LOCK(CriticalSection);
 
-	for (const FInvalidation& Invalidation : Invalidations_RequiresLock)
+	const auto MakeCallstack = [](const TSharedRef<const FVoxelInvalidationCallstack>& InvalidationCallstack)
 	{
-		if (Invalidation.ShouldInvalidate(Tracker))
+		TSharedRef<FVoxelInvalidationCallstack> Callstack = FVoxelInvalidationCallstack::Create("Invalidation Queue");
+		Callstack->AddCaller(InvalidationCallstack);
+		return Callstack;
+	};
+
+	if (DependencyToCallstack_RequiresLock.Num() > 0)
+	{
+		for (const FVoxelDependencyRef& DependencyRef : Tracker.Dependencies)
+		{
+			if (const TSharedRef<const FVoxelInvalidationCallstack>* Callstack = DependencyToCallstack_RequiresLock.Find(DependencyRef))
+			{
+				return MakeCallstack(*Callstack);
+			}
+		}
+	}
+
+	if (Dependency2DToInvalidation_RequiresLock.Num() > 0)
+	{
+		for (int32 Index = 0; Index < Tracker.Dependencies_2D.Num(); Index++)
+		{
+			const FInvalidation2D* Invalidation = Dependency2DToInvalidation_RequiresLock.Find(Tracker.Dependencies_2D[Index]);
+			if (Invalidation &&
+				Invalidation->Intersects(Tracker.Bounds_2D[Index]))
+			{
+				return MakeCallstack(Invalidation->Callstack.ToSharedRef());
+			}
+		}
+	}
+
+	if (Dependency3DToInvalidation_RequiresLock.Num() > 0)
+	{
+		for (int32 Index = 0; Index < Tracker.Dependencies_3D.Num(); Index++)
 		{
-			TSharedRef<FVoxelInvalidationCallstack> Callstack = FVoxelInvalidationCallstack::Create("Invalidation Queue");
-			Callstack->AddCaller(Invalidation.Callstack);
-			return Callstack;
+			const FInvalidation3D* Invalidation = Dependency3DToInvalidation_RequiresLock.Find(Tracker.Dependencies_3D[Index]);
+			if (Invalidation &&
+				Invalidation->Intersects(Tracker.Bounds_3D[Index]))
+			{
+				return MakeCallstack(Invalidation->Callstack.ToSharedRef());
+			}
 		}
 	}
 
 	return {};
-}
\ No newline at end of file
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelInvalidationQueue::Invalidate(
+	const FVoxelDependencyRef DependencyRef,
+	const TSharedRef<const FVoxelInvalidationCallstack>& Callstack)
+{
+	VOXEL_SCOPE_WRITE_LOCK(CriticalSection);
+
+	// Keep the first callstack, later invalidations of the same dependency are redundant
+	if (!DependencyToCallstack_RequiresLock.Contains(DependencyRef))
+	{
+		DependencyToCallstack_RequiresLock.Add_CheckNew(DependencyRef, Callstack);
+	}
+}
+
+void FVoxelInvalidationQueue::Invalidate(
+	const FVoxelDependencyRef DependencyRef,
+	const FVoxelBox2D& Bounds,
+	const TSharedRef<const FVoxelInvalidationCallstack>& Callstack)
+{
+	VOXEL_SCOPE_WRITE_LOCK(CriticalSection);
+
+	FInvalidation2D& Invalidation = Dependency2DToInvalidation_RequiresLock.FindOrAdd(DependencyRef);
+	if (!Invalidation.Callstack)
+	{
+		Invalidation.Callstack = Callstack;
+	}
+	Invalidation.Add(Bounds);
+}
+
+void FVoxelInvalidationQueue::Invalidate(
+	const FVoxelDependencyRef DependencyRef,
+	const TSharedRef<const FVoxelAABBTree2D>& Tree,
+	const TSharedRef<const FVoxelInvalidationCallstack>& Callstack)
+{
+	VOXEL_SCOPE_WRITE_LOCK(CriticalSection);
+
+	FInvalidation2D& Invalidation = Dependency2DToInvalidation_RequiresLock.FindOrAdd(DependencyRef);
+	if (!Invalidation.Callstack)
+	{
+		Invalidation.Callstack = Callstack;
+	}
+	Invalidation.Add(Tree);
+}
+
+void FVoxelInvalidationQueue::Invalidate(
+	const FVoxelDependencyRef DependencyRef,
+	const FVoxelBox& Bounds,
+	const TSharedRef<const FVoxelInvalidationCallstack>& Callstack)
+{
+	VOXEL_SCOPE_WRITE_LOCK(CriticalSection);
+
+	FInvalidation3D& Invalidation = Dependency3DToInvalidation_RequiresLock.FindOrAdd(DependencyRef);
+	if (!Invalidation.Callstack)
+	{
+		Invalidation.Callstack = Callstack;
+	}
+	Invalidation.Add(Bounds);
+}
+
+void FVoxelInvalidationQueue::Invalidate(
+	const FVoxelDependencyRef DependencyRef,
+	const TSharedRef<const FVoxelAABBTree>& Tree,
+	const TSharedRef<const FVoxelInvalidationCallstack>& Callstack)
+{
+	VOXEL_SCOPE_WRITE_LOCK(CriticalSection);
+
+	FInvalidation3D& Invalidation = Dependency3DToInvalidation_RequiresLock.FindOrAdd(DependencyRef);
+	if (!Invalidation.Callstack)
+	{
+		Invalidation.Callstack = Callstack;
+	}
+	Invalidation.Add(Tree);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelInvalidationQueue::FInvalidation2D::Add(const FVoxelBox2D& NewBounds)
+{
+	if (Contains(NewBounds))
+	{
+		return;
+	}
+
+	Bounds = Bounds.UnionWith(NewBounds);
+	Boxes.Add(NewBounds);
+
+	if (Boxes.Num() <= MaxBoxesPerDependency)
+	{
+		return;
+	}
+
+	TSharedPtr<const FVoxelAABBTree2D> Tree;
+	{
+		VOXEL_SCOPE_COUNTER("Build tree");
+		Tree = FVoxelAABBTree2D::Create(Boxes);
+	}
+	Boxes.Reset();
+
+	AddTree(Tree.ToSharedRef());
+}
+
+void FVoxelInvalidationQueue::FInvalidation2D::Add(const TSharedRef<const FVoxelAABBTree2D>& Tree)
+{
+	Bounds = Bounds.UnionWith(Tree->GetBounds());
+	AddTree(Tree);
+}
+
+void FVoxelInvalidationQueue::FInvalidation2D::AddTree(const TSharedRef<const FVoxelAABBTree2D>& Tree)
+{
+	const auto GetNum = [](const FVoxelAABBTree2D& OtherTree)
+	{
+		int32 Num = 0;
+		for (const FVoxelAABBTree2D::FLeaf& Leaf : OtherTree.GetLeaves())
+		{
+			Num += Leaf.Elements.Num();
+		}
+		return Num;
+	};
+
+	Trees.Add(Tree);
+	TreeNums.Add(GetNum(*Tree));
+
+	// Merge trees of similar size, see MaxTreesPerDependency
+	while (
+		Trees.Num() >= 2 &&
+		(Trees.Num() > MaxTreesPerDependency || 2 * TreeNums.Last() >= TreeNums.Last(1)))
+	{
+		VOXEL_SCOPE_COUNTER("Merge trees");
+
+		TVoxelChunkedArray<FVoxelBox2D> AllBounds;
+		for (int32 Index = Trees.Num() - 2; Index < Trees.Num(); Index++)
+		{
+			for (const FVoxelAABBTree2D::FLeaf& Leaf : Trees[Index]->GetLeaves())
+			{
+				for (const FVoxelAABBTree2D::FElement& Element : Leaf.Elements)
+				{
+					AllBounds.Add(Element.Bounds);
+				}
+			}
+		}
+
+		Trees.Pop();
+		TreeNums.Pop();
+		Trees.Last() = FVoxelAABBTree2D::Create(AllBounds);
+		TreeNums.Last() = AllBounds.Num();
+	}
+}
+
+bool FVoxelInvalidationQueue::FInvalidation2D::Contains(const FVoxelBox2D& OtherBounds) const
+{
+	if (!Bounds.Contains(OtherBounds))
+	{
+		return false;
+	}
+
+	for (const FVoxelBox2D& Box : Boxes)
+	{
+		if (Box.Contains(OtherBounds))
+		{
+			return true;
+		}
+	}
+
+	for (const TSharedRef<const FVoxelAABBTree2D>& Tree : Trees)
+	{
+		bool bContained = false;
+		Tree->Traverse(
+			[&](const FVoxelBox2D& NodeBounds)
+			{
+				return
+					!bContained &&
+					NodeBounds.Contains(OtherBounds);
+			},
+			[&](int32)
+			{
+				bContained = true;
+			});
+
+		if (bContained)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool FVoxelInvalidationQueue::FInvalidation2D::Intersects(const FVoxelBox2D& OtherBounds) const
+{
+	if (!Bounds.Intersects(OtherBounds))
+	{
+		return false;
+	}
+
+	for (const FVoxelBox2D& Box : Boxes)
+	{
+		if (Box.Intersects(OtherBounds))
+		{
+			return true;
+		}
+	}
+
+	for (const TSharedRef<const FVoxelAABBTree2D>& Tree : Trees)
+	{
+		if (Tree->Intersects(OtherBounds))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelInvalidationQueue::FInvalidation3D::Add(const FVoxelBox& NewBounds)
+{
+	if (Contains(NewBounds))
+	{
+		return;
+	}
+
+	const FVoxelFastBox FastBounds(NewBounds);
+	Bounds = Boxes.Num() == 0 && Trees.Num() == 0 ? FastBounds : Bounds.UnionWith(FastBounds);
+	Boxes.Add(FastBounds);
+
+	if (Boxes.Num() <= MaxBoxesPerDependency)
+	{
+		return;
+	}
+
+	TSharedPtr<const FVoxelAABBTree> Tree;
+	{
+		VOXEL_SCOPE_COUNTER("Build tree");
+
+		TVoxelArray<FVoxelBox> AllBounds;
+		AllBounds.Reserve(Boxes.Num());
+		for (const FVoxelFastBox& Box : Boxes)
+		{
+			AllBounds.Add(Box.GetBox());
+		}
+
+		Tree = FVoxelAABBTree::Create(AllBounds);
+	}
+	Boxes.Reset();
+
+	AddTree(Tree.ToSharedRef());
+}
+
+void FVoxelInvalidationQueue::FInvalidation3D::Add(const TSharedRef<const FVoxelAABBTree>& Tree)
+{
+	Bounds = Boxes.Num() == 0 && Trees.Num() == 0 ? Tree->GetBounds() : Bounds.UnionWith(Tree->GetBounds());
+	AddTree(Tree);
+}
+
+void FVoxelInvalidationQueue::FInvalidation3D::AddTree(const TSharedRef<const FVoxelAABBTree>& Tree)
+{
+	Trees.Add(Tree);
+
+	// Merge trees of similar size, see MaxTreesPerDependency
+	while (
+		Trees.Num() >= 2 &&
+		(Trees.Num() > MaxTreesPerDependency || 2 * Trees.Last()->Num() >= Trees.Last(1)->Num()))
+	{
+		VOXEL_SCOPE_COUNTER("Merge trees");
+
+		TVoxelArray<FVoxelBox> AllBounds;
+		AllBounds.Reserve(Trees.Last()->Num() + Trees.Last(1)->Num());
+
+		for (int32 Index = Trees.Num() - 2; Index < Trees.Num(); Index++)
+		{
+			const FVoxelAABBTree& OtherTree = *Trees[Index];
+			for (int32 ElementIndex = 0; ElementIndex < OtherTree.Num(); ElementIndex++)
+			{
+				AllBounds.Add(OtherTree.GetBounds(ElementIndex).GetBox());
+			}
+		}
+
+		Trees.Pop();
+		Trees.Last() = FVoxelAABBTree::Create(AllBounds);
+	}
+}
+
+bool FVoxelInvalidationQueue::FInvalidation3D::Contains(const FVoxelBox& OtherBounds) const
+{
+	if (Boxes.Num() == 0 &&
+		Trees.Num() == 0)
+	{
+		return false;
+	}
+
+	if (!Bounds.GetBox().Contains(OtherBounds))
+	{
+		return false;
+	}
+
+	for (const FVoxelFastBox& Box : Boxes)
+	{
+		if (Box.GetBox().Contains(OtherBounds))
+		{
+			return true;
+		}
+	}
+
+	for (const TSharedRef<const FVoxelAABBTree>& Tree : Trees)
+	{
+		bool bContained = false;
+		Tree->Traverse(
+			[&](const FVoxelFastBox& NodeBounds)
+			{
+				return
+					!bContained &&
+					NodeBounds.GetBox().Contains(OtherBounds);
+			},
+			[&](int32)
+			{
+				bContained = true;
+			});
+
+		if (bContained)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool FVoxelInvalidationQueue::FInvalidation3D::Intersects(const FVoxelFastBox& OtherBounds) const
+{
+	if (!Bounds.Intersects(OtherBounds))
+	{
+		return false;
+	}
+
+	for (const FVoxelFastBox& Box : Boxes)
+	{
+		if (Box.Intersects(OtherBounds))
+		{
+			return true;
+		}
+	}
+
+	for (const TSharedRef<const FVoxelAABBTree>& Tree : Trees)
+	{
+		if (Tree->Intersects(OtherBounds))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
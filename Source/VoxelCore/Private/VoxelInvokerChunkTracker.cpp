@@ -0,0 +1,370 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelInvokerChunkTracker.h"
+
+namespace Voxel::InvokerChunkTracker
+{
+	// Same rasterization as FVoxelUtilities::ComputeInvokerChunks
+	// Offset due to chunk position being the chunk lower corner
+	constexpr double ChunkOffset = 0.5;
+	// Chunks are tested against the invoker radius offset by the chunk half diagonal
+	constexpr double ChunkHalfDiagonal = UE_SQRT_3 / 2.;
+
+	// Chunks of an invoker, as one span of Z per XY column
+	struct FShape
+	{
+		FVector Center = FVector(ForceInit);
+		FIntVector Min = FIntVector(0);
+		FIntVector Max = FIntVector(-1);
+		double RadiusSquared = 0;
+
+		FShape() = default;
+		explicit FShape(const FSphere& ChunkSphere)
+			: Center(ChunkSphere.Center)
+			, Min(FVoxelUtilities::FloorToInt(ChunkSphere.Center - ChunkSphere.W - ChunkOffset))
+			, Max(FVoxelUtilities::CeilToInt(ChunkSphere.Center + ChunkSphere.W - ChunkOffset))
+			, RadiusSquared(FMath::Square(ChunkSphere.W + ChunkHalfDiagonal))
+		{
+		}
+
+		FORCEINLINE bool IsEmpty() const
+		{
+			return
+				Min.X > Max.X ||
+				Min.Y > Max.Y ||
+				Min.Z > Max.Z;
+		}
+
+		// Inclusive, empty if OutMinZ > OutMaxZ
+		FORCEINLINE void GetSpan(
+			const int32 X,
+			const int32 Y,
+			int32& OutMinZ,
+			int32& OutMaxZ) const
+		{
+			OutMinZ = 0;
+			OutMaxZ = -1;
+
+			if (X < Min.X || X > Max.X ||
+				Y < Min.Y || Y > Max.Y)
+			{
+				return;
+			}
+
+			const double Remaining =
+				RadiusSquared -
+				FMath::Square(X + ChunkOffset - Center.X) -
+				FMath::Square(Y + ChunkOffset - Center.Y);
+
+			if (Remaining < 0)
+			{
+				return;
+			}
+
+			const double Extent = FMath::Sqrt(Remaining);
+			OutMinZ = FMath::Max(Min.Z, FMath::CeilToInt32(Center.Z - ChunkOffset - Extent));
+			OutMaxZ = FMath::Min(Max.Z, FMath::FloorToInt32(Center.Z - ChunkOffset + Extent));
+		}
+	};
+
+	// Add the chunks of [MinA, MaxA] not in [MinB, MaxB]
+	FORCEINLINE void AddSpanDifference(
+		const int32 X,
+		const int32 Y,
+		const int32 MinA,
+		const int32 MaxA,
+		const int32 MinB,
+		const int32 MaxB,
+		TVoxelArray<FIntVector>& OutChunks)
+	{
+		if (MinB > MaxB)
+		{
+			for (int32 Z = MinA; Z <= MaxA; Z++)
+			{
+				OutChunks.Add(FIntVector(X, Y, Z));
+			}
+			return;
+		}
+
+		for (int32 Z = MinA; Z <= FMath::Min(MaxA, MinB - 1); Z++)
+		{
+			OutChunks.Add(FIntVector(X, Y, Z));
+		}
+		for (int32 Z = FMath::Max(MinA, MaxB + 1); Z <= MaxA; Z++)
+		{
+			OutChunks.Add(FIntVector(X, Y, Z));
+		}
+	}
+
+	// Only columns whose span changed are visited
+	void RasterizeDifference(
+		const FShape& OldShape,
+		const FShape& NewShape,
+		TVoxelArray<FIntVector>& OutAddedChunks,
+		TVoxelArray<FIntVector>& OutRemovedChunks)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		FIntVector Min;
+		FIntVector Max;
+		if (OldShape.IsEmpty())
+		{
+			if (NewShape.IsEmpty())
+			{
+				return;
+			}
+
+			Min = NewShape.Min;
+			Max = NewShape.Max;
+		}
+		else if (NewShape.IsEmpty())
+		{
+			Min = OldShape.Min;
+			Max = OldShape.Max;
+		}
+		else
+		{
+			Min = FVoxelUtilities::ComponentMin(OldShape.Min, NewShape.Min);
+			Max = FVoxelUtilities::ComponentMax(OldShape.Max, NewShape.Max);
+		}
+
+		for (int32 X = Min.X; X <= Max.X; X++)
+		{
+			for (int32 Y = Min.Y; Y <= Max.Y; Y++)
+			{
+				int32 OldMinZ;
+				int32 OldMaxZ;
+				OldShape.GetSpan(X, Y, OldMinZ, OldMaxZ);
+
+				int32 NewMinZ;
+				int32 NewMaxZ;
+				NewShape.GetSpan(X, Y, NewMinZ, NewMaxZ);
+
+				if (OldMinZ == NewMinZ &&
+					OldMaxZ == NewMaxZ)
+				{
+					continue;
+				}
+
+				AddSpanDifference(X, Y, NewMinZ, NewMaxZ, OldMinZ, OldMaxZ, OutAddedChunks);
+				AddSpanDifference(X, Y, OldMinZ, OldMaxZ, NewMinZ, NewMaxZ, OutRemovedChunks);
+			}
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelInvokerChunkTracker::FVoxelInvokerChunkTracker(
+	const FTransform& LocalToWorld,
+	const double ChunkSize,
+	const int32 MaxNumChunks)
+	: WorldToLocal(LocalToWorld.ToInverseMatrixWithScale())
+	, WorldToLocalScale(WorldToLocal.GetMaximumAxisScale())
+	, ChunkSize(ChunkSize)
+	, MaxNumChunks(MaxNumChunks)
+{
+	ensure(ChunkSize > 0);
+}
+
+TVoxelArray<FIntVector> FVoxelInvokerChunkTracker::GetChunks() const
+{
+	return ChunkToNumInvokers.KeyArray();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelInvokerChunkTracker::Update(
+	const TVoxelMap<uint64, FVoxelChunkInvoker>& NewInvokers,
+	FVoxelInvokerChunkDelta& OutDelta)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(NewInvokers.Num(), 1);
+	using namespace Voxel::InvokerChunkTracker;
+
+	OutDelta.AddedChunks.Reset();
+	OutDelta.RemovedChunks.Reset();
+	NumRejectedInvokers = 0;
+
+	struct FChange
+	{
+		FShape OldShape;
+		FShape NewShape;
+		TVoxelArray<FIntVector> AddedChunks;
+		TVoxelArray<FIntVector> RemovedChunks;
+	};
+	TVoxelArray<FChange> Changes;
+	{
+		VOXEL_SCOPE_COUNTER("Find changes");
+
+		TVoxelArray<uint64> RemovedIds;
+		for (const auto& It : IdToChunkSphere)
+		{
+			if (NewInvokers.Contains(It.Key))
+			{
+				continue;
+			}
+
+			RemovedIds.Add(It.Key);
+			Changes.Add(FChange{ FShape(It.Value), FShape() });
+		}
+
+		for (const uint64 Id : RemovedIds)
+		{
+			IdToChunkSphere.RemoveChecked(Id);
+		}
+
+		for (const auto& It : NewInvokers)
+		{
+			const FSphere& Sphere = It.Value.Sphere;
+
+			FSphere ChunkSphere;
+			ChunkSphere.Center = WorldToLocal.TransformPosition(Sphere.Center) / ChunkSize;
+			ChunkSphere.W = Sphere.W * WorldToLocalScale / ChunkSize;
+
+			FSphere& OldChunkSphere = IdToChunkSphere.FindOrAdd(It.Key, [&](FSphere& NewChunkSphere)
+			{
+				// New invoker
+				NewChunkSphere.W = -1;
+			});
+
+			if (OldChunkSphere.Center == ChunkSphere.Center &&
+				OldChunkSphere.W == ChunkSphere.W)
+			{
+				continue;
+			}
+
+			Changes.Add(FChange
+			{
+				OldChunkSphere.W < 0 ? FShape() : FShape(OldChunkSphere),
+				FShape(ChunkSphere)
+			});
+
+			OldChunkSphere = ChunkSphere;
+		}
+	}
+
+	if (Changes.Num() == 0)
+	{
+		return;
+	}
+
+	{
+		VOXEL_SCOPE_COUNTER_NUM("Rasterize", Changes.Num(), 1);
+
+		Voxel::ParallelFor(Changes, [&](FChange& Change)
+		{
+			RasterizeDifference(
+				Change.OldShape,
+				Change.NewShape,
+				Change.AddedChunks,
+				Change.RemovedChunks);
+		});
+	}
+
+	// Chunks can be removed then added back by another invoker, or added then removed when rejecting invokers
+	// Track them so that the delta is relative to the state before Update
+	TVoxelSet<FIntVector> AddedChunks;
+	TVoxelSet<FIntVector> RemovedChunks;
+
+	const auto AddChunk = [&](const FIntVector& Chunk)
+	{
+		int32& NumInvokers = ChunkToNumInvokers.FindOrAdd(Chunk);
+		if (NumInvokers++ > 0)
+		{
+			return;
+		}
+
+		if (!RemovedChunks.Remove(Chunk))
+		{
+			AddedChunks.Add_CheckNew(Chunk);
+		}
+	};
+	const auto RemoveChunk = [&](const FIntVector& Chunk)
+	{
+		int32& NumInvokers = ChunkToNumInvokers.FindChecked(Chunk);
+		checkVoxelSlow(NumInvokers > 0);
+
+		if (--NumInvokers > 0)
+		{
+			return;
+		}
+
+		ChunkToNumInvokers.RemoveChecked(Chunk);
+
+		if (!AddedChunks.Remove(Chunk))
+		{
+			RemovedChunks.Add_CheckNew(Chunk);
+		}
+	};
+
+	{
+		VOXEL_SCOPE_COUNTER("Update chunks");
+
+		// Add first so that chunks moving from one invoker to another never reach 0
+		for (const FChange& Change : Changes)
+		{
+			for (const FIntVector& Chunk : Change.AddedChunks)
+			{
+				AddChunk(Chunk);
+			}
+		}
+		for (const FChange& Change : Changes)
+		{
+			for (const FIntVector& Chunk : Change.RemovedChunks)
+			{
+				RemoveChunk(Chunk);
+			}
+		}
+	}
+
+	if (ChunkToNumInvokers.Num() > MaxNumChunks)
+	{
+		VOXEL_SCOPE_COUNTER("Reject invokers");
+
+		// Rejected invokers are forgotten and will be retried next Update
+		TVoxelArray<uint64> Ids = IdToChunkSphere.KeyArray();
+		Ids.Sort([&](const uint64 A, const uint64 B)
+		{
+			const int32 PriorityA = NewInvokers.FindChecked(A).Priority;
+			const int32 PriorityB = NewInvokers.FindChecked(B).Priority;
+
+			if (PriorityA != PriorityB)
+			{
+				return PriorityA < PriorityB;
+			}
+			return A > B;
+		});
+
+		TVoxelArray<FIntVector> UnusedChunks;
+		TVoxelArray<FIntVector> RejectedChunks;
+		for (const uint64 Id : Ids)
+		{
+			if (ChunkToNumInvokers.Num() <= MaxNumChunks)
+			{
+				break;
+			}
+
+			RejectedChunks.Reset();
+			RasterizeDifference(
+				FShape(IdToChunkSphere.FindChecked(Id)),
+				FShape(),
+				UnusedChunks,
+				RejectedChunks);
+
+			for (const FIntVector& Chunk : RejectedChunks)
+			{
+				RemoveChunk(Chunk);
+			}
+
+			IdToChunkSphere.RemoveChecked(Id);
+			NumRejectedInvokers++;
+		}
+	}
+
+	OutDelta.AddedChunks = AddedChunks.Array();
+	OutDelta.RemovedChunks = RemovedChunks.Array();
+}
@@ -1,9 +1,8 @@
 // Copyright Voxel Plugin SAS. All Rights Reserved.
 
 #include "VoxelJumpFlood.h"
-#if WITH_EDITOR
 #include "Misc/ScopedSlowTask.h"
-#endif
+#include "VoxelJumpFloodImpl.ispc.generated.h"
 
 void FVoxelJumpFlood::JumpFlood2D(
 	const FIntPoint& Size,
@@ -11,133 +10,112 @@ void FVoxelJumpFlood::JumpFlood2D(
 {
 	VOXEL_SCOPE_COUNTER_FORMAT("JumpFlood2D %dx%d", Size.X, Size.Y);
 	check(InOutClosestPosition.Num() == Size.X * Size.Y);
+	checkStatic(sizeof(FIntPoint) == 2 * sizeof(int32));
 
-	TVoxelArray<FIntPoint> Temp;
-	FVoxelUtilities::SetNumFast(Temp, Size.X * Size.Y);
+	const int32 Num = Size.X * Size.Y;
 
-	bool bSourceIsTemp = false;
+	TVoxelArray<int32> ClosestX;
+	TVoxelArray<int32> ClosestY;
+	FVoxelUtilities::SetNumFast(ClosestX, Num);
+	FVoxelUtilities::SetNumFast(ClosestY, Num);
 
-	const int32 NumPasses = FMath::CeilLogTwo(Size.GetMax());
+	{
+		VOXEL_SCOPE_COUNTER("Split");
 
-#if WITH_EDITOR
-	FScopedSlowTask SlowTask(NumPasses + 1, INVTEXT("Performing Jump Flood"));
-	SlowTask.EnterProgressFrame();
-#endif
+		ispc::VoxelJumpFlood_Split2D(
+			&InOutClosestPosition.GetData()->X,
+			Num,
+			ClosestX.GetData(),
+			ClosestY.GetData());
+	}
+
+	JumpFlood2D(Size, ClosestX, ClosestY);
 
-	for (int32 Pass = 0; Pass < NumPasses; Pass++)
 	{
-		// -1: we want to start with half the size
-		const int32 Step = 1 << (NumPasses - 1 - Pass);
+		VOXEL_SCOPE_COUNTER("Merge");
 
-		JumpFlood2DImpl(
-			Size,
-			bSourceIsTemp ? Temp : InOutClosestPosition,
-			bSourceIsTemp ? InOutClosestPosition : Temp,
-			Step);
+		ispc::VoxelJumpFlood_Merge2D(
+			ClosestX.GetData(),
+			ClosestY.GetData(),
+			Num,
+			&InOutClosestPosition.GetData()->X);
+	}
+}
 
-		bSourceIsTemp = !bSourceIsTemp;
+void FVoxelJumpFlood::JumpFlood2D(
+	const FIntPoint& Size,
+	TVoxelArray<int32>& InOutClosestX,
+	TVoxelArray<int32>& InOutClosestY)
+{
+	VOXEL_SCOPE_COUNTER_FORMAT("JumpFlood2D %dx%d Num=%d", Size.X, Size.Y, Size.X * Size.Y);
+
+	const int32 Num = Size.X * Size.Y;
+	check(InOutClosestX.Num() == Num);
+	check(InOutClosestY.Num() == Num);
 
-#if WITH_EDITOR
-		SlowTask.EnterProgressFrame(1.f, FText::FromString("Performing Jump Flood " + LexToString(Pass + 1) + " of " + LexToString(NumPasses)));
-#endif
+	TVoxelArray<int32> TempX;
+	TVoxelArray<int32> TempY;
+	FVoxelUtilities::SetNumFast(TempX, Num);
+	FVoxelUtilities::SetNumFast(TempY, Num);
+
+	const int32 NumPasses = FMath::CeilLogTwo(Size.GetMax());
+
+	TVoxelOptional<FScopedSlowTask> SlowTask;
+	if (IsInGameThread())
+	{
+		SlowTask.Emplace(NumPasses, INVTEXT("Performing Jump Flood"));
 	}
 
-	if (bSourceIsTemp)
+	for (int32 Pass = 0; Pass < NumPasses; Pass++)
 	{
-		VOXEL_SCOPE_COUNTER("Memcpy");
-		FVoxelUtilities::Memcpy(InOutClosestPosition, Temp);
+		if (SlowTask)
+		{
+			SlowTask->EnterProgressFrame(1.f, FText::FromString("Performing Jump Flood " + LexToString(Pass + 1) + " of " + LexToString(NumPasses)));
+		}
+
+		// -1: we want to start with half the size
+		const int32 Step = 1 << (NumPasses - 1 - Pass);
+
+		VOXEL_SCOPE_COUNTER_FORMAT("JumpFlood2D Step=%d", Step);
+
+		Voxel::ParallelFor(Size.Y, [&](const int32 Y)
+		{
+			ispc::VoxelJumpFlood_JumpFlood2D(
+				Y,
+				Size.X,
+				Size.Y,
+				Step,
+				InOutClosestX.GetData(),
+				InOutClosestY.GetData(),
+				TempX.GetData(),
+				TempY.GetData());
+		});
+
+		Swap(InOutClosestX, TempX);
+		Swap(InOutClosestY, TempY);
 	}
 }
 
-void FVoxelJumpFlood::JumpFlood2DImpl(
+void FVoxelJumpFlood::JumpFlood2D(
 	const FIntPoint& Size,
-	const TConstVoxelArrayView<FIntPoint> InData,
-	const TVoxelArrayView<FIntPoint> OutData,
-	const int32 Step)
+	TVoxelArray<int32>& InOutClosestX,
+	TVoxelArray<int32>& InOutClosestY,
+	const TVoxelArrayView<float> OutDistances)
 {
 	VOXEL_FUNCTION_COUNTER();
+	check(OutDistances.Num() == Size.X * Size.Y);
 
-	checkVoxelSlow(InData.Num() == Size.X * Size.Y);
-	checkVoxelSlow(OutData.Num() == Size.X * Size.Y);
+	JumpFlood2D(Size, InOutClosestX, InOutClosestY);
 
-#if WITH_EDITOR
-	FScopedSlowTask SlowTask(Size.Y);
-#endif
+	VOXEL_SCOPE_COUNTER("ComputeDistances");
 
-	for (int32 Y = 0; Y < Size.Y; Y++)
+	Voxel::ParallelFor(Size.Y, [&](const int32 Y)
 	{
-#if WITH_EDITOR
-		if (Y % 10 == 9)
-		{
-			SlowTask.EnterProgressFrame(10.f);
-		}
-#endif
-		int32 Index = Size.X * Y;
-		for (int32 X = 0; X < Size.X; X++)
-		{
-			float BestDistance = MAX_flt;
-			FIntPoint BestPosition = MAX_int32;
-
-#define CheckNeighbor(DX, DY) \
-			{ \
-				const int32 NeighborIndex = Index + DX * Step + DY * Step * Size.X; \
-				checkVoxelSlow(NeighborIndex == FVoxelUtilities::Get2DIndex<int32>(Size, X + DX * Step, Y + DY * Step)); \
-				const FIntPoint NeighborPosition = InData[NeighborIndex]; \
-				const float Distance = FMath::Square<float>(NeighborPosition.X - X) + FMath::Square<float>(NeighborPosition.Y - Y); \
-				if (Distance < BestDistance) \
-				{ \
-					BestDistance = Distance; \
-					BestPosition = NeighborPosition; \
-				} \
-			}
-
-			if (Y - Step >= 0)
-			{
-				if (X - Step >= 0)
-				{
-					CheckNeighbor(-1, -1);
-				}
-
-				CheckNeighbor(0, -1);
-
-				if (X + Step < Size.X)
-				{
-					CheckNeighbor(1, -1);
-				}
-			}
-
-			if (X - Step >= 0)
-			{
-				CheckNeighbor(-1, 0);
-			}
-
-			CheckNeighbor(0, 0);
-
-			if (X + Step < Size.X)
-			{
-				CheckNeighbor(1, 0);
-			}
-
-			if (Y + Step < Size.Y)
-			{
-				if (X - Step >= 0)
-				{
-					CheckNeighbor(-1, 1);
-				}
-
-				CheckNeighbor(0, 1);
-
-				if (X + Step < Size.X)
-				{
-					CheckNeighbor(1, 1);
-				}
-			}
-
-			OutData[Index] = BestPosition;
-
-#undef CheckNeighbor
-
-			Index++;
-		}
-	}
-}
\ No newline at end of file
+		ispc::VoxelJumpFlood_ComputeDistances2D(
+			Y,
+			Size.X,
+			InOutClosestX.GetData(),
+			InOutClosestY.GetData(),
+			OutDistances.GetData());
+	});
+}
@@ -0,0 +1,446 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelMeshOptimizer.h"
+
+TVoxelArray<int32> FVoxelMeshOptimizer::WeldVertices(
+	TVoxelArray<int32>& Indices,
+	TVoxelArray<FVector3f>& Vertices,
+	const float Tolerance)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Vertices.Num());
+	check(Tolerance > 0.f);
+	check(Indices.Num() % 3 == 0);
+
+	TVoxelArray<FIntVector> Keys;
+	FVoxelUtilities::SetNumFast(Keys, Vertices.Num());
+
+	Voxel::ParallelFor(Keys, [&](FIntVector& Key, const int32 Index)
+	{
+		Key = FVoxelUtilities::RoundToInt(Vertices[Index] / Tolerance);
+	});
+
+	TVoxelArray<int32> OldToNewVertex;
+	FVoxelUtilities::SetNumFast(OldToNewVertex, Vertices.Num());
+
+	TVoxelArray<int32> NewToOldVertex;
+	NewToOldVertex.Reserve(Vertices.Num());
+	{
+		VOXEL_SCOPE_COUNTER("Merge");
+
+		TVoxelMap<FIntVector, int32> KeyToNewVertex;
+		KeyToNewVertex.Reserve(Vertices.Num());
+
+		for (int32 Index = 0; Index < Keys.Num(); Index++)
+		{
+			if (const int32* NewVertex = KeyToNewVertex.Find(Keys[Index]))
+			{
+				OldToNewVertex[Index] = *NewVertex;
+				continue;
+			}
+
+			const int32 NewVertex = NewToOldVertex.Add_EnsureNoGrow(Index);
+			KeyToNewVertex.Add_CheckNew(Keys[Index], NewVertex);
+			OldToNewVertex[Index] = NewVertex;
+		}
+	}
+
+	{
+		VOXEL_SCOPE_COUNTER("Remap indices");
+
+		int32 WriteIndex = 0;
+		for (int32 Index = 0; Index < Indices.Num(); Index += 3)
+		{
+			const int32 IndexA = OldToNewVertex[Indices[Index + 0]];
+			const int32 IndexB = OldToNewVertex[Indices[Index + 1]];
+			const int32 IndexC = OldToNewVertex[Indices[Index + 2]];
+
+			if (IndexA == IndexB ||
+				IndexA == IndexC ||
+				IndexB == IndexC)
+			{
+				continue;
+			}
+
+			Indices[WriteIndex++] = IndexA;
+			Indices[WriteIndex++] = IndexB;
+			Indices[WriteIndex++] = IndexC;
+		}
+		Indices.SetNum(WriteIndex, EAllowShrinking::No);
+	}
+
+	RemapVertices(Vertices, NewToOldVertex);
+
+	return NewToOldVertex;
+}
+
+void FVoxelMeshOptimizer::OptimizeVertexCache(
+	const TVoxelArrayView<int32> Indices,
+	const int32 NumVertices,
+	const int32 CacheSize)
+{
+	Tipsify(Indices, NumVertices, CacheSize, nullptr);
+}
+
+void FVoxelMeshOptimizer::OptimizeOverdraw(
+	const TVoxelArrayView<int32> Indices,
+	const TConstVoxelArrayView<FVector3f> Vertices,
+	const int32 CacheSize)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Indices.Num());
+
+	TVoxelArray<int32> ClusterStarts;
+	Tipsify(Indices, Vertices.Num(), CacheSize, &ClusterStarts);
+
+	const int32 NumTriangles = Indices.Num() / 3;
+	if (ClusterStarts.Num() <= 1)
+	{
+		return;
+	}
+
+	FVector3f MeshCentroid = FVector3f::ZeroVector;
+	for (const FVector3f& Vertex : Vertices)
+	{
+		MeshCentroid += Vertex;
+	}
+	MeshCentroid /= FMath::Max(1, Vertices.Num());
+
+	struct FCluster
+	{
+		int32 StartTriangle = 0;
+		int32 EndTriangle = 0;
+		float SortKey = 0.f;
+	};
+	TVoxelArray<FCluster> Clusters;
+	FVoxelUtilities::SetNumFast(Clusters, ClusterStarts.Num());
+
+	Voxel::ParallelFor(Clusters, [&](FCluster& Cluster, const int32 ClusterIndex)
+	{
+		Cluster.StartTriangle = ClusterStarts[ClusterIndex];
+		Cluster.EndTriangle = ClusterIndex + 1 < ClusterStarts.Num() ? ClusterStarts[ClusterIndex + 1] : NumTriangles;
+
+		FVector3f Centroid = FVector3f::ZeroVector;
+		FVector3f Normal = FVector3f::ZeroVector;
+		float Area = 0.f;
+
+		for (int32 Triangle = Cluster.StartTriangle; Triangle < Cluster.EndTriangle; Triangle++)
+		{
+			const FVector3f& A = Vertices[Indices[3 * Triangle + 0]];
+			const FVector3f& B = Vertices[Indices[3 * Triangle + 1]];
+			const FVector3f& C = Vertices[Indices[3 * Triangle + 2]];
+
+			// Length is twice the triangle area
+			const FVector3f TriangleNormal = FVoxelUtilities::GetTriangleNormal(A, B, C);
+			const float TriangleArea = TriangleNormal.Size();
+
+			Centroid += (A + B + C) / 3.f * TriangleArea;
+			Normal += TriangleNormal;
+			Area += TriangleArea;
+		}
+
+		if (Area > 0.f)
+		{
+			Centroid /= Area;
+		}
+
+		// Clusters facing away from the mesh center are likely to occlude the others: draw them first
+		Cluster.SortKey = FVector3f::DotProduct(Centroid - MeshCentroid, Normal.GetSafeNormal());
+	});
+
+	Clusters.Sort([](const FCluster& A, const FCluster& B)
+	{
+		return A.SortKey > B.SortKey;
+	});
+
+	TVoxelArray<int32> NewIndices;
+	NewIndices.Reserve(Indices.Num());
+
+	for (const FCluster& Cluster : Clusters)
+	{
+		NewIndices.Append(Indices.Slice(3 * Cluster.StartTriangle, 3 * (Cluster.EndTriangle - Cluster.StartTriangle)));
+	}
+	check(NewIndices.Num() == Indices.Num());
+
+	FVoxelUtilities::Memcpy(Indices, NewIndices);
+}
+
+TVoxelArray<int32> FVoxelMeshOptimizer::OptimizeVertexFetch(
+	const TVoxelArrayView<int32> Indices,
+	const int32 NumVertices)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Indices.Num());
+
+	TVoxelArray<int32> OldToNewVertex;
+	FVoxelUtilities::SetNumFast(OldToNewVertex, NumVertices);
+	FVoxelUtilities::SetAll(OldToNewVertex, -1);
+
+	TVoxelArray<int32> NewToOldVertex;
+	NewToOldVertex.Reserve(NumVertices);
+
+	for (int32& Index : Indices)
+	{
+		int32& NewVertex = OldToNewVertex[Index];
+		if (NewVertex == -1)
+		{
+			NewVertex = NewToOldVertex.Add_EnsureNoGrow(Index);
+		}
+		Index = NewVertex;
+	}
+
+	return NewToOldVertex;
+}
+
+void FVoxelMeshOptimizer::SortTrianglesSpatially(
+	const TVoxelArrayView<int32> Indices,
+	const TConstVoxelArrayView<FVector3f> Vertices)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Indices.Num());
+	check(Indices.Num() % 3 == 0);
+
+	const int32 NumTriangles = Indices.Num() / 3;
+	if (NumTriangles <= 1)
+	{
+		return;
+	}
+
+	const FVoxelBox Bounds = FVoxelBox::FromPositions(Vertices);
+	const double Scale = 1023. / FMath::Max(Bounds.Size().GetMax(), UE_SMALL_NUMBER);
+
+	const auto Quantize = [&](const double Value)
+	{
+		return uint32(FMath::Clamp(FMath::FloorToInt32(Value * Scale), 0, 1023));
+	};
+
+	// Morton code in the high bits, triangle index in the low bits
+	TVoxelArray<uint64> Keys;
+	FVoxelUtilities::SetNumFast(Keys, NumTriangles);
+
+	Voxel::ParallelFor(Keys, [&](uint64& Key, const int32 Triangle)
+	{
+		const FVector Centroid =
+			FVector(
+				Vertices[Indices[3 * Triangle + 0]] +
+				Vertices[Indices[3 * Triangle + 1]] +
+				Vertices[Indices[3 * Triangle + 2]]) / 3. - Bounds.Min;
+
+		const uint32 Code =
+			(FMath::MortonCode3(Quantize(Centroid.X)) << 0) |
+			(FMath::MortonCode3(Quantize(Centroid.Y)) << 1) |
+			(FMath::MortonCode3(Quantize(Centroid.Z)) << 2);
+
+		Key = (uint64(Code) << 32) | uint64(Triangle);
+	});
+
+	FVoxelUtilities::RadixSort(Keys);
+
+	TVoxelArray<int32> NewIndices;
+	FVoxelUtilities::SetNumFast(NewIndices, Indices.Num());
+
+	Voxel::ParallelFor(Keys, [&](const uint64 Key, const int32 NewTriangle)
+	{
+		const int32 OldTriangle = int32(Key & 0xFFFFFFFF);
+
+		NewIndices[3 * NewTriangle + 0] = Indices[3 * OldTriangle + 0];
+		NewIndices[3 * NewTriangle + 1] = Indices[3 * OldTriangle + 1];
+		NewIndices[3 * NewTriangle + 2] = Indices[3 * OldTriangle + 2];
+	});
+
+	FVoxelUtilities::Memcpy(Indices, NewIndices);
+}
+
+float FVoxelMeshOptimizer::ComputeACMR(
+	const TConstVoxelArrayView<int32> Indices,
+	const int32 NumVertices,
+	const int32 CacheSize)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Indices.Num());
+
+	if (Indices.Num() == 0)
+	{
+		return 0.f;
+	}
+
+	// A vertex is in the FIFO cache if less than CacheSize misses happened since it was added
+	TVoxelArray<int32> VertexToMissTime;
+	FVoxelUtilities::SetNumFast(VertexToMissTime, NumVertices);
+	FVoxelUtilities::SetAll(VertexToMissTime, -CacheSize - 1);
+
+	int32 NumMisses = 0;
+	for (const int32 Index : Indices)
+	{
+		if (NumMisses - VertexToMissTime[Index] >= CacheSize)
+		{
+			VertexToMissTime[Index] = NumMisses;
+			NumMisses++;
+		}
+	}
+
+	return NumMisses / float(Indices.Num() / 3);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelMeshOptimizer::Tipsify(
+	const TVoxelArrayView<int32> Indices,
+	const int32 NumVertices,
+	const int32 CacheSize,
+	TVoxelArray<int32>* OutClusterStarts)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Indices.Num());
+	check(Indices.Num() % 3 == 0);
+	check(CacheSize > 0);
+
+	const int32 NumTriangles = Indices.Num() / 3;
+	if (NumTriangles == 0)
+	{
+		return;
+	}
+
+	// Vertex to triangles adjacency, VertexToTriangles[Offsets[V]..Offsets[V + 1]]
+	TVoxelArray<int32> Offsets;
+	TVoxelArray<int32> VertexToTriangles;
+	{
+		VOXEL_SCOPE_COUNTER("Build adjacency");
+
+		Offsets.SetNumZeroed(NumVertices + 1);
+		for (const int32 Index : Indices)
+		{
+			Offsets[Index + 1]++;
+		}
+		for (int32 Vertex = 0; Vertex < NumVertices; Vertex++)
+		{
+			Offsets[Vertex + 1] += Offsets[Vertex];
+		}
+
+		TVoxelArray<int32> WriteOffsets(Offsets);
+		FVoxelUtilities::SetNumFast(VertexToTriangles, Indices.Num());
+
+		for (int32 Index = 0; Index < Indices.Num(); Index++)
+		{
+			VertexToTriangles[WriteOffsets[Indices[Index]]++] = Index / 3;
+		}
+	}
+
+	TVoxelArray<int32> LiveTriangles;
+	FVoxelUtilities::SetNumFast(LiveTriangles, NumVertices);
+	for (int32 Vertex = 0; Vertex < NumVertices; Vertex++)
+	{
+		LiveTriangles[Vertex] = Offsets[Vertex + 1] - Offsets[Vertex];
+	}
+
+	TVoxelArray<int32> CacheTime;
+	CacheTime.SetNumZeroed(NumVertices);
+
+	TVoxelArray<bool> IsEmitted;
+	IsEmitted.SetNumZeroed(NumTriangles);
+
+	TVoxelArray<int32> DeadEndStack;
+	DeadEndStack.Reserve(Indices.Num());
+
+	TVoxelArray<int32> NewIndices;
+	NewIndices.Reserve(Indices.Num());
+
+	TVoxelArray<int32> Candidates;
+
+	int32 Time = CacheSize + 1;
+	int32 Cursor = 0;
+	int32 FanningVertex = 0;
+	bool bIsNewCluster = true;
+
+	const auto SkipDeadEnd = [&]
+	{
+		while (DeadEndStack.Num() > 0)
+		{
+			const int32 Vertex = DeadEndStack.Pop();
+			if (LiveTriangles[Vertex] > 0)
+			{
+				return Vertex;
+			}
+		}
+
+		while (Cursor < NumVertices)
+		{
+			if (LiveTriangles[Cursor] > 0)
+			{
+				return Cursor;
+			}
+			Cursor++;
+		}
+
+		return -1;
+	};
+
+	while (FanningVertex != -1)
+	{
+		Candidates.Reset();
+
+		for (int32 Offset = Offsets[FanningVertex]; Offset < Offsets[FanningVertex + 1]; Offset++)
+		{
+			const int32 Triangle = VertexToTriangles[Offset];
+			if (IsEmitted[Triangle])
+			{
+				continue;
+			}
+			IsEmitted[Triangle] = true;
+
+			if (OutClusterStarts &&
+				bIsNewCluster)
+			{
+				OutClusterStarts->Add(NewIndices.Num() / 3);
+				bIsNewCluster = false;
+			}
+
+			for (int32 Corner = 0; Corner < 3; Corner++)
+			{
+				const int32 Vertex = Indices[3 * Triangle + Corner];
+
+				NewIndices.Add_EnsureNoGrow(Vertex);
+				DeadEndStack.Add_EnsureNoGrow(Vertex);
+				Candidates.Add(Vertex);
+
+				LiveTriangles[Vertex]--;
+
+				if (Time - CacheTime[Vertex] > CacheSize)
+				{
+					CacheTime[Vertex] = Time;
+					Time++;
+				}
+			}
+		}
+
+		// Pick the candidate still in cache after fanning around it, that entered the cache first
+		int32 BestVertex = -1;
+		int32 BestPriority = -1;
+		for (const int32 Vertex : Candidates)
+		{
+			if (LiveTriangles[Vertex] <= 0)
+			{
+				continue;
+			}
+
+			int32 Priority = 0;
+			if (Time - CacheTime[Vertex] + 2 * LiveTriangles[Vertex] <= CacheSize)
+			{
+				Priority = Time - CacheTime[Vertex];
+			}
+
+			if (Priority > BestPriority)
+			{
+				BestPriority = Priority;
+				BestVertex = Vertex;
+			}
+		}
+
+		if (BestVertex == -1)
+		{
+			BestVertex = SkipDeadEnd();
+			bIsNewCluster = true;
+		}
+
+		FanningVertex = BestVertex;
+	}
+
+	check(NewIndices.Num() == Indices.Num());
+	FVoxelUtilities::Memcpy(Indices, NewIndices);
+}
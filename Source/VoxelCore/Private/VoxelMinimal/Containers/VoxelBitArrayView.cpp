@@ -1,6 +1,7 @@
 // Copyright Voxel Plugin SAS. All Rights Reserved.
 
 #include "VoxelMinimal.h"
+#include "VoxelBitArrayViewImpl.ispc.generated.h"
 
 TVoxelOptional<bool> FConstVoxelBitArrayView::TryGetAll() const
 {
@@ -57,11 +58,7 @@ int32 FConstVoxelBitArrayView::CountSetBits() const
 
 	const int32 NumFullWords = FVoxelUtilities::DivideFloor_Positive(NumBits, NumBitsPerWord);
 
-	int32 Count = 0;
-	for (const uint64 Word : GetWordView().LeftOf(NumFullWords))
-	{
-		Count += FVoxelUtilities::CountBits(Word);
-	}
+	int32 Count = ispc::BitArrayView_CountSetBits(GetWordData(), NumFullWords);
 
 	const int32 NumBitsInLastWord = NumBits & WordMask;
 	checkVoxelSlow(NumBitsInLastWord == NumBits - NumFullWords * NumBitsPerWord);
@@ -74,6 +71,119 @@ int32 FConstVoxelBitArrayView::CountSetBits() const
 	return Count;
 }
 
+int32 FConstVoxelBitArrayView::CountSetBits(
+	const int32 StartIndex,
+	const int32 NumToCount) const
+{
+	VOXEL_FUNCTION_COUNTER_NUM(NumToCount, 4096);
+	checkVoxelSlow(0 <= StartIndex && StartIndex + NumToCount <= Num());
+
+	if (NumToCount == 0)
+	{
+		return 0;
+	}
+
+	const int32 EndIndex = StartIndex + NumToCount;
+
+	const int32 FirstWordIndex = FVoxelUtilities::DivideFloor_Positive(StartIndex, NumBitsPerWord);
+	const int32 LastWordIndex = FVoxelUtilities::DivideFloor_Positive(EndIndex - 1, NumBitsPerWord);
+
+	const uint64 StartMask = FullWord << (StartIndex & WordMask);
+	const uint64 EndMask = FullWord >> ((-EndIndex) & WordMask);
+
+	if (FirstWordIndex == LastWordIndex)
+	{
+		return FVoxelUtilities::CountBits(GetWord(FirstWordIndex) & StartMask & EndMask);
+	}
+
+	return
+		FVoxelUtilities::CountBits(GetWord(FirstWordIndex) & StartMask) +
+		ispc::BitArrayView_CountSetBits(GetWordData() + FirstWordIndex + 1, LastWordIndex - FirstWordIndex - 1) +
+		FVoxelUtilities::CountBits(GetWord(LastWordIndex) & EndMask);
+}
+
+int32 FConstVoxelBitArrayView::FindFirstSetBit() const
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Num(), 4096);
+
+	const int32 WordIndex = ispc::BitArrayView_FindFirstWord(GetWordData(), NumWords(), EmptyWord);
+	if (WordIndex == -1)
+	{
+		return -1;
+	}
+
+	const int32 Index = WordIndex * NumBitsPerWord + FVoxelUtilities::FirstBitLow(GetWord(WordIndex));
+	if (Index >= Num())
+	{
+		// Garbage bit in the last word
+		return -1;
+	}
+	return Index;
+}
+
+int32 FConstVoxelBitArrayView::FindFirstUnsetBit() const
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Num(), 4096);
+
+	const int32 WordIndex = ispc::BitArrayView_FindFirstWord(GetWordData(), NumWords(), FullWord);
+	if (WordIndex == -1)
+	{
+		return -1;
+	}
+
+	const int32 Index = WordIndex * NumBitsPerWord + FVoxelUtilities::FirstBitLow(~GetWord(WordIndex));
+	if (Index >= Num())
+	{
+		return -1;
+	}
+	return Index;
+}
+
+TVoxelArray<int32> FConstVoxelBitArrayView::GetSetBitIndices() const
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Num(), 4096);
+
+	TVoxelArray<int32> Indices;
+	FVoxelUtilities::SetNumFast(Indices, CountSetBits());
+
+	if (Indices.Num() == 0)
+	{
+		return Indices;
+	}
+
+	const int32 NumIndices = ispc::BitArrayView_GetSetBitIndices(
+		GetWordData(),
+		Num(),
+		Indices.GetData());
+
+	check(NumIndices == Indices.Num());
+	return Indices;
+}
+
+TVoxelArray<int32> FConstVoxelBitArrayView::GetSetBitIndices_AndNot(const FConstVoxelBitArrayView& Other) const
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Num(), 4096);
+	checkVoxelSlow(Num() == Other.Num());
+
+	TVoxelArray<int32> Indices;
+	FVoxelUtilities::SetNumFast(Indices, CountSetBits());
+
+	if (Indices.Num() == 0)
+	{
+		return Indices;
+	}
+
+	const int32 NumIndices = ispc::BitArrayView_GetSetBitIndices_AndNot(
+		GetWordData(),
+		Other.GetWordData(),
+		Num(),
+		Indices.GetData());
+
+	check(NumIndices <= Indices.Num());
+	Indices.SetNum(NumIndices, EAllowShrinking::No);
+	return Indices;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -83,10 +193,7 @@ void FVoxelBitArrayView::BitwiseOr(const FConstVoxelBitArrayView& Other) const
 	VOXEL_FUNCTION_COUNTER_NUM(this->Num(), 128);
 	checkVoxelSlow(this->Num() == Other.Num());
 
-	for (int32 WordIndex = 0; WordIndex < this->NumWords(); WordIndex++)
-	{
-		GetWord(WordIndex) |= Other.GetWord(WordIndex);
-	}
+	ispc::BitArrayView_Or(GetWordData(), Other.GetWordData(), NumWords());
 }
 
 void FVoxelBitArrayView::BitwiseAnd(const FConstVoxelBitArrayView& Other) const
@@ -94,10 +201,23 @@ void FVoxelBitArrayView::BitwiseAnd(const FConstVoxelBitArrayView& Other) const
 	VOXEL_FUNCTION_COUNTER_NUM(this->Num(), 128);
 	checkVoxelSlow(this->Num() == Other.Num());
 
-	for (int32 WordIndex = 0; WordIndex < this->NumWords(); WordIndex++)
-	{
-		GetWord(WordIndex) &= Other.GetWord(WordIndex);
-	}
+	ispc::BitArrayView_And(GetWordData(), Other.GetWordData(), NumWords());
+}
+
+void FVoxelBitArrayView::BitwiseXor(const FConstVoxelBitArrayView& Other) const
+{
+	VOXEL_FUNCTION_COUNTER_NUM(this->Num(), 128);
+	checkVoxelSlow(this->Num() == Other.Num());
+
+	ispc::BitArrayView_Xor(GetWordData(), Other.GetWordData(), NumWords());
+}
+
+void FVoxelBitArrayView::BitwiseAndNot(const FConstVoxelBitArrayView& Other) const
+{
+	VOXEL_FUNCTION_COUNTER_NUM(this->Num(), 128);
+	checkVoxelSlow(this->Num() == Other.Num());
+
+	ispc::BitArrayView_AndNot(GetWordData(), Other.GetWordData(), NumWords());
 }
 
 TVoxelArray<FVoxelIntBox2D> FVoxelBitArrayView::GreedyMeshing2D(const FIntPoint& Size) const
@@ -1,6 +1,7 @@
 // Copyright Voxel Plugin SAS. All Rights Reserved.
 
 #include "VoxelMinimal.h"
+#include "PackedNormal.h"
 #include "VoxelArrayUtilitiesImpl.ispc.generated.h"
 
 void FVoxelUtilities::Memcpy_Convert(
@@ -438,6 +439,203 @@ TVoxelArray<FVoxelOctahedron> FVoxelUtilities::MakeOctahedrons(
 	return Result;
 }
 
+TVoxelArray<FVoxelOctahedron> FVoxelUtilities::MakeOctahedrons_Precise(const TConstVoxelArrayView<FVector3f> Vectors)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Vectors.Num());
+
+	if (Vectors.Num() == 0)
+	{
+		return {};
+	}
+
+	TVoxelArray<FVoxelOctahedron> Result;
+	SetNumFast(Result, Vectors.Num());
+
+	ispc::ArrayUtilities_MakeOctahedrons_Precise_AOS(
+		ReinterpretCastPtr<ispc::float3>(Vectors.GetData()),
+		Result.GetData(),
+		Result.Num());
+
+	return Result;
+}
+
+TVoxelArray<FVector3f> FVoxelUtilities::GetUnitVectors(const TConstVoxelArrayView<FVoxelOctahedron> Octahedrons)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Octahedrons.Num());
+
+	if (Octahedrons.Num() == 0)
+	{
+		return {};
+	}
+
+	TVoxelArray<FVector3f> Result;
+	SetNumFast(Result, Octahedrons.Num());
+
+	ispc::ArrayUtilities_OctahedronsToUnitVectors_AOS(
+		Octahedrons.GetData(),
+		ReinterpretCastPtr<ispc::float3>(Result.GetData()),
+		Result.Num());
+
+	return Result;
+}
+
+void FVoxelUtilities::GetUnitVectors(
+	const TConstVoxelArrayView<FVoxelOctahedron> Octahedrons,
+	const TVoxelArrayView<float> OutX,
+	const TVoxelArrayView<float> OutY,
+	const TVoxelArrayView<float> OutZ)
+{
+	const int32 Num = Octahedrons.Num();
+	checkVoxelSlow(Num == OutX.Num());
+	checkVoxelSlow(Num == OutY.Num());
+	checkVoxelSlow(Num == OutZ.Num());
+
+	VOXEL_FUNCTION_COUNTER_NUM(Num, 1024);
+
+	if (Num == 0)
+	{
+		return;
+	}
+
+	ispc::ArrayUtilities_OctahedronsToUnitVectors_SOA(
+		Octahedrons.GetData(),
+		OutX.GetData(),
+		OutY.GetData(),
+		OutZ.GetData(),
+		Num);
+}
+
+TVoxelArray<uint32> FVoxelUtilities::MakeQuantizedOctahedrons(
+	const TConstVoxelArrayView<FVector3f> Vectors,
+	const int32 NumBits)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Vectors.Num());
+	check(1 <= NumBits && NumBits <= 16);
+
+	if (Vectors.Num() == 0)
+	{
+		return {};
+	}
+
+	TVoxelArray<uint32> Result;
+	SetNumFast(Result, Vectors.Num());
+
+	ispc::ArrayUtilities_MakeQuantizedOctahedrons(
+		ReinterpretCastPtr<ispc::float3>(Vectors.GetData()),
+		Result.GetData(),
+		Result.Num(),
+		NumBits);
+
+	return Result;
+}
+
+TVoxelArray<uint32> FVoxelUtilities::MakeQuantizedOctahedrons(
+	const TConstVoxelArrayView<FVoxelOctahedron> Octahedrons,
+	const int32 NumBits)
+{
+	TVoxelArray<uint32> Result;
+	SetNumFast(Result, Octahedrons.Num());
+	MakeQuantizedOctahedrons(Octahedrons, NumBits, Result);
+	return Result;
+}
+
+void FVoxelUtilities::MakeQuantizedOctahedrons(
+	const TConstVoxelArrayView<FVoxelOctahedron> Octahedrons,
+	const int32 NumBits,
+	const TVoxelArrayView<uint32> OutQuantizedOctahedrons)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Octahedrons.Num());
+	check(1 <= NumBits && NumBits <= 16);
+	check(Octahedrons.Num() == OutQuantizedOctahedrons.Num());
+
+	if (Octahedrons.Num() == 0)
+	{
+		return;
+	}
+
+	if (NumBits == 8)
+	{
+		for (int32 Index = 0; Index < Octahedrons.Num(); Index++)
+		{
+			const FVoxelOctahedron Octahedron = Octahedrons[Index];
+			OutQuantizedOctahedrons[Index] = Octahedron.X | (Octahedron.Y << 8);
+		}
+		return;
+	}
+
+	ispc::ArrayUtilities_OctahedronsToQuantizedOctahedrons(
+		Octahedrons.GetData(),
+		OutQuantizedOctahedrons.GetData(),
+		OutQuantizedOctahedrons.Num(),
+		NumBits);
+}
+
+TVoxelArray<FVector3f> FVoxelUtilities::GetUnitVectors(
+	const TConstVoxelArrayView<uint32> QuantizedOctahedrons,
+	const int32 NumBits)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(QuantizedOctahedrons.Num());
+	check(1 <= NumBits && NumBits <= 16);
+
+	if (QuantizedOctahedrons.Num() == 0)
+	{
+		return {};
+	}
+
+	TVoxelArray<FVector3f> Result;
+	SetNumFast(Result, QuantizedOctahedrons.Num());
+
+	ispc::ArrayUtilities_QuantizedOctahedronsToUnitVectors(
+		QuantizedOctahedrons.GetData(),
+		ReinterpretCastPtr<ispc::float3>(Result.GetData()),
+		Result.Num(),
+		NumBits);
+
+	return Result;
+}
+
+TVoxelArray<FPackedNormal> FVoxelUtilities::MakePackedNormals(const TConstVoxelArrayView<FVoxelOctahedron> Octahedrons)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Octahedrons.Num());
+	checkStatic(sizeof(FPackedNormal) == sizeof(uint32));
+
+	if (Octahedrons.Num() == 0)
+	{
+		return {};
+	}
+
+	TVoxelArray<FPackedNormal> Result;
+	SetNumFast(Result, Octahedrons.Num());
+
+	ispc::ArrayUtilities_OctahedronsToPackedNormals(
+		Octahedrons.GetData(),
+		ReinterpretCastPtr<uint32>(Result.GetData()),
+		Result.Num());
+
+	return Result;
+}
+
+TVoxelArray<FVoxelOctahedron> FVoxelUtilities::MakeOctahedrons(const TConstVoxelArrayView<FPackedNormal> Normals)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Normals.Num());
+	checkStatic(sizeof(FPackedNormal) == sizeof(uint32));
+
+	if (Normals.Num() == 0)
+	{
+		return {};
+	}
+
+	TVoxelArray<FVoxelOctahedron> Result;
+	SetNumFast(Result, Normals.Num());
+
+	ispc::ArrayUtilities_PackedNormalsToOctahedrons(
+		ReinterpretCastPtr<uint32>(Normals.GetData()),
+		Result.GetData(),
+		Result.Num());
+
+	return Result;
+}
+
 void FVoxelUtilities::FixupSignBit(const TVoxelArrayView<float> Data)
 {
 	VOXEL_FUNCTION_COUNTER_NUM(Data.Num());
@@ -454,6 +652,490 @@ void FVoxelUtilities::FixupSignBit(const TVoxelArrayView<float> Data)
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
+namespace FVoxelUtilities
+{
+	// Work is split in blocks of that size, each block being processed by a single ISPC call
+	constexpr int32 ParallelBlockSize = 32 * 1024;
+
+	FORCEINLINE int32 GetNumParallelBlocks(const int32 Num)
+	{
+		return FVoxelUtilities::DivideCeil_Positive(Num, ParallelBlockSize);
+	}
+	FORCEINLINE FInt32Interval GetParallelBlock(const int32 Num, const int32 Block)
+	{
+		const int32 Start = Block * ParallelBlockSize;
+		return { Start, FMath::Min(Start + ParallelBlockSize, Num) };
+	}
+
+	FORCEINLINE void Histogram256(
+		const TConstVoxelArrayView<uint32> Keys,
+		const int32 Shift,
+		int32* OutCounts)
+	{
+		ispc::ArrayUtilities_Histogram256_uint32(Keys.GetData(), Keys.Num(), Shift, OutCounts);
+	}
+	FORCEINLINE void Histogram256(
+		const TConstVoxelArrayView<uint64> Keys,
+		const int32 Shift,
+		int32* OutCounts)
+	{
+		ispc::ArrayUtilities_Histogram256_uint64(Keys.GetData(), Keys.Num(), Shift, OutCounts);
+	}
+
+	template<typename KeyType>
+	void RadixSortImpl(
+		const TVoxelArrayView<KeyType> Keys,
+		const TVoxelArrayView<int32> Values)
+	{
+		VOXEL_SCOPE_COUNTER_FORMAT("FVoxelUtilities::RadixSort %s Num=%d", *GetCppName<KeyType>(), Keys.Num());
+
+		const int32 Num = Keys.Num();
+		const bool bHasValues = Values.Num() > 0;
+		check(!bHasValues || Values.Num() == Num);
+
+		if (Num <= 1)
+		{
+			return;
+		}
+
+		TVoxelArray<KeyType> TempKeys;
+		FVoxelUtilities::SetNumFast(TempKeys, Num);
+
+		TVoxelArray<int32> TempValues;
+		if (bHasValues)
+		{
+			FVoxelUtilities::SetNumFast(TempValues, Num);
+		}
+
+		TVoxelArrayView<KeyType> SrcKeys = Keys;
+		TVoxelArrayView<KeyType> DstKeys = TempKeys;
+		TVoxelArrayView<int32> SrcValues = Values;
+		TVoxelArrayView<int32> DstValues = TempValues;
+
+		const int32 NumBlocks = GetNumParallelBlocks(Num);
+
+		// Digit-major: BlockOffsets[Block * 256 + Digit]
+		TVoxelArray<int32> BlockOffsets;
+		FVoxelUtilities::SetNumFast(BlockOffsets, NumBlocks * 256);
+
+		for (int32 Shift = 0; Shift < int32(8 * sizeof(KeyType)); Shift += 8)
+		{
+			Voxel::ParallelFor(NumBlocks, [&](const int32 Block)
+			{
+				const FInt32Interval Range = GetParallelBlock(Num, Block);
+
+				Histogram256(
+					SrcKeys.Slice(Range.Min, Range.Size()),
+					Shift,
+					&BlockOffsets[Block * 256]);
+			});
+
+			bool bAllSameDigit = false;
+			int32 Offset = 0;
+			for (int32 Digit = 0; Digit < 256; Digit++)
+			{
+				const int32 DigitStart = Offset;
+
+				for (int32 Block = 0; Block < NumBlocks; Block++)
+				{
+					const int32 Count = BlockOffsets[Block * 256 + Digit];
+					BlockOffsets[Block * 256 + Digit] = Offset;
+					Offset += Count;
+				}
+
+				if (Offset - DigitStart == Num)
+				{
+					bAllSameDigit = true;
+					break;
+				}
+			}
+
+			if (bAllSameDigit)
+			{
+				continue;
+			}
+			checkVoxelSlow(Offset == Num);
+
+			Voxel::ParallelFor(NumBlocks, [&](const int32 Block)
+			{
+				const FInt32Interval Range = GetParallelBlock(Num, Block);
+
+				int32* RESTRICT Offsets = &BlockOffsets[Block * 256];
+
+				for (int32 Index = Range.Min; Index < Range.Max; Index++)
+				{
+					const KeyType Key = SrcKeys[Index];
+					const int32 NewIndex = Offsets[(Key >> Shift) & 0xFF]++;
+
+					DstKeys[NewIndex] = Key;
+
+					if (bHasValues)
+					{
+						DstValues[NewIndex] = SrcValues[Index];
+					}
+				}
+			});
+
+			Swap(SrcKeys, DstKeys);
+			Swap(SrcValues, DstValues);
+		}
+
+		if (SrcKeys.GetData() == Keys.GetData())
+		{
+			return;
+		}
+
+		FVoxelUtilities::Memcpy(Keys, SrcKeys);
+
+		if (bHasValues)
+		{
+			FVoxelUtilities::Memcpy(Values, SrcValues);
+		}
+	}
+
+	template<bool bInclusive>
+	int32 ScanImpl(
+		const TConstVoxelArrayView<int32> Data,
+		const TVoxelArrayView<int32> OutData)
+	{
+		VOXEL_FUNCTION_COUNTER_NUM(Data.Num());
+		check(Data.Num() == OutData.Num());
+
+		const auto Scan = [&](const int32 Start, const int32 Num, const int32 Offset)
+		{
+			if constexpr (bInclusive)
+			{
+				return ispc::ArrayUtilities_InclusiveScan_int32(Data.GetData() + Start, OutData.GetData() + Start, Num, Offset);
+			}
+			else
+			{
+				return ispc::ArrayUtilities_ExclusiveScan_int32(Data.GetData() + Start, OutData.GetData() + Start, Num, Offset);
+			}
+		};
+
+		const int32 NumBlocks = GetNumParallelBlocks(Data.Num());
+		if (NumBlocks <= 1)
+		{
+			return Scan(0, Data.Num(), 0);
+		}
+
+		TVoxelArray<int32> BlockOffsets;
+		FVoxelUtilities::SetNumFast(BlockOffsets, NumBlocks);
+
+		Voxel::ParallelFor(NumBlocks, [&](const int32 Block)
+		{
+			const FInt32Interval Range = GetParallelBlock(Data.Num(), Block);
+			BlockOffsets[Block] = ispc::ArrayUtilities_Sum_int32(Data.GetData() + Range.Min, Range.Size());
+		});
+
+		const int32 Sum = ispc::ArrayUtilities_ExclusiveScan_int32(BlockOffsets.GetData(), BlockOffsets.GetData(), NumBlocks, 0);
+
+		Voxel::ParallelFor(NumBlocks, [&](const int32 Block)
+		{
+			const FInt32Interval Range = GetParallelBlock(Data.Num(), Block);
+			Scan(Range.Min, Range.Size(), BlockOffsets[Block]);
+		});
+
+		return Sum;
+	}
+}
+
+void FVoxelUtilities::RadixSort(const TVoxelArrayView<uint32> Keys)
+{
+	RadixSortImpl<uint32>(Keys, {});
+}
+
+void FVoxelUtilities::RadixSort(const TVoxelArrayView<uint64> Keys)
+{
+	RadixSortImpl<uint64>(Keys, {});
+}
+
+void FVoxelUtilities::RadixSort(
+	const TVoxelArrayView<uint32> Keys,
+	const TVoxelArrayView<int32> Values)
+{
+	RadixSortImpl<uint32>(Keys, Values);
+}
+
+void FVoxelUtilities::RadixSort(
+	const TVoxelArrayView<uint64> Keys,
+	const TVoxelArrayView<int32> Values)
+{
+	RadixSortImpl<uint64>(Keys, Values);
+}
+
+int32 FVoxelUtilities::ExclusiveScan(
+	const TConstVoxelArrayView<int32> Data,
+	const TVoxelArrayView<int32> OutData)
+{
+	return ScanImpl<false>(Data, OutData);
+}
+
+int32 FVoxelUtilities::InclusiveScan(
+	const TConstVoxelArrayView<int32> Data,
+	const TVoxelArrayView<int32> OutData)
+{
+	return ScanImpl<true>(Data, OutData);
+}
+
+TVoxelArray<int32> FVoxelUtilities::Histogram(
+	const TConstVoxelArrayView<uint32> Data,
+	const int32 NumBins)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Data.Num());
+	check(NumBins > 0);
+
+	const int32 NumBlocks = GetNumParallelBlocks(Data.Num());
+	const int32 NumBlockBins = NumBins <= 256 ? 256 : NumBins;
+
+	TVoxelArray<int32> BlockCounts;
+	FVoxelUtilities::SetNumFast(BlockCounts, NumBlocks * NumBlockBins);
+
+	Voxel::ParallelFor(NumBlocks, [&](const int32 Block)
+	{
+		const FInt32Interval Range = GetParallelBlock(Data.Num(), Block);
+		const TConstVoxelArrayView<uint32> BlockData = Data.Slice(Range.Min, Range.Size());
+		const TVoxelArrayView<int32> Counts = MakeVoxelArrayView(BlockCounts).Slice(Block * NumBlockBins, NumBlockBins);
+
+		if (NumBins <= 256)
+		{
+			Histogram256(BlockData, 0, Counts.GetData());
+			return;
+		}
+
+		FVoxelUtilities::Memzero(Counts);
+
+		for (const uint32 Value : BlockData)
+		{
+			checkVoxelSlow(Value < uint32(NumBins));
+			Counts[Value]++;
+		}
+	});
+
+	TVoxelArray<int32> Result;
+	FVoxelUtilities::SetNum(Result, NumBins);
+
+	for (int32 Block = 0; Block < NumBlocks; Block++)
+	{
+		for (int32 Bin = 0; Bin < NumBins; Bin++)
+		{
+			Result[Bin] += BlockCounts[Block * NumBlockBins + Bin];
+		}
+	}
+
+	return Result;
+}
+
+TVoxelArray<int32> FVoxelUtilities::CompactIndices(const TConstVoxelArrayView<uint8> Mask)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Mask.Num());
+
+	const int32 NumBlocks = GetNumParallelBlocks(Mask.Num());
+
+	TVoxelArray<int32> BlockOffsets;
+	FVoxelUtilities::SetNumFast(BlockOffsets, NumBlocks);
+
+	Voxel::ParallelFor(NumBlocks, [&](const int32 Block)
+	{
+		const FInt32Interval Range = GetParallelBlock(Mask.Num(), Block);
+		BlockOffsets[Block] = ispc::ArrayUtilities_CountNonZero(Mask.GetData() + Range.Min, Range.Size());
+	});
+
+	const int32 NumIndices = ispc::ArrayUtilities_ExclusiveScan_int32(BlockOffsets.GetData(), BlockOffsets.GetData(), NumBlocks, 0);
+
+	TVoxelArray<int32> Indices;
+	FVoxelUtilities::SetNumFast(Indices, NumIndices);
+
+	Voxel::ParallelFor(NumBlocks, [&](const int32 Block)
+	{
+		const FInt32Interval Range = GetParallelBlock(Mask.Num(), Block);
+
+		const int32 NumBlockIndices = ispc::ArrayUtilities_CompactIndices(
+			Mask.GetData() + Range.Min,
+			Range.Size(),
+			Range.Min,
+			Indices.GetData() + BlockOffsets[Block]);
+
+		checkVoxelSlow(BlockOffsets[Block] + NumBlockIndices == (Block + 1 < NumBlocks ? BlockOffsets[Block + 1] : NumIndices));
+	});
+
+	return Indices;
+}
+
+TVoxelArray<int32> FVoxelUtilities::CompactIndices(
+	const int32 Num,
+	const TFunctionRef<bool(int32 Index)> Predicate)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Num);
+
+	TVoxelArray<uint8> Mask;
+	FVoxelUtilities::SetNumFast(Mask, Num);
+
+	Voxel::ParallelFor(GetNumParallelBlocks(Num), [&](const int32 Block)
+	{
+		const FInt32Interval Range = GetParallelBlock(Num, Block);
+
+		for (int32 Index = Range.Min; Index < Range.Max; Index++)
+		{
+			Mask[Index] = Predicate(Index);
+		}
+	});
+
+	return CompactIndices(Mask);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+int32 FVoxelUtilities::BuildHashTable(
+	const TVoxelArrayView<int32> HashTable,
+	const int32 Num,
+	const TFunctionRef<uint32(int32 Index)> GetHash,
+	const TFunctionRef<bool(int32 IndexA, int32 IndexB)> Equal,
+	const TFunctionRef<void(int32 ElementIndex, int32 Index, int32 NextElementIndex)> Emplace)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Num);
+	check(Num >= 0);
+
+	const int32 HashSize = HashTable.Num();
+	check(FMath::IsPowerOfTwo(HashSize));
+	// One partition per value of the top 8 bits of the bucket index
+	check(HashSize >= 256);
+
+	const uint32 HashMask = HashSize - 1;
+	const int32 PartitionShift = FMath::FloorLog2(HashSize) - 8;
+	const int32 NumBucketsPerPartition = HashSize / 256;
+
+	const int32 NumBlocks = GetNumParallelBlocks(Num);
+
+	TVoxelArray<uint32> Hashes;
+	FVoxelUtilities::SetNumFast(Hashes, Num);
+
+	// BlockOffsets[Block * 256 + Partition]
+	TVoxelArray<int32> BlockOffsets;
+	FVoxelUtilities::SetNumFast(BlockOffsets, NumBlocks * 256);
+
+	Voxel::ParallelFor(NumBlocks, [&](const int32 Block)
+	{
+		const FInt32Interval Range = GetParallelBlock(Num, Block);
+
+		for (int32 Index = Range.Min; Index < Range.Max; Index++)
+		{
+			Hashes[Index] = GetHash(Index);
+		}
+
+		Histogram256(
+			MakeVoxelArrayView(Hashes).Slice(Range.Min, Range.Size()),
+			PartitionShift,
+			&BlockOffsets[Block * 256]);
+	});
+
+	int32 PartitionOffsets[257];
+	{
+		int32 Offset = 0;
+		for (int32 Partition = 0; Partition < 256; Partition++)
+		{
+			PartitionOffsets[Partition] = Offset;
+
+			for (int32 Block = 0; Block < NumBlocks; Block++)
+			{
+				const int32 Count = BlockOffsets[Block * 256 + Partition];
+				BlockOffsets[Block * 256 + Partition] = Offset;
+				Offset += Count;
+			}
+		}
+		PartitionOffsets[256] = Offset;
+		check(Offset == Num);
+	}
+
+	// Stable: within a partition, indices are increasing
+	TVoxelArray<int32> SortedIndices;
+	FVoxelUtilities::SetNumFast(SortedIndices, Num);
+
+	Voxel::ParallelFor(NumBlocks, [&](const int32 Block)
+	{
+		const FInt32Interval Range = GetParallelBlock(Num, Block);
+
+		int32* RESTRICT Offsets = &BlockOffsets[Block * 256];
+
+		for (int32 Index = Range.Min; Index < Range.Max; Index++)
+		{
+			SortedIndices[Offsets[(Hashes[Index] >> PartitionShift) & 0xFF]++] = Index;
+		}
+	});
+
+	// Bucket chains are first built with input indices
+	TVoxelArray<int32> NextIndices;
+	FVoxelUtilities::SetNumFast(NextIndices, Num);
+
+	TVoxelArray<uint8> IsUnique;
+	FVoxelUtilities::SetNumFast(IsUnique, Num);
+
+	Voxel::ParallelFor(256, [&](const int32 Partition)
+	{
+		FVoxelUtilities::Memset(HashTable.Slice(Partition * NumBucketsPerPartition, NumBucketsPerPartition), 0xFF);
+
+		for (int32 SortedIndex = PartitionOffsets[Partition]; SortedIndex < PartitionOffsets[Partition + 1]; SortedIndex++)
+		{
+			const int32 Index = SortedIndices[SortedIndex];
+			const uint32 Hash = Hashes[Index];
+
+			int32& Bucket = HashTable[Hash & HashMask];
+			checkVoxelSlow(int32((Hash & HashMask) / NumBucketsPerPartition) == Partition);
+
+			int32 OtherIndex = Bucket;
+			while (
+				OtherIndex != -1 &&
+				!(Hashes[OtherIndex] == Hash && Equal(OtherIndex, Index)))
+			{
+				OtherIndex = NextIndices[OtherIndex];
+			}
+
+			if (OtherIndex != -1)
+			{
+				// Not the first occurrence
+				IsUnique[Index] = false;
+				continue;
+			}
+
+			IsUnique[Index] = true;
+			NextIndices[Index] = Bucket;
+			Bucket = Index;
+		}
+	});
+
+	const TVoxelArray<int32> UniqueIndices = CompactIndices(IsUnique);
+
+	// SortedIndices isn't needed anymore
+	TVoxelArray<int32>& IndexToElementIndex = SortedIndices;
+
+	Voxel::ParallelFor(UniqueIndices, [&](const int32 Index, const int32 ElementIndex)
+	{
+		IndexToElementIndex[Index] = ElementIndex;
+	});
+
+	Voxel::ParallelFor(HashTable, [&](int32& ElementIndex)
+	{
+		if (ElementIndex != -1)
+		{
+			ElementIndex = IndexToElementIndex[ElementIndex];
+		}
+	});
+
+	Voxel::ParallelFor(UniqueIndices, [&](const int32 Index, const int32 ElementIndex)
+	{
+		const int32 NextIndex = NextIndices[Index];
+		Emplace(ElementIndex, Index, NextIndex == -1 ? -1 : IndexToElementIndex[NextIndex]);
+	});
+
+	return UniqueIndices.Num();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
 struct FVoxelOodleHeader
 {
 	uint64 Tag = MAKE_TAG_64("OODLE_VO");
@@ -445,15 +445,20 @@ bool FVoxelUtilities::ComputeInvokerChunks(
 
 	OutChunks.Reset();
 
+	// Chunks of overlapping invokers are duplicated, they are only removed when building OutChunks
+	TVoxelArray<FIntVector> Chunks;
 	{
 		double Num = 0;
 		for (const FChunkedInvoker& Invoker : ChunkedInvokers)
 		{
 			Num += FMath::Cube(2 * Invoker.RadiusInChunks + 1);
 		}
-		OutChunks.Reserve(FMath::Min<int64>(FMath::CeilToInt64(Num), 32768));
+		Chunks.Reserve(FMath::Min<int64>(FMath::CeilToInt64(Num), 32768));
 	}
 
+	// Deduplicate whenever the number of chunks including duplicates gets too high
+	int64 MaxNumChunksWithDuplicates = MaxNumChunks;
+
 	for (const FChunkedInvoker& Invoker : ChunkedInvokers)
 	{
 		VOXEL_SCOPE_COUNTER_FORMAT_COND(Invoker.RadiusInChunks > 2, "Add invoker Radius=%f chunks", Invoker.RadiusInChunks);
@@ -481,17 +486,40 @@ bool FVoxelUtilities::ComputeInvokerChunks(
 						continue;
 					}
 
-					OutChunks.Add(FIntVector(X, Y, Z));
+					Chunks.Add(FIntVector(X, Y, Z));
+				}
+
+				if (Chunks.Num() <= MaxNumChunksWithDuplicates)
+				{
+					continue;
 				}
 
+				OutChunks.BuildFromArray(Chunks);
+
 				if (OutChunks.Num() > MaxNumChunks)
 				{
 					return false;
 				}
+
+				Chunks.Reset();
+				for (const FIntVector& Chunk : OutChunks)
+				{
+					Chunks.Add(Chunk);
+				}
+
+				// Don't deduplicate again until we've at least doubled
+				MaxNumChunksWithDuplicates = FMath::Max<int64>(MaxNumChunks, 2 * Chunks.Num());
 			}
 		}
 	}
 
+	OutChunks.BuildFromArray(Chunks);
+
+	if (OutChunks.Num() > MaxNumChunks)
+	{
+		return false;
+	}
+
 	OutChunks.Shrink();
 
 	return true;
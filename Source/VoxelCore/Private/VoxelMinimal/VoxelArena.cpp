@@ -0,0 +1,202 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelMinimal.h"
+
+DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelArenaMemory);
+DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelArenaCachedMemory);
+
+const uint32 GVoxelArenaTLS = FPlatformTLS::AllocTlsSlot();
+
+VOXEL_CONSOLE_VARIABLE(
+	VOXELCORE_API, int32, GVoxelArenaMaxCachedChunksPerThread, 16,
+	"voxel.Arena.MaxCachedChunksPerThread",
+	"Number of arena chunks kept by each thread for the next FVoxelArena");
+
+struct FVoxelArenaChunkCache
+{
+	TVoxelArray<uint8*> Chunks;
+
+	~FVoxelArenaChunkCache()
+	{
+		for (uint8* Chunk : Chunks)
+		{
+			FMemory::Free(Chunk);
+		}
+		DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelArenaCachedMemory, Chunks.Num() * FVoxelArena::ChunkSize);
+	}
+};
+thread_local FVoxelArenaChunkCache GVoxelArenaChunkCache;
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelArena::FVoxelArena()
+	: ThreadId(FPlatformTLS::GetCurrentThreadId())
+	, PreviousArena(GetCurrent())
+{
+	FPlatformTLS::SetTlsValue(GVoxelArenaTLS, this);
+}
+
+FVoxelArena::~FVoxelArena()
+{
+	check(ThreadId == FPlatformTLS::GetCurrentThreadId());
+	checkf(GetCurrent() == this, TEXT("Arenas must be destroyed in the reverse order of their creation"));
+
+	FPlatformTLS::SetTlsValue(GVoxelArenaTLS, PreviousArena);
+
+#if VOXEL_ARENA_POISON
+	ensureMsgf(NumLiveAllocations == 0, TEXT("%lld arena allocations are still alive: containers are outliving their arena"), NumLiveAllocations);
+#endif
+
+	TVoxelArray<uint8*>& CachedChunks = GVoxelArenaChunkCache.Chunks;
+	for (const FChunk& Chunk : Chunks)
+	{
+		if (Chunk.Size != ChunkSize ||
+			CachedChunks.Num() >= GVoxelArenaMaxCachedChunksPerThread)
+		{
+			FMemory::Free(Chunk.Data);
+			continue;
+		}
+
+#if VOXEL_ARENA_POISON
+		FMemory::Memset(Chunk.Data, 0xDD, Chunk.Size);
+#endif
+
+		CachedChunks.Add(Chunk.Data);
+		INC_VOXEL_MEMORY_STAT_BY(STAT_VoxelArenaCachedMemory, ChunkSize);
+	}
+
+	AllocatedSize = 0;
+	UpdateStats();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void* FVoxelArena::Reallocate(
+	void* Pointer,
+	const int64 OldSize,
+	const int64 NewSize,
+	const uint32 Alignment,
+	const int64 NumBytesToCopy)
+{
+	checkVoxelSlow(NumBytesToCopy <= OldSize);
+
+	if (NewSize == 0)
+	{
+		if (Pointer)
+		{
+			Free(Pointer, OldSize);
+		}
+		return nullptr;
+	}
+
+	uint8* Data = static_cast<uint8*>(Pointer);
+
+	if (Data &&
+		NewSize <= MaxSmallAllocationSize &&
+		Data + OldSize == Current &&
+		Data + NewSize <= End)
+	{
+		checkVoxelSlow(IsAligned(Data, Alignment));
+
+#if VOXEL_ARENA_POISON
+		if (NewSize > OldSize)
+		{
+			FMemory::Memset(Data + OldSize, 0xCD, NewSize - OldSize);
+		}
+		else
+		{
+			FMemory::Memset(Data + NewSize, 0xDD, OldSize - NewSize);
+		}
+#endif
+
+		UsedSize += NewSize - OldSize;
+		HighWaterMark = FMath::Max(HighWaterMark, UsedSize);
+		Current = Data + NewSize;
+		return Data;
+	}
+
+	void* NewPointer = Allocate(NewSize, Alignment);
+
+	if (Pointer)
+	{
+		FMemory::Memcpy(NewPointer, Pointer, FMath::Min(NumBytesToCopy, NewSize));
+		Free(Pointer, OldSize);
+	}
+
+	return NewPointer;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void* FVoxelArena::AllocateSlow(const int64 Size, const uint32 Alignment)
+{
+	if (Size > MaxSmallAllocationSize)
+	{
+		uint8* Data = static_cast<uint8*>(FMemory::Malloc(Size, Alignment));
+		Chunks.Add(FChunk{ Data, Size });
+
+		AllocatedSize += Size;
+		UpdateStats();
+
+		UsedSize += Size;
+		HighWaterMark = FMath::Max(HighWaterMark, UsedSize);
+
+#if VOXEL_ARENA_POISON
+		FMemory::Memset(Data, 0xCD, Size);
+		NumLiveAllocations++;
+#endif
+
+		return Data;
+	}
+
+	uint8* Data;
+	if (GVoxelArenaChunkCache.Chunks.Num() > 0)
+	{
+		Data = GVoxelArenaChunkCache.Chunks.Pop();
+		DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelArenaCachedMemory, ChunkSize);
+	}
+	else
+	{
+		VOXEL_SCOPE_COUNTER("FVoxelArena Allocate chunk");
+		Data = static_cast<uint8*>(FMemory::Malloc(ChunkSize, PLATFORM_CACHE_LINE_SIZE));
+	}
+
+	Chunks.Add(FChunk{ Data, ChunkSize });
+
+	AllocatedSize += ChunkSize;
+	UpdateStats();
+
+	Current = Data;
+	End = Data + ChunkSize;
+
+	return Allocate(Size, Alignment);
+}
+
+void FVoxelArena::FreeLarge(void* Pointer, const int64 Size)
+{
+	for (int32 Index = Chunks.Num() - 1; Index >= 0; Index--)
+	{
+		if (Chunks[Index].Data != Pointer)
+		{
+			continue;
+		}
+
+		checkVoxelSlow(Chunks[Index].Size == Size);
+		FMemory::Free(Pointer);
+		Chunks.RemoveAtSwap(Index);
+
+		AllocatedSize -= Size;
+		UpdateStats();
+
+		UsedSize -= Size;
+		return;
+	}
+
+	checkf(false, TEXT("Pointer was not allocated by this arena"));
+}
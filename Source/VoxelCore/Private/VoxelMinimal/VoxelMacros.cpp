@@ -6,40 +6,34 @@
 
 FVoxelCounter32 GVoxelNumGCScopes;
 
-struct FVoxelGCScopeGuard::FImpl
-{
-	FGCScopeGuard Guard;
-
-	FImpl()
-	{
-		GVoxelNumGCScopes.Increment();
-	}
-	~FImpl()
-	{
-		GVoxelNumGCScopes.Decrement();
-	}
-};
-
 FVoxelGCScopeGuard::FVoxelGCScopeGuard()
 {
+	checkStatic(sizeof(FGCScopeGuard) <= sizeof(GuardStorage));
+	checkStatic(alignof(FGCScopeGuard) <= alignof(decltype(GuardStorage)));
+
 	if (IsInGameThread())
 	{
 		return;
 	}
 
 	VOXEL_FUNCTION_COUNTER();
-	Impl = MakePimpl<FImpl>();
+
+	new (GuardStorage.GetTypedPtr()) FGCScopeGuard();
+	GVoxelNumGCScopes.Increment();
+	bIsLocked = true;
 }
 
 FVoxelGCScopeGuard::~FVoxelGCScopeGuard()
 {
-	if (!Impl)
+	if (!bIsLocked)
 	{
 		return;
 	}
 
 	VOXEL_FUNCTION_COUNTER();
-	Impl.Reset();
+
+	GVoxelNumGCScopes.Decrement();
+	reinterpret_cast<FGCScopeGuard*>(GuardStorage.GetTypedPtr())->~FGCScopeGuard();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -2,6 +2,17 @@
 
 #include "VoxelMinimal.h"
 
+// Start at 1 so that epochs initialized to 0 are always stale
+FVoxelCounter64 GVoxelGCEpoch = 1;
+
+VOXEL_RUN_ON_STARTUP_GAME()
+{
+	FCoreUObjectDelegates::GetPreGarbageCollectDelegate().AddLambda([]
+	{
+		GVoxelGCEpoch.Increment();
+	});
+}
+
 FVoxelObjectPtr::FVoxelObjectPtr(const UObject* Object)
 {
 	checkUObjectAccess();
@@ -76,6 +87,93 @@ bool FVoxelObjectPtr::IsValid_Slow() const
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
+void FVoxelObjectPtr::ResolveBatch(
+	const TConstVoxelArrayView<FVoxelObjectPtr> ObjectPtrs,
+	const TVoxelArrayView<UObject*> OutObjects)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(ObjectPtrs.Num(), 1024);
+	check(ObjectPtrs.Num() == OutObjects.Num());
+
+	FVoxelGCScopeGuard Guard;
+	checkUObjectAccess();
+
+	// Object items are scattered in memory, fetch them ahead of time
+	constexpr int32 PrefetchDistance = 8;
+
+	const auto Prefetch = [&](const int32 Index)
+	{
+		const FVoxelObjectPtr& ObjectPtr = ObjectPtrs[Index];
+		if (ObjectPtr.ObjectSerialNumber == 0)
+		{
+			return;
+		}
+
+		if (const FUObjectItem* ObjectItem = GUObjectArray.IndexToObject(ObjectPtr.ObjectIndex))
+		{
+			FPlatformMisc::Prefetch(ObjectItem);
+		}
+	};
+
+	for (int32 Index = 0; Index < FMath::Min(PrefetchDistance, ObjectPtrs.Num()); Index++)
+	{
+		Prefetch(Index);
+	}
+
+	for (int32 Index = 0; Index < ObjectPtrs.Num(); Index++)
+	{
+		if (Index + PrefetchDistance < ObjectPtrs.Num())
+		{
+			Prefetch(Index + PrefetchDistance);
+		}
+
+		OutObjects[Index] = ObjectPtrs[Index].Resolve_Unsafe();
+	}
+}
+
+bool FVoxelObjectPtr::ResolveBatch(
+	const TConstVoxelArrayView<FVoxelObjectPtr> ObjectPtrs,
+	const TVoxelArrayView<UObject*> OutObjects,
+	uint64& InOutEpoch)
+{
+	// Take the guard before reading the epoch so that no GC can start in between
+	FVoxelGCScopeGuard Guard;
+
+	const uint64 Epoch = GetGCEpoch();
+	if (InOutEpoch == Epoch)
+	{
+		checkVoxelSlow(ObjectPtrs.Num() == OutObjects.Num());
+		return false;
+	}
+
+	ResolveBatch(ObjectPtrs, OutObjects);
+	InOutEpoch = Epoch;
+	return true;
+}
+
+void FVoxelObjectPtr::GetFNameBatch(
+	const TConstVoxelArrayView<FVoxelObjectPtr> ObjectPtrs,
+	const TVoxelArrayView<FName> OutNames)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(ObjectPtrs.Num(), 1024);
+	check(ObjectPtrs.Num() == OutNames.Num());
+
+	FVoxelGCScopeGuard Guard;
+
+	TVoxelArray<UObject*> Objects;
+	FVoxelUtilities::SetNumFast(Objects, ObjectPtrs.Num());
+	ResolveBatch(ObjectPtrs, Objects);
+
+	for (int32 Index = 0; Index < ObjectPtrs.Num(); Index++)
+	{
+		const UObject* Object = Objects[Index];
+		OutNames[Index] = Object ? Object->GetFName() : STATIC_FNAME("<null>");
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
 FName FVoxelObjectPtr::GetFName() const
 {
 	FVoxelGCScopeGuard Guard;
@@ -47,6 +47,11 @@ VOXEL_RUN_ON_STARTUP_GAME()
 }
 #endif
 
+VOXEL_CONSOLE_VARIABLE(
+	VOXELCORE_API, int32, GVoxelParallelForMaxNumThreads, 0,
+	"voxel.ParallelFor.MaxNumThreads",
+	"If > 0, limits the number of threads used by Voxel::ParallelFor. Used by benchmarks to sweep thread counts.");
+
 int32 Voxel::Internal::GetMaxNumThreads()
 {
 	// See ParallelForImpl::GetNumberOfThreadTasks
@@ -68,6 +73,11 @@ int32 Voxel::Internal::GetMaxNumThreads()
 		Result++;
 	}
 
+	if (GVoxelParallelForMaxNumThreads > 0)
+	{
+		Result = FMath::Min(Result, GVoxelParallelForMaxNumThreads);
+	}
+
 	return FMath::Clamp(Result, 1, FPlatformMisc::NumberOfCoresIncludingHyperthreads());
 }
 
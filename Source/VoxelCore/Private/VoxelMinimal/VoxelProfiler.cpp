@@ -0,0 +1,485 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelMinimal.h"
+#include "HAL/ThreadManager.h"
+
+#if VOXEL_PROFILER
+std::atomic<bool> GVoxelProfilerEnabled = false;
+
+VOXEL_CONSOLE_VARIABLE(
+	VOXELCORE_API, int32, GVoxelProfilerBufferSize, 32768,
+	"voxel.Profiler.BufferSize",
+	"Number of scopes kept per thread by the voxel profiler, older scopes are overwritten. Only applies to threads that haven't recorded any scope yet");
+
+VOXEL_CONSOLE_COMMAND(
+	"voxel.Profiler.Start",
+	"Start recording voxel scopes. Clears any previous recording")
+{
+	FVoxelProfiler::Start();
+}
+
+VOXEL_CONSOLE_COMMAND(
+	"voxel.Profiler.Stop",
+	"Stop recording voxel scopes")
+{
+	FVoxelProfiler::Stop();
+}
+
+VOXEL_CONSOLE_COMMAND(
+	"voxel.Profiler.Export",
+	"Export the recorded voxel scopes as a Chrome trace. Optional argument: file path, defaults to the profiling directory")
+{
+	FString Path;
+	if (Args.Num() > 0)
+	{
+		Path = Args[0];
+	}
+	else
+	{
+		Path = FPaths::ProfilingDir() / "VoxelProfiler-" + FDateTime::Now().ToString() + ".json";
+	}
+
+	FVoxelProfiler::ExportChromeTrace(Path);
+}
+
+VOXEL_CONSOLE_COMMAND(
+	"voxel.Profiler.Dump",
+	"Log the duration histograms of the recorded voxel scopes. Optional argument: number of scopes to log, defaults to 50")
+{
+	int32 MaxNumScopes = 50;
+	if (Args.Num() > 0)
+	{
+		LexFromString(MaxNumScopes, *Args[0]);
+	}
+
+	FVoxelProfiler::DumpStats(MaxNumScopes);
+}
+
+// -VoxelProfiler starts recording on launch
+// -VoxelProfilerOutput=Path.json additionally exports the trace on exit
+VOXEL_RUN_ON_STARTUP_GAME()
+{
+	if (!FParse::Param(FCommandLine::Get(), TEXT("VoxelProfiler")))
+	{
+		return;
+	}
+
+	FVoxelProfiler::Start();
+
+	FString Path;
+	if (!FParse::Value(FCommandLine::Get(), TEXT("VoxelProfilerOutput="), Path))
+	{
+		return;
+	}
+
+	GOnVoxelModuleUnloaded.AddLambda([Path]
+	{
+		FVoxelProfiler::Stop();
+		FVoxelProfiler::ExportChromeTrace(Path);
+	});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+struct FVoxelProfilerEvent
+{
+	FName Name;
+	uint64 StartTimestamp;
+	uint64 EndTimestamp;
+};
+
+struct FVoxelProfilerThreadEvents
+{
+	uint32 ThreadId = 0;
+	TVoxelArray<FVoxelProfilerEvent> Events;
+};
+
+// Single producer ring buffer
+// Readers copy the events and discard the ones that were overwritten while copying
+class FVoxelProfilerBuffer
+{
+public:
+	const uint32 ThreadId;
+	const uint64 Capacity;
+
+	explicit FVoxelProfilerBuffer(const int32 Size)
+		: ThreadId(FPlatformTLS::GetCurrentThreadId())
+		, Capacity(FMath::RoundUpToPowerOfTwo(FMath::Max(Size, 1024)))
+	{
+		FVoxelUtilities::SetNumFast(Events, Capacity);
+	}
+
+	FORCEINLINE void Add(const FVoxelProfilerEvent& Event)
+	{
+		const uint64 Index = WriteIndex.Get(std::memory_order_relaxed);
+		Events[Index & (Capacity - 1)] = Event;
+		WriteIndex.Set(Index + 1, std::memory_order_release);
+	}
+
+	void Clear()
+	{
+		ClearIndex.Set(WriteIndex.Get());
+	}
+
+	FVoxelProfilerThreadEvents Copy() const
+	{
+		FVoxelProfilerThreadEvents Result;
+		Result.ThreadId = ThreadId;
+
+		const uint64 EndIndex = WriteIndex.Get(std::memory_order_acquire);
+		const uint64 StartIndex = FMath::Max(ClearIndex.Get(), EndIndex > Capacity ? EndIndex - Capacity : 0);
+		if (StartIndex >= EndIndex)
+		{
+			return Result;
+		}
+
+		FVoxelUtilities::SetNumFast(Result.Events, EndIndex - StartIndex);
+
+		for (uint64 Index = StartIndex; Index < EndIndex; Index++)
+		{
+			Result.Events[Index - StartIndex] = Events[Index & (Capacity - 1)];
+		}
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		// Any event at or before NewEndIndex - Capacity might have been overwritten during the copy:
+		// the writer might be writing NewEndIndex, which shares its slot with NewEndIndex - Capacity
+		const uint64 NewEndIndex = WriteIndex.Get(std::memory_order_relaxed);
+		if (NewEndIndex >= StartIndex + Capacity)
+		{
+			const uint64 NumOverwritten = FMath::Min(NewEndIndex - Capacity - StartIndex + 1, EndIndex - StartIndex);
+			Result.Events.RemoveAt(0, NumOverwritten);
+		}
+
+		return Result;
+	}
+
+private:
+	TVoxelArray<FVoxelProfilerEvent> Events;
+	TVoxelAtomic<uint64> WriteIndex = 0;
+	TVoxelAtomic<uint64> ClearIndex = 0;
+};
+
+// Buffers are never freed so that AddScope never needs to lock
+// This leaks a buffer per thread ever created, which is fine as long as threads are pooled
+FVoxelCriticalSection GVoxelProfilerCriticalSection;
+TVoxelArray<FVoxelProfilerBuffer*> GVoxelProfilerBuffers;
+thread_local FVoxelProfilerBuffer* GVoxelProfilerThreadBuffer = nullptr;
+
+uint64 GVoxelProfilerStartTimestamp = 0;
+
+FORCENOINLINE FVoxelProfilerBuffer& AllocateVoxelProfilerBuffer()
+{
+	check(!GVoxelProfilerThreadBuffer);
+	GVoxelProfilerThreadBuffer = new FVoxelProfilerBuffer(GVoxelProfilerBufferSize);
+
+	VOXEL_SCOPE_LOCK(GVoxelProfilerCriticalSection);
+	GVoxelProfilerBuffers.Add(GVoxelProfilerThreadBuffer);
+	return *GVoxelProfilerThreadBuffer;
+}
+
+TVoxelArray<FVoxelProfilerThreadEvents> CopyVoxelProfilerEvents()
+{
+	VOXEL_FUNCTION_COUNTER();
+	VOXEL_SCOPE_LOCK(GVoxelProfilerCriticalSection);
+
+	TVoxelArray<FVoxelProfilerThreadEvents> Result;
+	for (const FVoxelProfilerBuffer* Buffer : GVoxelProfilerBuffers)
+	{
+		FVoxelProfilerThreadEvents ThreadEvents = Buffer->Copy();
+		if (ThreadEvents.Events.Num() > 0)
+		{
+			Result.Add(MoveTemp(ThreadEvents));
+		}
+	}
+	return Result;
+}
+
+double GetVoxelProfilerSecondsPerTimestamp()
+{
+#if PLATFORM_CPU_X86_FAMILY
+	// Calibrate the TSC frequency once, invariant TSC is assumed
+	static const double SecondsPerTimestamp = []
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		const uint64 StartTimestamp = FVoxelProfiler::GetTimestamp();
+
+		FPlatformProcess::Sleep(0.02f);
+
+		const double EndTime = FPlatformTime::Seconds();
+		const uint64 EndTimestamp = FVoxelProfiler::GetTimestamp();
+
+		return (EndTime - StartTime) / FMath::Max<double>(EndTimestamp - StartTimestamp, 1);
+	}();
+	return SecondsPerTimestamp;
+#else
+	return FPlatformTime::GetSecondsPerCycle64();
+#endif
+}
+
+FString GetVoxelProfilerThreadName(const uint32 ThreadId)
+{
+	if (ThreadId == GGameThreadId)
+	{
+		return "GameThread";
+	}
+
+	FString Name = FThreadManager::GetThreadName(ThreadId);
+	if (Name.IsEmpty())
+	{
+		Name = FString::Printf(TEXT("Thread %u"), ThreadId);
+	}
+	return Name;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelProfiler::AddScope(
+	const FName Name,
+	const uint64 StartTimestamp,
+	const uint64 EndTimestamp)
+{
+	FVoxelProfilerBuffer* Buffer = GVoxelProfilerThreadBuffer;
+	if (UNLIKELY(!Buffer))
+	{
+		Buffer = &AllocateVoxelProfilerBuffer();
+	}
+
+	Buffer->Add(FVoxelProfilerEvent
+	{
+		Name,
+		StartTimestamp,
+		EndTimestamp
+	});
+}
+
+void FVoxelProfiler::Start()
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	// Calibrate before recording anything
+	GetVoxelProfilerSecondsPerTimestamp();
+
+	{
+		VOXEL_SCOPE_LOCK(GVoxelProfilerCriticalSection);
+
+		for (FVoxelProfilerBuffer* Buffer : GVoxelProfilerBuffers)
+		{
+			Buffer->Clear();
+		}
+	}
+
+	GVoxelProfilerStartTimestamp = GetTimestamp();
+	GVoxelProfilerEnabled.store(true);
+
+	LOG_VOXEL(Display, "Voxel profiler started");
+}
+
+void FVoxelProfiler::Stop()
+{
+	if (!GVoxelProfilerEnabled.exchange(false))
+	{
+		return;
+	}
+
+	LOG_VOXEL(Display, "Voxel profiler stopped after %s",
+		*FVoxelUtilities::SecondsToString((GetTimestamp() - GVoxelProfilerStartTimestamp) * GetVoxelProfilerSecondsPerTimestamp()));
+}
+
+bool FVoxelProfiler::ExportChromeTrace(const FString& Path)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	const TVoxelArray<FVoxelProfilerThreadEvents> AllThreadEvents = CopyVoxelProfilerEvents();
+	const double MicrosecondsPerTimestamp = GetVoxelProfilerSecondsPerTimestamp() * 1.e6;
+
+	int64 NumEvents = 0;
+	uint64 MinTimestamp = MAX_uint64;
+	for (const FVoxelProfilerThreadEvents& ThreadEvents : AllThreadEvents)
+	{
+		NumEvents += ThreadEvents.Events.Num();
+
+		for (const FVoxelProfilerEvent& Event : ThreadEvents.Events)
+		{
+			MinTimestamp = FMath::Min(MinTimestamp, Event.StartTimestamp);
+		}
+	}
+
+	// Names are shared by many events, escape them once
+	TVoxelMap<FName, FString> NameToEscapedName;
+	const auto GetEscapedName = [&](const FName Name) -> const FString&
+	{
+		if (const FString* EscapedName = NameToEscapedName.Find(Name))
+		{
+			return *EscapedName;
+		}
+
+		FString EscapedName = Name.ToString();
+		EscapedName.ReplaceInline(TEXT("\\"), TEXT("\\\\"));
+		EscapedName.ReplaceInline(TEXT("\""), TEXT("\\\""));
+		return NameToEscapedName.Add_CheckNew(Name, EscapedName);
+	};
+
+	TStringBuilder<1024> Builder;
+	Builder.Append(TEXT("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n"));
+
+	bool bFirst = true;
+	for (const FVoxelProfilerThreadEvents& ThreadEvents : AllThreadEvents)
+	{
+		if (!bFirst)
+		{
+			Builder.Append(TEXT(",\n"));
+		}
+		bFirst = false;
+
+		Builder.Appendf(
+			TEXT("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"%s\"}}"),
+			ThreadEvents.ThreadId,
+			*GetVoxelProfilerThreadName(ThreadEvents.ThreadId).ReplaceCharWithEscapedChar());
+
+		for (const FVoxelProfilerEvent& Event : ThreadEvents.Events)
+		{
+			Builder.Appendf(
+				TEXT(",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}"),
+				*GetEscapedName(Event.Name),
+				ThreadEvents.ThreadId,
+				(Event.StartTimestamp - MinTimestamp) * MicrosecondsPerTimestamp,
+				(Event.EndTimestamp - Event.StartTimestamp) * MicrosecondsPerTimestamp);
+		}
+	}
+
+	Builder.Append(TEXT("\n]}\n"));
+
+	if (!FFileHelper::SaveStringToFile(Builder.ToView(), *Path, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+	{
+		LOG_VOXEL(Error, "Failed to write %s", *Path);
+		return false;
+	}
+
+	LOG_VOXEL(Display, "Exported %lld voxel scopes from %d threads to %s",
+		NumEvents,
+		AllThreadEvents.Num(),
+		*FPaths::ConvertRelativePathToFull(Path));
+
+	return true;
+}
+
+void FVoxelProfiler::DumpStats(const int32 MaxNumScopes)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	const TVoxelArray<FVoxelProfilerThreadEvents> AllThreadEvents = CopyVoxelProfilerEvents();
+	const double NanosecondsPerTimestamp = GetVoxelProfilerSecondsPerTimestamp() * 1.e9;
+
+	struct FScopeStats
+	{
+		int64 Count = 0;
+		double TotalTime = 0;
+		// Total time minus the time spent in child scopes on the same thread
+		double SelfTime = 0;
+		double MaxTime = 0;
+		// Bucket N counts scopes lasting between 2^N and 2^(N+1) nanoseconds
+		TVoxelStaticArray<int64, 64> Histogram{ ForceInit };
+
+		double GetPercentile(const double Percentile) const
+		{
+			const int64 Target = FMath::CeilToInt64(Count * Percentile);
+
+			int64 Sum = 0;
+			for (int32 Bucket = 0; Bucket < Histogram.Num(); Bucket++)
+			{
+				Sum += Histogram[Bucket];
+
+				if (Sum >= Target)
+				{
+					// Geometric center of the bucket
+					return FMath::Pow(2., Bucket + 0.5) * 1.e-9;
+				}
+			}
+			return MaxTime;
+		}
+	};
+	TVoxelMap<FName, FScopeStats> NameToStats;
+
+	for (const FVoxelProfilerThreadEvents& ThreadEvents : AllThreadEvents)
+	{
+		// Sort parents before their children
+		TVoxelArray<FVoxelProfilerEvent> Events = ThreadEvents.Events;
+		Events.Sort([](const FVoxelProfilerEvent& A, const FVoxelProfilerEvent& B)
+		{
+			if (A.StartTimestamp != B.StartTimestamp)
+			{
+				return A.StartTimestamp < B.StartTimestamp;
+			}
+			return A.EndTimestamp > B.EndTimestamp;
+		});
+
+		struct FStackEntry
+		{
+			uint64 EndTimestamp;
+			FName Name;
+		};
+		TVoxelArray<FStackEntry> Stack;
+
+		for (const FVoxelProfilerEvent& Event : Events)
+		{
+			while (
+				Stack.Num() > 0 &&
+				Stack.Last().EndTimestamp <= Event.StartTimestamp)
+			{
+				Stack.Pop();
+			}
+
+			const uint64 Duration = Event.EndTimestamp - Event.StartTimestamp;
+			const double Time = Duration * NanosecondsPerTimestamp * 1.e-9;
+
+			FScopeStats& Stats = NameToStats.FindOrAdd(Event.Name);
+			Stats.Count++;
+			Stats.TotalTime += Time;
+			Stats.SelfTime += Time;
+			Stats.MaxTime = FMath::Max(Stats.MaxTime, Time);
+			Stats.Histogram[FMath::FloorLog2_64(FMath::Max<uint64>(uint64(Duration * NanosecondsPerTimestamp), 1))]++;
+
+			if (Stack.Num() > 0)
+			{
+				NameToStats.FindChecked(Stack.Last().Name).SelfTime -= Time;
+			}
+
+			Stack.Add(FStackEntry{ Event.EndTimestamp, Event.Name });
+		}
+	}
+
+	NameToStats.ValueSort([](const FScopeStats& A, const FScopeStats& B)
+	{
+		return A.TotalTime > B.TotalTime;
+	});
+
+	LOG_VOXEL(Display, "Voxel profiler: %d scopes", NameToStats.Num());
+	LOG_VOXEL(Display, "%-60s %10s %12s %12s %12s %12s %12s %12s", TEXT("Name"), TEXT("Count"), TEXT("Total"), TEXT("Self"), TEXT("Mean"), TEXT("P50"), TEXT("P99"), TEXT("Max"));
+
+	int32 NumLogged = 0;
+	for (const auto& It : NameToStats)
+	{
+		if (NumLogged++ >= MaxNumScopes)
+		{
+			break;
+		}
+
+		const FScopeStats& Stats = It.Value;
+
+		LOG_VOXEL(Display, "%-60s %10lld %12s %12s %12s %12s %12s %12s",
+			*It.Key.ToString(),
+			Stats.Count,
+			*FVoxelUtilities::SecondsToString(Stats.TotalTime),
+			*FVoxelUtilities::SecondsToString(Stats.SelfTime),
+			*FVoxelUtilities::SecondsToString(Stats.TotalTime / Stats.Count),
+			*FVoxelUtilities::SecondsToString(Stats.GetPercentile(0.5)),
+			*FVoxelUtilities::SecondsToString(Stats.GetPercentile(0.99)),
+			*FVoxelUtilities::SecondsToString(Stats.MaxTime));
+	}
+}
+#endif
@@ -20,7 +20,10 @@ public:
 
 		const EVoxelFutureThread Thread;
 		const EType Type;
-		TVoxelStaticArray<uint64, 2> Storage{ ForceInit };
+		TVoxelStaticArray<
+			uint64,
+			sizeof(TVoxelUniqueFunction<void()>) / sizeof(uint64),
+			alignof(TVoxelUniqueFunction<void()>)> Storage{ ForceInit };
 
 		TUniquePtr<FContinuation> NextContinuation;
 
@@ -45,6 +48,7 @@ public:
 			: Thread(Thread)
 			, Type(EType::ValueLambda)
 		{
+			checkStatic(sizeof(TVoxelUniqueFunction<void(const FSharedVoidRef&)>) == sizeof(Storage));
 			new(&Storage) TVoxelUniqueFunction<void(const FSharedVoidRef&)>(MoveTemp(Lambda));
 		}
 		FORCEINLINE ~FContinuation()
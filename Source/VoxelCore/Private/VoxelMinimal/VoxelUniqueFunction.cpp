@@ -0,0 +1,96 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelMinimal.h"
+
+#if VOXEL_UNIQUE_FUNCTION_STATS
+VOXEL_CONSOLE_VARIABLE(
+	VOXELCORE_API, bool, GVoxelTrackUniqueFunctionSpills, false,
+	"voxel.UniqueFunction.TrackSpills",
+	"If true, count how many TVoxelUniqueFunction binds of each lambda type don't fit inline and allocate. See voxel.UniqueFunction.DumpSpills");
+
+struct FVoxelUniqueFunctionCallSites
+{
+	FVoxelCriticalSection CriticalSection;
+	TVoxelArray<TUniquePtr<FVoxelUniqueFunctionCallSite>> CallSites_RequiresLock;
+
+	static FVoxelUniqueFunctionCallSites& Get()
+	{
+		static FVoxelUniqueFunctionCallSites Singleton;
+		return Singleton;
+	}
+};
+
+FVoxelUniqueFunctionCallSite& FVoxelUniqueFunctionCallSite::Register(
+	const TCHAR* Name,
+	const int32 FunctorSize,
+	const int32 InlineSize)
+{
+	TUniquePtr<FVoxelUniqueFunctionCallSite> CallSite = MakeUnique<FVoxelUniqueFunctionCallSite>();
+	CallSite->Name = FVoxelUtilities::Internal_GetCppName(Name);
+	CallSite->FunctorSize = FunctorSize;
+	CallSite->InlineSize = InlineSize;
+
+	FVoxelUniqueFunctionCallSite& Result = *CallSite;
+
+	FVoxelUniqueFunctionCallSites& CallSites = FVoxelUniqueFunctionCallSites::Get();
+	VOXEL_SCOPE_LOCK(CallSites.CriticalSection);
+	CallSites.CallSites_RequiresLock.Add(MoveTemp(CallSite));
+
+	return Result;
+}
+
+VOXEL_CONSOLE_COMMAND(
+	"voxel.UniqueFunction.DumpSpills",
+	"Log the lambda types that allocate the most when bound to a TVoxelUniqueFunction. Requires voxel.UniqueFunction.TrackSpills 1. Optional argument: number of lambda types to log, defaults to 50")
+{
+	int32 MaxNumCallSites = 50;
+	if (Args.Num() > 0)
+	{
+		LexFromString(MaxNumCallSites, *Args[0]);
+	}
+
+	if (!GVoxelTrackUniqueFunctionSpills)
+	{
+		LOG_VOXEL(Warning, "voxel.UniqueFunction.TrackSpills is disabled, stats are not being updated");
+	}
+
+	FVoxelUniqueFunctionCallSites& CallSites = FVoxelUniqueFunctionCallSites::Get();
+	VOXEL_SCOPE_LOCK(CallSites.CriticalSection);
+
+	TVoxelArray<const FVoxelUniqueFunctionCallSite*> SortedCallSites;
+	int64 TotalNumBinds = 0;
+	int64 TotalNumSpills = 0;
+	for (const TUniquePtr<FVoxelUniqueFunctionCallSite>& CallSite : CallSites.CallSites_RequiresLock)
+	{
+		TotalNumBinds += CallSite->NumBinds.Get();
+		TotalNumSpills += CallSite->NumSpills.Get();
+
+		if (CallSite->NumSpills.Get() > 0)
+		{
+			SortedCallSites.Add(CallSite.Get());
+		}
+	}
+
+	SortedCallSites.Sort([](const FVoxelUniqueFunctionCallSite& A, const FVoxelUniqueFunctionCallSite& B)
+	{
+		return A.NumSpills.Get() > B.NumSpills.Get();
+	});
+
+	LOG_VOXEL(Log, "%lld/%lld TVoxelUniqueFunction binds spilled to the heap (%.1f%%)",
+		TotalNumSpills,
+		TotalNumBinds,
+		TotalNumBinds > 0 ? 100. * TotalNumSpills / TotalNumBinds : 0.);
+
+	for (int32 Index = 0; Index < FMath::Min(MaxNumCallSites, SortedCallSites.Num()); Index++)
+	{
+		const FVoxelUniqueFunctionCallSite& CallSite = *SortedCallSites[Index];
+
+		LOG_VOXEL(Log, "\t%8lld spills (%5.1f%% of binds) Size=%4d InlineSize=%3d %s",
+			CallSite.NumSpills.Get(),
+			100. * CallSite.NumSpills.Get() / FMath::Max<int64>(CallSite.NumBinds.Get(), 1),
+			CallSite.FunctorSize,
+			CallSite.InlineSize,
+			*CallSite.Name);
+	}
+}
+#endif
@@ -273,27 +273,24 @@ FPackedCluster FCluster::Pack(const FEncodingInfo& Info) const
 	Result.SetPosBitsZ(Info.PositionBits.Z);
 
 #if VOXEL_ENGINE_VERSION >= 506
-	Result.LODBounds = FSphere3f(FVector3f(
-			Bounds.GetCenter().X,
-			Bounds.GetCenter().Y,
-			Bounds.GetCenter().Z),
-		Bounds.Size().Length());
+	Result.LODBounds = LODBounds;
 #else
 	Result.LODBounds = FVector4f(
-		Bounds.GetCenter().X,
-		Bounds.GetCenter().Y,
-		Bounds.GetCenter().Z,
-		Bounds.Size().Length());
+		LODBounds.Center.X,
+		LODBounds.Center.Y,
+		LODBounds.Center.Z,
+		LODBounds.W);
 #endif
 
 	Result.BoxBoundsCenter = FVector3f(Bounds.GetCenter());
 
 	Result.LODErrorAndEdgeLength =
-		(uint32(FFloat16(0.1f /* TODO? InCluster.LODError*/).Encoded) << 0) |
+		(uint32(FFloat16(LODError).Encoded) << 0) |
 		(uint32(FFloat16(MaxEdgeLength).Encoded) << 16);
 
 	Result.BoxBoundsExtent = FVector3f(Bounds.GetExtent());
-	Result.UE_506_SWITCH(Flags, Flags_NumClusterBoneInfluences) = NANITE_CLUSTER_FLAG_STREAMING_LEAF | NANITE_CLUSTER_FLAG_ROOT_LEAF;
+	// All our pages are root pages: only the leaves of the DAG are leaves
+	Result.UE_506_SWITCH(Flags, Flags_NumClusterBoneInfluences) = bIsLeaf ? NANITE_CLUSTER_FLAG_STREAMING_LEAF | NANITE_CLUSTER_FLAG_ROOT_LEAF : 0;
 
 	Result.SetBitsPerAttribute(Info.BitsPerAttribute);
 	Result.SetNormalPrecision(Info.Settings.NormalBits);
@@ -661,6 +658,9 @@ void CreatePageData(
 		TVoxelChunkedArray<uint8> MidByteStream;
 		TVoxelChunkedArray<uint8> HighByteStream;
 
+		// Reused across clusters
+		TVoxelArray<uint32> QuantizedNormals;
+
 		for (int32 ClusterIndex = 0; ClusterIndex < Clusters.Num(); ClusterIndex++)
 		{
 			const FCluster& Cluster = *Clusters[ClusterIndex];
@@ -728,14 +728,22 @@ void CreatePageData(
 			}
 
 			{
+				const int32 NormalBits = EncodingSettings.NormalBits;
+				const uint32 NormalMask = (1u << NormalBits) - 1;
+
+				FVoxelUtilities::SetNumFast(QuantizedNormals, Cluster.Normals.Num());
+				FVoxelUtilities::MakeQuantizedOctahedrons(Cluster.Normals, NormalBits, QuantizedNormals);
+
 				FIntPoint PrevNormal = FIntPoint::ZeroValue;
-				for (const FVoxelOctahedron& PackedNormal : Cluster.Normals)
+				for (const uint32 QuantizedNormal : QuantizedNormals)
 				{
-					const FIntPoint Normal = FIntPoint(PackedNormal.X, PackedNormal.Y);
+					const FIntPoint Normal = FIntPoint(
+						int32(QuantizedNormal & NormalMask),
+						int32((QuantizedNormal >> NormalBits) & NormalMask));
 					FIntPoint NormalDelta = Normal - PrevNormal;
 
-					NormalDelta.X = ShortestWrap(NormalDelta.X, EncodingSettings.NormalBits);
-					NormalDelta.Y = ShortestWrap(NormalDelta.Y, EncodingSettings.NormalBits);
+					NormalDelta.X = ShortestWrap(NormalDelta.X, NormalBits);
+					NormalDelta.Y = ShortestWrap(NormalDelta.Y, NormalBits);
 
 					WriteZigZagDelta(NormalDelta.X, BytesPerNormalComponent);
 					WriteZigZagDelta(NormalDelta.Y, BytesPerNormalComponent);
@@ -220,8 +220,21 @@ public:
 	TVoxelStaticArray<uint32, 4> RefInDword { 0, 0, 0, 0 };
 
 	TVoxelMap<uint32, uint8> MeshIndexToClusterIndex;
+	TVoxelFixedArray<int32, NANITE_MAX_CLUSTER_VERTICES> ClusterIndexToMeshIndex;
 	FVoxelBitWriter ExtendedData;
 
+	// Bounds & error of the group that generated this cluster
+	// Leaves have an error of 0 and their own bounds
+	FSphere3f LODBounds{ ForceInit };
+	float LODError = 0.f;
+
+	// Bounds & error of the group this cluster was simplified in
+	// Clusters without parents are always visited
+	FSphere3f ParentLODBounds{ ForceInit };
+	float ParentLODError = 1e10f;
+
+	bool bIsLeaf = true;
+
 	FCluster();
 
 	FVoxelBox GetBounds() const;
@@ -258,6 +271,15 @@ private:
 	mutable TOptional<FEncodingInfo> CachedEncodingInfo;
 };
 
+FORCEINLINE uint32 PackLODErrors(const float MinLODError, const float MaxParentLODError)
+{
+#if VOXEL_ENGINE_VERSION >= 507
+	return FFloat16(MaxParentLODError).Encoded | (FFloat16(MinLODError).Encoded << 16);
+#else
+	return FFloat16(MinLODError).Encoded | (FFloat16(MaxParentLODError).Encoded << 16);
+#endif
+}
+
 void CreatePageData(
 	TVoxelArrayView<TUniquePtr<FCluster>> Clusters,
 	const FEncodingSettings& EncodingSettings,
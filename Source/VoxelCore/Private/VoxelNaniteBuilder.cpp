@@ -26,7 +26,19 @@ TUniquePtr<FStaticMeshRenderData> FVoxelNaniteBuilder::CreateRenderData()
 
 	Nanite::FResources Resources;
 
-	TVoxelArray<TUniquePtr<FCluster>> AllClusters = CreateClusters();
+	TVoxelArray<TUniquePtr<FCluster>> AllClusters = CreateClusters(Mesh.Indices);
+
+	for (const TUniquePtr<FCluster>& Cluster : AllClusters)
+	{
+		const FVoxelBox ClusterBounds = Cluster->GetBounds();
+		Cluster->LODBounds = FSphere3f(FVector3f(ClusterBounds.GetCenter()), ClusterBounds.Size().Length());
+		Cluster->ParentLODBounds = Cluster->LODBounds;
+	}
+
+	if (bBuildLODs)
+	{
+		BuildLODs(AllClusters, Bounds);
+	}
 
 	FEncodingSettings EncodingSettings;
 	EncodingSettings.PositionPrecision = PositionPrecision;
@@ -158,7 +170,7 @@ bool FVoxelNaniteBuilder::Build(FBuildData& BuildData)
 				BuildData.Bounds.GetCenter().Z,
 				BuildData.Bounds.Size().Length());
 
-			HierarchyNode.Misc0[Index].MinLODError_MaxParentLODError = FFloat16(1e10f).Encoded | (FFloat16(-1).Encoded << 16);
+			HierarchyNode.Misc0[Index].MinLODError_MaxParentLODError = PackLODErrors(-1.f, 1e10f);
 			HierarchyNode.Misc0[Index].BoxBoundsCenter = FVector3f(BuildData.Bounds.GetCenter());
 			HierarchyNode.Misc1[Index].BoxBoundsExtent = FVector3f(BuildData.Bounds.GetExtent());
 			HierarchyNode.Misc1[Index].ChildStartReference = 0xFFFFFFFF;
@@ -244,8 +256,9 @@ bool FVoxelNaniteBuilder::Build(FBuildData& BuildData)
 			const FClusterHierarchyNode& LeafNodeData = ClusterIndexToLeafNode[ClusterIndexOffset + ClusterIndex];
 			Nanite::FPackedHierarchyNode& HierarchyNode = BuildData.Resources.HierarchyNodes[LeafNodeData.HierarchyNodeIndex];
 
-			const FVoxelBox& ClusterBounds = Cluster.GetBounds();
-			HierarchyNode.LODBounds[LeafNodeData.NodePartIndex] = FVector4f(FVector3f(ClusterBounds.Size()), ClusterBounds.Size().Length());
+			// Parent bounds & error: the cluster is skipped once its parent is precise enough
+			HierarchyNode.LODBounds[LeafNodeData.NodePartIndex] = FVector4f(Cluster.ParentLODBounds.Center, Cluster.ParentLODBounds.W);
+			HierarchyNode.Misc0[LeafNodeData.NodePartIndex].MinLODError_MaxParentLODError = PackLODErrors(Cluster.LODError, Cluster.ParentLODError);
 
 			ensure(HierarchyNode.Misc1[LeafNodeData.NodePartIndex].ChildStartReference == 0xFFFFFFFF);
 			ensure(
@@ -354,7 +367,7 @@ bool FVoxelNaniteBuilder::Build(FBuildData& BuildData)
 				BuildData.Bounds.GetCenter().Z,
 				BuildData.Bounds.Size().Length());
 
-			HierarchyNode.Misc0[Index].MinLODError_MaxParentLODError = FFloat16(-1).Encoded | (FFloat16(1e10f).Encoded << 16);
+			HierarchyNode.Misc0[Index].MinLODError_MaxParentLODError = PackLODErrors(-1.f, 1e10f);
 			HierarchyNode.Misc0[Index].BoxBoundsCenter = FVector3f(BuildData.Bounds.GetCenter());
 			HierarchyNode.Misc1[Index].BoxBoundsExtent = FVector3f(BuildData.Bounds.GetExtent());
 			HierarchyNode.Misc1[Index].ChildStartReference = 0xFFFFFFFF;
@@ -398,10 +411,26 @@ bool FVoxelNaniteBuilder::Build(FBuildData& BuildData)
 	}
 	check(BuildData.NumClusters <= LeafNodes.Num());
 
+	TVoxelArray<const FCluster*> ClusterIndexToCluster;
+	ClusterIndexToCluster.Reserve(BuildData.NumClusters);
+	for (const TVoxelArray<TUniquePtr<FCluster>>& PageClusters : BuildData.Pages)
+	{
+		for (const TUniquePtr<FCluster>& Cluster : PageClusters)
+		{
+			ClusterIndexToCluster.Add(Cluster.Get());
+		}
+	}
+	check(ClusterIndexToCluster.Num() == BuildData.NumClusters);
+
 	for (int32 ClusterIndex = 0; ClusterIndex < BuildData.NumClusters; ClusterIndex++)
 	{
+		const FCluster& Cluster = *ClusterIndexToCluster[ClusterIndex];
 		Nanite::FPackedHierarchyNode& HierarchyNode = BuildData.Resources.HierarchyNodes[LeafNodes[ClusterIndex]];
 
+		// Parent bounds & error: the cluster is skipped once its parent is precise enough
+		HierarchyNode.LODBounds[0] = FVector4f(Cluster.ParentLODBounds.Center, Cluster.ParentLODBounds.W);
+		HierarchyNode.Misc0[0].MinLODError_MaxParentLODError = PackLODErrors(Cluster.LODError, Cluster.ParentLODError);
+
 		ensure(HierarchyNode.Misc1[0].ChildStartReference == 0xFFFFFFFF);
 		ensure(HierarchyNode.Misc2[0].ResourcePageIndex_NumPages_GroupPartSize == 0);
 
@@ -483,11 +512,15 @@ bool FVoxelNaniteBuilder::Build(FBuildData& BuildData)
 
 	for (int32 ClusterIndex = 0; ClusterIndex < BuildData.NumClusters; ClusterIndex++)
 	{
+		const FCluster& Cluster = *ClusterIndexToCluster[ClusterIndex];
+
 		Nanite::FPackedHierarchyNode PackedHierarchyNode;
 		FMemory::Memzero(PackedHierarchyNode);
 
+		PackedHierarchyNode.LODBounds[0] = FVector4f(Cluster.ParentLODBounds.Center, Cluster.ParentLODBounds.W);
+
 		PackedHierarchyNode.Misc0[0].BoxBoundsCenter = FVector3f(BuildData.Bounds.GetCenter());
-		PackedHierarchyNode.Misc0[0].MinLODError_MaxParentLODError = FFloat16(-1).Encoded | (FFloat16(1e10f).Encoded << 16);
+		PackedHierarchyNode.Misc0[0].MinLODError_MaxParentLODError = PackLODErrors(Cluster.LODError, Cluster.ParentLODError);
 
 		PackedHierarchyNode.Misc1[0].BoxBoundsExtent = FVector3f(BuildData.Bounds.GetExtent());
 		PackedHierarchyNode.Misc1[0].ChildStartReference = 0xFFFFFFFFu;
@@ -507,7 +540,7 @@ bool FVoxelNaniteBuilder::Build(FBuildData& BuildData)
 }
 #endif
 
-TVoxelArray<TUniquePtr<Voxel::Nanite::FCluster>> FVoxelNaniteBuilder::CreateClusters() const
+TVoxelArray<TUniquePtr<Voxel::Nanite::FCluster>> FVoxelNaniteBuilder::CreateClusters(const TConstVoxelArrayView<int32> Indices) const
 {
 	VOXEL_FUNCTION_COUNTER();
 
@@ -582,7 +615,7 @@ TVoxelArray<TUniquePtr<Voxel::Nanite::FCluster>> FVoxelNaniteBuilder::CreateClus
 
 	const uint8 IndexSize = FMath::FloorLog2(Mesh.Positions.Num()) + 1;
 	int32 NewTriangleIndex = 0;
-	for (int32 TriangleIndex = 0; TriangleIndex < Mesh.Indices.Num() / 3; TriangleIndex++)
+	for (int32 TriangleIndex = 0; TriangleIndex < Indices.Num() / 3; TriangleIndex++)
 	{
 		if (AllClusters.Num() == 0 ||
 			AllClusters.Last()->NumTriangles() == NANITE_MAX_CLUSTER_TRIANGLES ||
@@ -626,13 +659,14 @@ TVoxelArray<TUniquePtr<Voxel::Nanite::FCluster>> FVoxelNaniteBuilder::CreateClus
 				}
 
 				Cluster.MeshIndexToClusterIndex.FindOrAdd(MeshVertexIndex) = NewClusterVertex;
+				Cluster.ClusterIndexToMeshIndex.Add(MeshVertexIndex);
 				Cluster.NewInDword[DWordBucket]++;
 				Cluster.ExtendedData.Append(MeshVertexIndex, IndexSize);
 			};
 
-			AddVertex(Mesh.Indices[3 * TriangleIndex + 0]);
-			AddVertex(Mesh.Indices[3 * TriangleIndex + 1]);
-			AddVertex(Mesh.Indices[3 * TriangleIndex + 2]);
+			AddVertex(Indices[3 * TriangleIndex + 0]);
+			AddVertex(Indices[3 * TriangleIndex + 1]);
+			AddVertex(Indices[3 * TriangleIndex + 2]);
 
 			Cluster.StripBitmaskDWords[3 * DWordBucket + 0] |= 1 << DWordBitInBucket;
 			continue;
@@ -647,9 +681,9 @@ TVoxelArray<TUniquePtr<Voxel::Nanite::FCluster>> FVoxelNaniteBuilder::CreateClus
 			return FVertex(MeshVertexIndex, true);
 		};
 
-		FVertex VertexA = MakeVertex(Mesh.Indices[3 * TriangleIndex + 0]);
-		FVertex VertexB = MakeVertex(Mesh.Indices[3 * TriangleIndex + 1]);
-		FVertex VertexC = MakeVertex(Mesh.Indices[3 * TriangleIndex + 2]);
+		FVertex VertexA = MakeVertex(Indices[3 * TriangleIndex + 0]);
+		FVertex VertexB = MakeVertex(Indices[3 * TriangleIndex + 1]);
+		FVertex VertexC = MakeVertex(Indices[3 * TriangleIndex + 2]);
 
 		RotateTriangle(VertexA, VertexB, VertexC);
 
@@ -682,6 +716,7 @@ TVoxelArray<TUniquePtr<Voxel::Nanite::FCluster>> FVoxelNaniteBuilder::CreateClus
 			}
 
 			Cluster.MeshIndexToClusterIndex.FindOrAdd(Vertex.MeshVertex) = NewClusterVertex;
+			Cluster.ClusterIndexToMeshIndex.Add(Vertex.MeshVertex);
 			Cluster.NewInDword[DWordBucket]++;
 			Cluster.ExtendedData.Append(Vertex.MeshVertex, IndexSize);
 		};
@@ -737,4 +772,593 @@ TVoxelArray<TVoxelArray<TUniquePtr<Voxel::Nanite::FCluster>>> FVoxelNaniteBuilde
 		check(ClusterIndex == Clusters.Num());
 	}
 	return Pages;
-}
\ No newline at end of file
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+namespace Voxel::Nanite
+{
+struct FQuadric
+{
+	double XX = 0;
+	double XY = 0;
+	double XZ = 0;
+	double XW = 0;
+	double YY = 0;
+	double YZ = 0;
+	double YW = 0;
+	double ZZ = 0;
+	double ZW = 0;
+	double WW = 0;
+	double Weight = 0;
+
+	FQuadric() = default;
+	FQuadric(const FVector3d& A, const FVector3d& B, const FVector3d& C)
+	{
+		FVector3d Normal = (B - A) ^ (C - A);
+		const double Area = Normal.Size() / 2;
+
+		if (!Normal.Normalize())
+		{
+			return;
+		}
+
+		const double W = -(Normal | A);
+
+		XX = Area * Normal.X * Normal.X;
+		XY = Area * Normal.X * Normal.Y;
+		XZ = Area * Normal.X * Normal.Z;
+		XW = Area * Normal.X * W;
+		YY = Area * Normal.Y * Normal.Y;
+		YZ = Area * Normal.Y * Normal.Z;
+		YW = Area * Normal.Y * W;
+		ZZ = Area * Normal.Z * Normal.Z;
+		ZW = Area * Normal.Z * W;
+		WW = Area * W * W;
+		Weight = Area;
+	}
+
+	FORCEINLINE void operator+=(const FQuadric& Other)
+	{
+		XX += Other.XX;
+		XY += Other.XY;
+		XZ += Other.XZ;
+		XW += Other.XW;
+		YY += Other.YY;
+		YZ += Other.YZ;
+		YW += Other.YW;
+		ZZ += Other.ZZ;
+		ZW += Other.ZW;
+		WW += Other.WW;
+		Weight += Other.Weight;
+	}
+
+	// Area-weighted RMS distance to the accumulated planes
+	FORCEINLINE float GetError(const FVector3d& P) const
+	{
+		if (Weight <= 0)
+		{
+			return 0.f;
+		}
+
+		const double Value =
+			XX * P.X * P.X + 2 * XY * P.X * P.Y + 2 * XZ * P.X * P.Z + 2 * XW * P.X +
+			YY * P.Y * P.Y + 2 * YZ * P.Y * P.Z + 2 * YW * P.Y +
+			ZZ * P.Z * P.Z + 2 * ZW * P.Z +
+			WW;
+
+		return FMath::Sqrt(FMath::Max(Value, 0.) / Weight);
+	}
+};
+
+// Half-edge collapses only: vertices are collapsed onto existing vertices,
+// so the simplified triangles still reference the original mesh vertices & their attributes
+// Vertices not owned by GroupIndex are locked
+// Returns the error introduced, or -1 if no triangle could be removed
+float SimplifyTriangles(
+	const TConstVoxelArrayView<FVector3f> MeshPositions,
+	const TConstVoxelArrayView<int32> MeshVertexToGroup,
+	const int32 GroupIndex,
+	const int32 TargetNumTriangles,
+	TVoxelArray<int32>& Indices)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Indices.Num() / 3);
+	check(Indices.Num() % 3 == 0);
+
+	TVoxelArray<int32> LocalToMesh;
+	TVoxelArray<int32> Triangles;
+	{
+		TVoxelMap<int32, int32> MeshToLocal;
+		MeshToLocal.Reserve(Indices.Num());
+		LocalToMesh.Reserve(Indices.Num());
+		Triangles.Reserve(Indices.Num());
+
+		for (const int32 MeshIndex : Indices)
+		{
+			Triangles.Add(MeshToLocal.FindOrAdd(MeshIndex, [&](int32& LocalIndex)
+			{
+				LocalIndex = LocalToMesh.Add(MeshIndex);
+			}));
+		}
+	}
+	const int32 NumVertices = LocalToMesh.Num();
+
+	TVoxelArray<FVector3d> Positions;
+	Positions.Reserve(NumVertices);
+	for (const int32 MeshIndex : LocalToMesh)
+	{
+		Positions.Add(FVector3d(MeshPositions[MeshIndex]));
+	}
+
+	TVoxelArray<FQuadric> Quadrics;
+	Quadrics.SetNum(NumVertices);
+	for (int32 Index = 0; Index < Triangles.Num(); Index += 3)
+	{
+		const FQuadric Quadric(
+			Positions[Triangles[Index + 0]],
+			Positions[Triangles[Index + 1]],
+			Positions[Triangles[Index + 2]]);
+
+		Quadrics[Triangles[Index + 0]] += Quadric;
+		Quadrics[Triangles[Index + 1]] += Quadric;
+		Quadrics[Triangles[Index + 2]] += Quadric;
+	}
+
+	TVoxelArray<bool> IsLocked;
+	IsLocked.Reserve(NumVertices);
+	for (const int32 MeshIndex : LocalToMesh)
+	{
+		// Vertices shared with other groups must not move, otherwise LODs would crack
+		IsLocked.Add(MeshVertexToGroup[MeshIndex] != GroupIndex);
+	}
+
+	// Lock open & non-manifold edges: chunk borders need to match their neighbors
+	{
+		TVoxelMap<uint64, int32> EdgeToCount;
+		EdgeToCount.Reserve(Triangles.Num());
+
+		for (int32 Index = 0; Index < Triangles.Num(); Index += 3)
+		{
+			for (int32 Corner = 0; Corner < 3; Corner++)
+			{
+				const uint32 A = Triangles[Index + Corner];
+				const uint32 B = Triangles[Index + (Corner + 1) % 3];
+
+				EdgeToCount.FindOrAdd(uint64(FMath::Min(A, B)) | (uint64(FMath::Max(A, B)) << 32))++;
+			}
+		}
+
+		for (const auto& It : EdgeToCount)
+		{
+			if (It.Value == 2)
+			{
+				continue;
+			}
+
+			IsLocked[uint32(It.Key)] = true;
+			IsLocked[uint32(It.Key >> 32)] = true;
+		}
+	}
+
+	struct FCollapse
+	{
+		int32 From = 0;
+		int32 To = 0;
+		float Error = 0.f;
+	};
+
+	TVoxelArray<TVoxelInlineArray<int32, 8>> VertexToTriangles;
+	VertexToTriangles.SetNum(NumVertices);
+
+	TVoxelArray<FCollapse> Collapses;
+	TVoxelArray<bool> IsTouched;
+
+	const auto GetNeighbors = [&](const int32 Vertex, TVoxelInlineArray<int32, 16>& OutNeighbors)
+	{
+		for (const int32 Triangle : VertexToTriangles[Vertex])
+		{
+			for (int32 Corner = 0; Corner < 3; Corner++)
+			{
+				const int32 Neighbor = Triangles[3 * Triangle + Corner];
+				if (Neighbor != Vertex)
+				{
+					OutNeighbors.AddUnique(Neighbor);
+				}
+			}
+		}
+	};
+
+	const int32 NumInitialTriangles = Triangles.Num() / 3;
+	int32 NumTriangles = NumInitialTriangles;
+	float MaxError = 0.f;
+
+	// Each pass collapses an independent set of edges, cheapest first
+	while (NumTriangles > TargetNumTriangles)
+	{
+		for (TVoxelInlineArray<int32, 8>& VertexTriangles : VertexToTriangles)
+		{
+			VertexTriangles.Reset();
+		}
+
+		for (int32 Triangle = 0; Triangle < Triangles.Num() / 3; Triangle++)
+		{
+			if (Triangles[3 * Triangle] == -1)
+			{
+				continue;
+			}
+
+			VertexToTriangles[Triangles[3 * Triangle + 0]].Add(Triangle);
+			VertexToTriangles[Triangles[3 * Triangle + 1]].Add(Triangle);
+			VertexToTriangles[Triangles[3 * Triangle + 2]].Add(Triangle);
+		}
+
+		Collapses.Reset();
+
+		for (int32 From = 0; From < NumVertices; From++)
+		{
+			if (IsLocked[From])
+			{
+				continue;
+			}
+
+			FCollapse BestCollapse{ From, -1, MAX_flt };
+			for (const int32 Triangle : VertexToTriangles[From])
+			{
+				for (int32 Corner = 0; Corner < 3; Corner++)
+				{
+					const int32 To = Triangles[3 * Triangle + Corner];
+					if (To == From)
+					{
+						continue;
+					}
+
+					FQuadric Quadric = Quadrics[From];
+					Quadric += Quadrics[To];
+
+					const float Error = Quadric.GetError(Positions[To]);
+					if (Error < BestCollapse.Error)
+					{
+						BestCollapse = FCollapse{ From, To, Error };
+					}
+				}
+			}
+
+			if (BestCollapse.To != -1)
+			{
+				Collapses.Add(BestCollapse);
+			}
+		}
+
+		Collapses.Sort([](const FCollapse& A, const FCollapse& B)
+		{
+			return A.Error < B.Error;
+		});
+
+		IsTouched.Reset();
+		IsTouched.SetNumZeroed(NumVertices);
+
+		bool bAnyCollapse = false;
+		for (const FCollapse& Collapse : Collapses)
+		{
+			if (NumTriangles <= TargetNumTriangles)
+			{
+				break;
+			}
+
+			if (IsTouched[Collapse.From] ||
+				IsTouched[Collapse.To])
+			{
+				continue;
+			}
+
+			bool bIsValid = true;
+			int32 NumSharedTriangles = 0;
+			for (const int32 Triangle : VertexToTriangles[Collapse.From])
+			{
+				const int32* Corners = &Triangles[3 * Triangle];
+				if (Corners[0] == Collapse.To ||
+					Corners[1] == Collapse.To ||
+					Corners[2] == Collapse.To)
+				{
+					NumSharedTriangles++;
+					continue;
+				}
+
+				const auto GetPosition = [&](const int32 Vertex) -> const FVector3d&
+				{
+					return Positions[Vertex == Collapse.From ? Collapse.To : Vertex];
+				};
+
+				const FVector3d OldNormal = (Positions[Corners[1]] - Positions[Corners[0]]) ^ (Positions[Corners[2]] - Positions[Corners[0]]);
+				const FVector3d NewNormal = (GetPosition(Corners[1]) - GetPosition(Corners[0])) ^ (GetPosition(Corners[2]) - GetPosition(Corners[0]));
+
+				// Don't flip triangles
+				if ((OldNormal | NewNormal) <= 0)
+				{
+					bIsValid = false;
+					break;
+				}
+			}
+
+			if (!bIsValid)
+			{
+				continue;
+			}
+
+			TVoxelInlineArray<int32, 16> FromNeighbors;
+			TVoxelInlineArray<int32, 16> ToNeighbors;
+			GetNeighbors(Collapse.From, FromNeighbors);
+			GetNeighbors(Collapse.To, ToNeighbors);
+
+			// Link condition: the only common neighbors should be the ones of the collapsed triangles,
+			// otherwise the collapse would create non-manifold geometry
+			int32 NumCommonNeighbors = 0;
+			for (const int32 Neighbor : FromNeighbors)
+			{
+				if (ToNeighbors.Contains(Neighbor))
+				{
+					NumCommonNeighbors++;
+				}
+			}
+
+			if (NumCommonNeighbors != NumSharedTriangles)
+			{
+				continue;
+			}
+
+			for (const int32 Triangle : VertexToTriangles[Collapse.From])
+			{
+				int32* Corners = &Triangles[3 * Triangle];
+				if (Corners[0] == Collapse.To ||
+					Corners[1] == Collapse.To ||
+					Corners[2] == Collapse.To)
+				{
+					Corners[0] = -1;
+					Corners[1] = -1;
+					Corners[2] = -1;
+					NumTriangles--;
+					continue;
+				}
+
+				for (int32 Corner = 0; Corner < 3; Corner++)
+				{
+					if (Corners[Corner] == Collapse.From)
+					{
+						Corners[Corner] = Collapse.To;
+					}
+				}
+			}
+
+			Quadrics[Collapse.To] += Quadrics[Collapse.From];
+			MaxError = FMath::Max(MaxError, Collapse.Error);
+
+			IsTouched[Collapse.From] = true;
+			IsTouched[Collapse.To] = true;
+			for (const int32 Neighbor : FromNeighbors)
+			{
+				IsTouched[Neighbor] = true;
+			}
+
+			bAnyCollapse = true;
+		}
+
+		if (!bAnyCollapse)
+		{
+			break;
+		}
+	}
+
+	if (NumTriangles == NumInitialTriangles)
+	{
+		return -1.f;
+	}
+
+	Indices.Reset();
+	for (const int32 Index : Triangles)
+	{
+		if (Index != -1)
+		{
+			Indices.Add(LocalToMesh[Index]);
+		}
+	}
+	check(Indices.Num() == 3 * NumTriangles);
+
+	return MaxError;
+}
+}
+
+void FVoxelNaniteBuilder::BuildLODs(
+	TVoxelArray<TUniquePtr<FCluster>>& Clusters,
+	const FVoxelBox& Bounds) const
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	using namespace Voxel::Nanite;
+
+	// Similar to what the engine Nanite builder does:
+	// group neighboring clusters, simplify each group to half its triangles and split it back into clusters
+	// Vertices shared between groups are locked, so any cut through the DAG is crack-free
+	constexpr int32 GroupSize = 4;
+	constexpr int32 MaxLevels = 32;
+
+	struct FGroup
+	{
+		TVoxelInlineArray<FCluster*, 2 * GroupSize> Children;
+		TVoxelArray<TUniquePtr<FCluster>> NewClusters;
+		FSphere3f LODBounds{ ForceInit };
+		float LODError = 0.f;
+	};
+
+	TVoxelArray<int32> MeshVertexToGroup;
+	FVoxelUtilities::SetNumFast(MeshVertexToGroup, Mesh.Positions.Num());
+
+	TVoxelArray<FCluster*> LevelClusters;
+	LevelClusters.Reserve(Clusters.Num());
+	for (const TUniquePtr<FCluster>& Cluster : Clusters)
+	{
+		LevelClusters.Add(Cluster.Get());
+	}
+
+	for (int32 Level = 0; Level < MaxLevels && LevelClusters.Num() > 1; Level++)
+	{
+		VOXEL_SCOPE_COUNTER_FORMAT("Level %d NumClusters=%d", Level, LevelClusters.Num());
+
+		// Sort clusters along a Morton curve so that consecutive clusters are close to each other
+		{
+			VOXEL_SCOPE_COUNTER("Sort");
+
+			const double Scale = 1023. / FMath::Max(Bounds.Size().GetMax(), 1.);
+			const auto Quantize = [&](const double Value)
+			{
+				return uint32(FMath::Clamp(FMath::FloorToInt32(Value * Scale), 0, 1023));
+			};
+
+			TVoxelArray<TPair<uint32, FCluster*>> CodeToCluster;
+			CodeToCluster.Reserve(LevelClusters.Num());
+			for (FCluster* Cluster : LevelClusters)
+			{
+				const FVector Position = Cluster->GetBounds().GetCenter() - Bounds.Min;
+
+				const uint32 Code =
+					(FMath::MortonCode3(Quantize(Position.X)) << 0) |
+					(FMath::MortonCode3(Quantize(Position.Y)) << 1) |
+					(FMath::MortonCode3(Quantize(Position.Z)) << 2);
+
+				CodeToCluster.Add({ Code, Cluster });
+			}
+
+			CodeToCluster.Sort([](const TPair<uint32, FCluster*>& A, const TPair<uint32, FCluster*>& B)
+			{
+				return A.Key < B.Key;
+			});
+
+			for (int32 Index = 0; Index < CodeToCluster.Num(); Index++)
+			{
+				LevelClusters[Index] = CodeToCluster[Index].Value;
+			}
+		}
+
+		// The last group takes the remaining clusters
+		const int32 NumGroups = FMath::Max(1, LevelClusters.Num() / GroupSize);
+
+		TVoxelArray<FGroup> Groups;
+		Groups.SetNum(NumGroups);
+		for (int32 Index = 0; Index < LevelClusters.Num(); Index++)
+		{
+			Groups[FMath::Min(Index / GroupSize, NumGroups - 1)].Children.Add(LevelClusters[Index]);
+		}
+
+		{
+			VOXEL_SCOPE_COUNTER("Find shared vertices");
+
+			FVoxelUtilities::SetAll(MeshVertexToGroup, -1);
+
+			for (int32 GroupIndex = 0; GroupIndex < Groups.Num(); GroupIndex++)
+			{
+				for (const FCluster* Cluster : Groups[GroupIndex].Children)
+				{
+					for (const int32 MeshIndex : Cluster->ClusterIndexToMeshIndex)
+					{
+						int32& VertexGroup = MeshVertexToGroup[MeshIndex];
+						if (VertexGroup == -1)
+						{
+							VertexGroup = GroupIndex;
+						}
+						else if (VertexGroup != GroupIndex)
+						{
+							VertexGroup = -2;
+						}
+					}
+				}
+			}
+		}
+
+		Voxel::ParallelFor(Groups, [&](FGroup& Group, const int32 GroupIndex)
+		{
+			VOXEL_SCOPE_COUNTER("Simplify group");
+
+			TVoxelArray<int32> Indices;
+			Indices.Reserve(Group.Children.Num() * NANITE_MAX_CLUSTER_TRIANGLES * 3);
+
+			FVector3f Center = FVector3f::ZeroVector;
+			float ChildrenLODError = 0.f;
+			for (const FCluster* Child : Group.Children)
+			{
+				for (const uint8 Index : Child->Indices)
+				{
+					Indices.Add(Child->ClusterIndexToMeshIndex[Index]);
+				}
+
+				Center += Child->LODBounds.Center;
+				ChildrenLODError = FMath::Max(ChildrenLODError, Child->LODError);
+			}
+			Center /= Group.Children.Num();
+
+			// Parent bounds must contain children bounds for the LOD selection to be monotonic
+			float Radius = 0.f;
+			for (const FCluster* Child : Group.Children)
+			{
+				Radius = FMath::Max(Radius, FVector3f::Distance(Center, Child->LODBounds.Center) + Child->LODBounds.W);
+			}
+
+			const float SimplificationError = SimplifyTriangles(
+				Mesh.Positions,
+				MeshVertexToGroup,
+				GroupIndex,
+				Indices.Num() / 6,
+				Indices);
+
+			if (SimplificationError < 0.f)
+			{
+				return;
+			}
+
+			TVoxelArray<TUniquePtr<FCluster>> NewClusters = CreateClusters(Indices);
+			if (NewClusters.Num() >= Group.Children.Num())
+			{
+				return;
+			}
+
+			Group.NewClusters = MoveTemp(NewClusters);
+			Group.LODBounds = FSphere3f(Center, Radius);
+			Group.LODError = FMath::Max(ChildrenLODError, SimplificationError);
+		});
+
+		TVoxelArray<FCluster*> NewLevelClusters;
+		for (FGroup& Group : Groups)
+		{
+			if (Group.NewClusters.Num() == 0)
+			{
+				// Could not simplify this group, retry with the next level groups
+				NewLevelClusters.Append(Group.Children);
+				continue;
+			}
+
+			for (FCluster* Child : Group.Children)
+			{
+				Child->ParentLODBounds = Group.LODBounds;
+				Child->ParentLODError = Group.LODError;
+			}
+
+			for (TUniquePtr<FCluster>& NewCluster : Group.NewClusters)
+			{
+				NewCluster->LODBounds = Group.LODBounds;
+				NewCluster->LODError = Group.LODError;
+				NewCluster->ParentLODBounds = Group.LODBounds;
+				NewCluster->bIsLeaf = false;
+
+				NewLevelClusters.Add(NewCluster.Get());
+				Clusters.Add(MoveTemp(NewCluster));
+			}
+		}
+
+		if (NewLevelClusters.Num() >= LevelClusters.Num())
+		{
+			break;
+		}
+
+		LevelClusters = MoveTemp(NewLevelClusters);
+	}
+}
@@ -13,6 +13,35 @@ VOXEL_CONSOLE_VARIABLE(
 	"voxel.TrackAllPromisesCallstacks",
 	"Enable voxel promise callstack tracking, to debug when promises where created");
 
+VOXEL_CONSOLE_VARIABLE(
+	VOXELCORE_API, float, GVoxelGameTasksTimeBudgetMs, 4.f,
+	"voxel.GameTasks.TimeBudgetMs",
+	"Max time in milliseconds spent running voxel game tasks per frame, across all task contexts. "
+	"Tasks going over budget are deferred to the next frame. 0 to disable.");
+
+VOXEL_CONSOLE_VARIABLE(
+	VOXELCORE_API, bool, GVoxelRunGCSafeTasksOnGameThread, false,
+	"voxel.GameTasks.RunGCSafeTasksOnGameThread",
+	"If true, GC-safe tasks will run on the game thread like game tasks. "
+	"Useful to check whether a continuation moved off the game thread actually requires it.");
+
+VOXEL_CONSOLE_COMMAND(
+	"voxel.GameTasks.DumpStats",
+	"Log stats about deferred voxel game tasks")
+{
+	const FVoxelGameTasksStats Stats = FVoxelTaskContext::GetGameTasksStats();
+
+	LOG_VOXEL(Log, "Budget: %fms", GVoxelGameTasksTimeBudgetMs);
+	LOG_VOXEL(Log, "Last tick: %d tasks processed in %s, %d tasks deferred",
+		Stats.NumTasksProcessed,
+		*FVoxelUtilities::SecondsToString(Stats.TimeSpent),
+		Stats.NumTasksDeferred);
+	LOG_VOXEL(Log, "Ticks over budget: %lld/%lld",
+		Stats.NumTicksOverBudget,
+		Stats.NumTicks);
+	LOG_VOXEL(Log, "Max tasks deferred: %d", Stats.MaxTasksDeferred);
+}
+
 bool GVoxelTrackAllTaskCallstacks = false;
 
 VOXEL_RUN_ON_STARTUP_GAME()
@@ -37,6 +66,7 @@ FVoxelTaskContext* GVoxelGlobalTaskContext = nullptr;
 FVoxelTaskContext* GVoxelSynchronousTaskContext = nullptr;
 
 DEFINE_VOXEL_INSTANCE_COUNTER(FVoxelTaskContext);
+DEFINE_VOXEL_COUNTER(STAT_VoxelNumDeferredGameTasks);
 
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -50,6 +80,9 @@ struct FVoxelTaskContextArray
 };
 FVoxelTaskContextArray* GVoxelTaskContextArray = new FVoxelTaskContextArray();
 
+// Across all contexts, to not lock every context each tick
+FVoxelCounter32 GVoxelNumQueuedGameTasks;
+
 class FVoxelTaskContextTicker : public FVoxelSingleton
 {
 public:
@@ -63,51 +96,105 @@ public:
 
 		Voxel::OnFlushGameTasks.AddLambda([this](bool& bAnyTaskProcessed)
 		{
-			ProcessGameTasks(bAnyTaskProcessed);
+			// Flushes ignore the time budgets
+			ProcessGameTasks(MAX_dbl, true, bAnyTaskProcessed);
 		});
 	}
 	virtual void Tick() override
 	{
 		VOXEL_FUNCTION_COUNTER();
 
-		bool bAnyTaskProcessed;
-		ProcessGameTasks(bAnyTaskProcessed);
+		const double StartTime = FPlatformTime::Seconds();
+		const double EndTime =
+			GVoxelGameTasksTimeBudgetMs > 0.f
+			? StartTime + GVoxelGameTasksTimeBudgetMs / 1000.
+			: MAX_dbl;
+
+		bool bAnyTaskProcessed = false;
+		const int32 NumTasksProcessed = ProcessGameTasks(EndTime, false, bAnyTaskProcessed);
+		const int32 NumTasksDeferred = GVoxelNumQueuedGameTasks.Get();
+
+		INC_VOXEL_COUNTER_BY(STAT_VoxelNumDeferredGameTasks, NumTasksDeferred - Stats.NumTasksDeferred);
+
+		Stats.NumTasksProcessed = NumTasksProcessed;
+		Stats.NumTasksDeferred = NumTasksDeferred;
+		Stats.TimeSpent = FPlatformTime::Seconds() - StartTime;
+		Stats.NumTicks++;
+		Stats.MaxTasksDeferred = FMath::Max(Stats.MaxTasksDeferred, NumTasksDeferred);
+
+		if (NumTasksDeferred > 0)
+		{
+			Stats.NumTicksOverBudget++;
+		}
 	}
 	//~ End FVoxelSingleton Interface
 
-	void ProcessGameTasks(bool& bAnyTaskProcessed)
-	{
-		VOXEL_FUNCTION_COUNTER();
+public:
+	FVoxelGameTasksStats Stats;
 
+	TVoxelArray<FVoxelTaskContextWeakRef> GetContexts() const
+	{
 		TVoxelArray<FVoxelTaskContextWeakRef> WeakRefs;
+
+		VOXEL_SCOPE_READ_LOCK(GVoxelTaskContextArray->CriticalSection);
+
 		WeakRefs.Reserve(GVoxelTaskContextArray->Contexts_RequiresLock.Num());
+
+		for (FVoxelTaskContext* Context : GVoxelTaskContextArray->Contexts_RequiresLock)
 		{
-			VOXEL_SCOPE_READ_LOCK(GVoxelTaskContextArray->CriticalSection);
+			WeakRefs.Emplace(*Context);
+		}
 
-			for (FVoxelTaskContext* Context : GVoxelTaskContextArray->Contexts_RequiresLock)
-			{
-				WeakRefs.Emplace(*Context);
-			}
+		return WeakRefs;
+	}
+	int32 ProcessGameTasks(
+		const double EndTime,
+		const bool bIgnoreContextBudgets,
+		bool& bAnyTaskProcessed)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		const TVoxelArray<FVoxelTaskContextWeakRef> WeakRefs = GetContexts();
+		if (WeakRefs.Num() == 0)
+		{
+			return 0;
 		}
 
-		for (const FVoxelTaskContextWeakRef& WeakRef : WeakRefs)
+		// Round-robin: start with the context after the one that ran out of budget last tick,
+		// so that a context with a lot of game tasks cannot starve the others
+		const int32 StartIndex = NextContextIndex % WeakRefs.Num();
+
+		int32 NumTasksProcessed = 0;
+		for (int32 Offset = 0; Offset < WeakRefs.Num(); Offset++)
 		{
-			TUniquePtr<FVoxelTaskContextStrongRef> StrongRef = WeakRef.Pin();
+			const int32 Index = (StartIndex + Offset) % WeakRefs.Num();
+
+			TUniquePtr<FVoxelTaskContextStrongRef> StrongRef = WeakRefs[Index].Pin();
 			if (!StrongRef)
 			{
 				continue;
 			}
 
-			TVoxelChunkedArray<TVoxelUniqueFunction<void()>> GameTasksToDelete;
+			FVoxelTaskContext::FGameTaskArray GameTasksToDelete;
 
-			StrongRef->Context.ProcessGameTasks(bAnyTaskProcessed, GameTasksToDelete);
+			NumTasksProcessed += StrongRef->Context.ProcessGameTasks(EndTime, bIgnoreContextBudgets, bAnyTaskProcessed, GameTasksToDelete);
 			StrongRef.Reset();
 
 			// Delete the tasks AFTER the strong ref is released, as one of the task could be the last thing keeping the task context alive
 			// (in which case we get into an infinite loop if we are still holding a strong ref to it)
 			GameTasksToDelete.Empty();
+
+			if (FPlatformTime::Seconds() >= EndTime)
+			{
+				NextContextIndex = Index + 1;
+				break;
+			}
 		}
+		return NumTasksProcessed;
 	}
+
+private:
+	int32 NextContextIndex = 0;
 };
 FVoxelTaskContextTicker* GVoxelTaskContextTicker = new FVoxelTaskContextTicker();
 
@@ -270,8 +357,9 @@ FVoxelTaskContext::~FVoxelTaskContext()
 ///////////////////////////////////////////////////////////////////////////////
 
 void FVoxelTaskContext::Dispatch(
-	const EVoxelFutureThread Thread,
-	TVoxelUniqueFunction<void()> Lambda)
+	EVoxelFutureThread Thread,
+	FTaskLambda Lambda,
+	const float GameTaskCostMs)
 {
 #if VOXEL_DEBUG
 	Lambda = [this, Lambda = MoveTemp(Lambda)]
@@ -313,6 +401,16 @@ void FVoxelTaskContext::Dispatch(
 		};
 	}
 
+	// GC-safe tasks are async tasks taking a GC guard while they run, see LaunchTask
+	// Don't wrap Lambda here: it would no longer fit in FTaskLambda inline storage
+	const bool bGCSafe = Thread == EVoxelFutureThread::GCSafeThread;
+	if (bGCSafe)
+	{
+		Thread = GVoxelRunGCSafeTasksOnGameThread
+			? EVoxelFutureThread::GameThread
+			: EVoxelFutureThread::AsyncThread;
+	}
+
 	switch (Thread)
 	{
 	default: VOXEL_ASSUME(false);
@@ -327,7 +425,12 @@ void FVoxelTaskContext::Dispatch(
 		NumPendingTasks.Increment();
 
 		VOXEL_SCOPE_LOCK(GameTasksCriticalSection);
-		GameTasks_RequiresLock.Add(MoveTemp(Lambda));
+		GameTasks_RequiresLock.Add(FGameTask
+		{
+			MoveTemp(Lambda),
+			GameTaskCostMs
+		});
+		GVoxelNumQueuedGameTasks.Increment();
 	}
 	break;
 	case EVoxelFutureThread::RenderThread:
@@ -357,7 +460,16 @@ void FVoxelTaskContext::Dispatch(
 			GVoxelIsWaitingOnFuture)
 		{
 			FVoxelTaskScope Scope(*this);
-			Lambda();
+
+			if (bGCSafe)
+			{
+				FVoxelGCScopeGuard Guard;
+				Lambda();
+			}
+			else
+			{
+				Lambda();
+			}
 			return;
 		}
 
@@ -365,13 +477,21 @@ void FVoxelTaskContext::Dispatch(
 
 		if (NumLaunchedTasks.Get() < MaxBackgroundTasks)
 		{
-			LaunchTask(MoveTemp(Lambda));
+			LaunchTask(MoveTemp(Lambda), bGCSafe);
 			return;
 		}
 
 		{
 			VOXEL_SCOPE_LOCK(AsyncTasksCriticalSection);
-			AsyncTasks_RequiresLock.Add(MoveTemp(Lambda));
+
+			if (bGCSafe)
+			{
+				GCSafeTasks_RequiresLock.Add(MoveTemp(Lambda));
+			}
+			else
+			{
+				AsyncTasks_RequiresLock.Add(MoveTemp(Lambda));
+			}
 		}
 
 		if (NumLaunchedTasks.Get() < MaxBackgroundTasks)
@@ -392,15 +512,20 @@ void FVoxelTaskContext::CancelTasks()
 	{
 		VOXEL_SCOPE_LOCK(GameTasksCriticalSection);
 
-		NumPendingTasks.Subtract(GameTasks_RequiresLock.Num());
+		const int32 NumQueuedGameTasks = GetNumQueuedGameTasks_RequiresLock();
+		NumPendingTasks.Subtract(NumQueuedGameTasks);
+		GVoxelNumQueuedGameTasks.Subtract(NumQueuedGameTasks);
 		GameTasks_RequiresLock.Empty();
+		CurrentGameTasks_RequiresLock.Reset();
 	}
 
 	{
 		VOXEL_SCOPE_LOCK(AsyncTasksCriticalSection);
 
 		NumPendingTasks.Subtract(AsyncTasks_RequiresLock.Num());
+		NumPendingTasks.Subtract(GCSafeTasks_RequiresLock.Num());
 		AsyncTasks_RequiresLock.Empty();
+		GCSafeTasks_RequiresLock.Empty();
 	}
 }
 
@@ -409,8 +534,9 @@ void FVoxelTaskContext::DumpToLog() const
 	VOXEL_FUNCTION_COUNTER();
 	VOXEL_SCOPE_LOCK(CriticalSection);
 
-	LOG_VOXEL(Log, "Queued game tasks: %d", GameTasks_RequiresLock.Num());
+	LOG_VOXEL(Log, "Queued game tasks: %d", GetNumQueuedGameTasks());
 	LOG_VOXEL(Log, "Queued async tasks: %d", AsyncTasks_RequiresLock.Num());
+	LOG_VOXEL(Log, "Queued GC-safe tasks: %d", GCSafeTasks_RequiresLock.Num());
 	LOG_VOXEL(Log, "Launched async tasks: %d", NumLaunchedTasks.Get());
 
 	LOG_VOXEL(Log, "Num promises: %d", GetNumPromises());
@@ -538,27 +664,50 @@ void FVoxelTaskContext::LaunchTasks()
 	VOXEL_SCOPE_LOCK(AsyncTasksCriticalSection);
 	checkStatic(2 * FTaskArray::NumPerChunk == MaxLaunchedTasks);
 
+	// Alternate between both queues so that neither starves the other
 	while (
-		AsyncTasks_RequiresLock.Num() > 0 &&
+		(AsyncTasks_RequiresLock.Num() > 0 || GCSafeTasks_RequiresLock.Num() > 0) &&
 		NumLaunchedTasks.Get() < MaxBackgroundTasks)
 	{
-		for (TVoxelUniqueFunction<void()>& Task : AsyncTasks_RequiresLock.PopFirstChunk())
+		if (AsyncTasks_RequiresLock.Num() > 0)
+		{
+			for (FTaskLambda& Task : AsyncTasks_RequiresLock.PopFirstChunk())
+			{
+				LaunchTask(MoveTemp(Task), false);
+			}
+		}
+
+		if (GCSafeTasks_RequiresLock.Num() > 0 &&
+			NumLaunchedTasks.Get() < MaxBackgroundTasks)
 		{
-			LaunchTask(MoveTemp(Task));
+			for (FTaskLambda& Task : GCSafeTasks_RequiresLock.PopFirstChunk())
+			{
+				LaunchTask(MoveTemp(Task), true);
+			}
 		}
 	}
 }
 
-void FVoxelTaskContext::LaunchTask(TVoxelUniqueFunction<void()> Task)
+void FVoxelTaskContext::LaunchTask(FTaskLambda Task, const bool bGCSafe)
 {
 	NumLaunchedTasks.Increment();
 
-	auto Lambda = [this, Task = MoveTemp(Task)]
+	auto Lambda = [this, Task = MoveTemp(Task), bGCSafe]
 	{
 		if (!ShouldCancelTasks.Get())
 		{
 			FVoxelTaskScope Scope(*this);
-			Task();
+
+			if (bGCSafe)
+			{
+				// Taken per task so that GC is only blocked while tasks are running, not while they are queued
+				FVoxelGCScopeGuard Guard;
+				Task();
+			}
+			else
+			{
+				Task();
+			}
 		}
 
 		if (NumLaunchedTasks.Decrement_ReturnNew() < MaxBackgroundTasks)
@@ -589,9 +738,64 @@ void FVoxelTaskContext::LaunchTask(TVoxelUniqueFunction<void()> Task)
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
-void FVoxelTaskContext::ProcessGameTasks(
+int32 FVoxelTaskContext::GetNumQueuedGameTasks() const
+{
+	VOXEL_SCOPE_LOCK(GameTasksCriticalSection);
+	return GetNumQueuedGameTasks_RequiresLock();
+}
+
+FVoxelGameTasksStats FVoxelTaskContext::GetGameTasksStats()
+{
+	check(IsInGameThread());
+	return GVoxelTaskContextTicker->Stats;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+int32 FVoxelTaskContext::GetNumQueuedGameTasks_RequiresLock() const
+{
+	checkVoxelSlow(GameTasksCriticalSection.IsLocked());
+
+	int32 Result = GameTasks_RequiresLock.Num();
+	if (CurrentGameTasks_RequiresLock)
+	{
+		Result += CurrentGameTasks_RequiresLock->Num() - CurrentGameTaskIndex_RequiresLock;
+	}
+	return Result;
+}
+
+FVoxelTaskContext::FGameTask* FVoxelTaskContext::PeekGameTask_RequiresLock()
+{
+	checkVoxelSlow(GameTasksCriticalSection.IsLocked());
+
+	if (CurrentGameTasks_RequiresLock &&
+		CurrentGameTaskIndex_RequiresLock == CurrentGameTasks_RequiresLock->Num())
+	{
+		CurrentGameTasks_RequiresLock.Reset();
+	}
+
+	if (!CurrentGameTasks_RequiresLock)
+	{
+		if (GameTasks_RequiresLock.Num() == 0)
+		{
+			return nullptr;
+		}
+
+		// FChunkView isn't movable, construct it in place
+		CurrentGameTasks_RequiresLock = TUniquePtr<FGameTaskArray::FChunkView>(new FGameTaskArray::FChunkView(GameTasks_RequiresLock.PopFirstChunk()));
+		CurrentGameTaskIndex_RequiresLock = 0;
+	}
+
+	return &(*CurrentGameTasks_RequiresLock)[CurrentGameTaskIndex_RequiresLock];
+}
+
+int32 FVoxelTaskContext::ProcessGameTasks(
+	const double EndTime,
+	const bool bIgnoreContextBudget,
 	bool& bAnyTaskProcessed,
-	TVoxelChunkedArray<TVoxelUniqueFunction<void()>>& OutGameTasksToDelete)
+	FGameTaskArray& OutGameTasksToDelete)
 {
 	VOXEL_FUNCTION_COUNTER();
 	check(IsInGameThread());
@@ -604,30 +808,62 @@ void FVoxelTaskContext::ProcessGameTasks(
 		bIsProcessingGameTasks = false;
 	};
 
-	TVoxelChunkedArray<TVoxelUniqueFunction<void()>> GameTasks;
+	double ContextEndTime = EndTime;
+	if (!bIgnoreContextBudget &&
+		GameTasksTimeBudgetMs > 0.f)
 	{
-		VOXEL_SCOPE_LOCK(GameTasksCriticalSection);
-		GameTasks = MoveTemp(GameTasks_RequiresLock);
+		ContextEndTime = FMath::Min(ContextEndTime, FPlatformTime::Seconds() + GameTasksTimeBudgetMs / 1000.);
 	}
 
-	if (GameTasks.Num() == 0)
+	// Tasks dispatched by the tasks we run are processed next time,
+	// otherwise a task re-dispatching itself would never let us return
+	int32 MaxNumTasks;
 	{
-		return;
+		VOXEL_SCOPE_LOCK(GameTasksCriticalSection);
+		MaxNumTasks = GetNumQueuedGameTasks_RequiresLock();
 	}
-	bAnyTaskProcessed = true;
 
 	FVoxelTaskScope Scope(*this);
 
-	for (const TVoxelUniqueFunction<void()>& Task : GameTasks)
+	int32 NumProcessed = 0;
+	while (NumProcessed < MaxNumTasks)
 	{
+		FGameTask Task;
+		{
+			VOXEL_SCOPE_LOCK(GameTasksCriticalSection);
+
+			FGameTask* NextTask = PeekGameTask_RequiresLock();
+			if (!NextTask)
+			{
+				break;
+			}
+
+			// Always process at least one task per tick to make progress
+			if (bAnyTaskProcessed &&
+				ContextEndTime != MAX_dbl &&
+				FPlatformTime::Seconds() + NextTask->CostMs / 1000. > ContextEndTime)
+			{
+				break;
+			}
+
+			Task = MoveTemp(*NextTask);
+			CurrentGameTaskIndex_RequiresLock++;
+			GVoxelNumQueuedGameTasks.Decrement();
+		}
+
+		bAnyTaskProcessed = true;
+		NumProcessed++;
+
 		if (!ShouldCancelTasks.Get())
 		{
-			Task();
+			Task.Lambda();
 		}
 		NumPendingTasks.Decrement();
+
+		OutGameTasksToDelete.Add(MoveTemp(Task));
 	}
 
-	OutGameTasksToDelete = MoveTemp(GameTasks);
+	return NumProcessed;
 }
 
 void FVoxelTaskContext::TrackPromise(const FVoxelPromiseState& PromiseState)
@@ -0,0 +1,524 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelTransvoxelMesher.h"
+#include "TransvoxelData.h"
+#include "TransvoxelTransitionData.h"
+#include "VoxelTransvoxelMesherImpl.ispc.generated.h"
+
+int64 FVoxelTransvoxelMesh::GetAllocatedSize() const
+{
+	return
+		Indices.GetAllocatedSize() +
+		Vertices.GetAllocatedSize() +
+		Normals.GetAllocatedSize();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+class FVoxelTransvoxelMesherImpl
+{
+public:
+	const FVoxelTransvoxelMesher& Mesher;
+	const TConstVoxelArrayView<float> Densities;
+	const int32 ChunkSize;
+	const int32 DataSize;
+	const int32 CornerSize;
+	const int32 TransitionMask;
+	const TSharedRef<FVoxelTransvoxelMesh> Mesh = MakeShared<FVoxelTransvoxelMesh>();
+
+	FVoxelTransvoxelMesherImpl(
+		const FVoxelTransvoxelMesher& Mesher,
+		const TConstVoxelArrayView<float> Densities,
+		const int32 TransitionMask)
+		: Mesher(Mesher)
+		, Densities(Densities)
+		, ChunkSize(Mesher.ChunkSize)
+		, DataSize(Mesher.ChunkSize + 3)
+		, CornerSize(Mesher.ChunkSize + 1)
+		, TransitionMask(TransitionMask)
+	{
+	}
+
+	void Build()
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		for (int32 Axis = 0; Axis < 3; Axis++)
+		{
+			BuildEdges(Axis);
+		}
+
+		BuildRegularCells();
+
+		for (int32 Face = 0; Face < 6; Face++)
+		{
+			if (TransitionMask & (1 << Face))
+			{
+				BuildTransitionCells(Face);
+			}
+		}
+	}
+
+private:
+	// Per axis, map from the first corner of an edge to its vertex
+	TVoxelStaticArray<TVoxelArray<int32>, 3> EdgeToVertex;
+	// High res vertices on the border of a transition face, shared with the transition faces meeting at that chunk edge
+	// Keyed by GetHighResEdgeKey
+	TVoxelMap<uint64, int32> BorderHighResEdgeToVertex;
+
+	// Position is on the (2 * ChunkSize + 1)^3 high res grid
+	FORCEINLINE static uint64 GetHighResEdgeKey(const FIntVector& Position, const int32 EdgeAxis)
+	{
+		checkVoxelSlow(0 <= Position.X && Position.X < (1 << 20));
+		checkVoxelSlow(0 <= Position.Y && Position.Y < (1 << 20));
+		checkVoxelSlow(0 <= Position.Z && Position.Z < (1 << 20));
+
+		return
+			(uint64(Position.X) << 0) |
+			(uint64(Position.Y) << 20) |
+			(uint64(Position.Z) << 40) |
+			(uint64(EdgeAxis) << 60);
+	}
+
+	FORCEINLINE int32 GetCornerIndex(const int32 X, const int32 Y, const int32 Z) const
+	{
+		checkVoxelSlow(0 <= X && X < CornerSize);
+		checkVoxelSlow(0 <= Y && Y < CornerSize);
+		checkVoxelSlow(0 <= Z && Z < CornerSize);
+		return X + Y * CornerSize + Z * CornerSize * CornerSize;
+	}
+	FORCEINLINE int32 GetCornerIndex(const FIntVector& Position) const
+	{
+		return GetCornerIndex(Position.X, Position.Y, Position.Z);
+	}
+	FORCEINLINE float GetDensity(const int32 X, const int32 Y, const int32 Z) const
+	{
+		return Densities[(X + 1) + (Y + 1) * DataSize + (Z + 1) * DataSize * DataSize];
+	}
+
+	FORCEINLINE int32 AddVertex(
+		const FVector3f& Position,
+		const FVector3f& Normal)
+	{
+		Mesh->Normals.Add(Normal);
+		return Mesh->Vertices.Add(Position * Mesher.VoxelSize);
+	}
+
+	// The tables are wound so that (B - A) x (C - A) points outside
+	// Emit A C B so that FVoxelUtilities::GetTriangleNormal points outside
+	// bFlip is set for inverted transition cell classes and for max faces, whose cells are mirrored
+	FORCEINLINE void AddTriangle(
+		const int32 IndexA,
+		const int32 IndexB,
+		const int32 IndexC,
+		const bool bFlip)
+	{
+		if (IndexA == IndexB ||
+			IndexA == IndexC ||
+			IndexB == IndexC)
+		{
+			return;
+		}
+
+		Mesh->Indices.Add(IndexA);
+		Mesh->Indices.Add(bFlip ? IndexB : IndexC);
+		Mesh->Indices.Add(bFlip ? IndexC : IndexB);
+	}
+
+	// Must match ApplyTransitionOffset in VoxelTransvoxelMesherImpl.ispc
+	FORCEINLINE FVector3f ApplyTransitionOffset(FVector3f Position) const
+	{
+		const float Width = Mesher.TransitionCellWidth;
+
+		for (int32 Axis = 0; Axis < 3; Axis++)
+		{
+			float& Value = Position[Axis];
+
+			if ((TransitionMask & (1 << (2 * Axis + 0))) &&
+				Value < 1.f)
+			{
+				Value = Width + Value * (1.f - Width);
+			}
+			if ((TransitionMask & (1 << (2 * Axis + 1))) &&
+				Value > ChunkSize - 1.f)
+			{
+				Value = (ChunkSize - 1.f) + (Value - (ChunkSize - 1.f)) * (1.f - Width);
+			}
+		}
+
+		return Position;
+	}
+
+	FORCEINLINE FVector3f GetGradient(const int32 X, const int32 Y, const int32 Z) const
+	{
+		return FVector3f(
+			GetDensity(X + 1, Y, Z) - GetDensity(X - 1, Y, Z),
+			GetDensity(X, Y + 1, Z) - GetDensity(X, Y - 1, Z),
+			GetDensity(X, Y, Z + 1) - GetDensity(X, Y, Z - 1));
+	}
+	FVector3f GetNormal(const FVector3f& Position) const
+	{
+		const FIntVector Min = FVoxelUtilities::Clamp(
+			FVoxelUtilities::FloorToInt(Position),
+			0,
+			ChunkSize - 1);
+
+		const FVector3f Alpha = FVoxelUtilities::Clamp(
+			Position - FVector3f(Min),
+			0.f,
+			1.f);
+
+		const FVector3f Gradient = FVoxelUtilities::TrilinearInterpolation(
+			GetGradient(Min.X + 0, Min.Y + 0, Min.Z + 0),
+			GetGradient(Min.X + 1, Min.Y + 0, Min.Z + 0),
+			GetGradient(Min.X + 0, Min.Y + 1, Min.Z + 0),
+			GetGradient(Min.X + 1, Min.Y + 1, Min.Z + 0),
+			GetGradient(Min.X + 0, Min.Y + 0, Min.Z + 1),
+			GetGradient(Min.X + 1, Min.Y + 0, Min.Z + 1),
+			GetGradient(Min.X + 0, Min.Y + 1, Min.Z + 1),
+			GetGradient(Min.X + 1, Min.Y + 1, Min.Z + 1),
+			Alpha.X,
+			Alpha.Y,
+			Alpha.Z);
+
+		return Gradient.GetSafeNormal();
+	}
+
+private:
+	void BuildEdges(const int32 Axis)
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		TVoxelArray<int32>& EdgeToVertexMap = EdgeToVertex[Axis];
+		FVoxelUtilities::SetNumFast(EdgeToVertexMap, CornerSize * CornerSize * CornerSize);
+		FVoxelUtilities::SetAll(EdgeToVertexMap, -1);
+
+		TVoxelArray<int32> Edges;
+		FVoxelUtilities::SetNumFast(Edges, ChunkSize * CornerSize * CornerSize);
+
+		const int32 NumEdges = ispc::VoxelTransvoxelMesher_FindEdges(
+			Densities.GetData(),
+			ChunkSize,
+			Axis,
+			Edges.GetData());
+
+		if (NumEdges == 0)
+		{
+			return;
+		}
+
+		TVoxelArray<float> PositionX;
+		TVoxelArray<float> PositionY;
+		TVoxelArray<float> PositionZ;
+		TVoxelArray<float> NormalX;
+		TVoxelArray<float> NormalY;
+		TVoxelArray<float> NormalZ;
+		FVoxelUtilities::SetNumFast(PositionX, NumEdges);
+		FVoxelUtilities::SetNumFast(PositionY, NumEdges);
+		FVoxelUtilities::SetNumFast(PositionZ, NumEdges);
+		FVoxelUtilities::SetNumFast(NormalX, NumEdges);
+		FVoxelUtilities::SetNumFast(NormalY, NumEdges);
+		FVoxelUtilities::SetNumFast(NormalZ, NumEdges);
+
+		ispc::VoxelTransvoxelMesher_InterpolateEdges(
+			Densities.GetData(),
+			ChunkSize,
+			Axis,
+			Edges.GetData(),
+			NumEdges,
+			Mesher.VoxelSize,
+			TransitionMask,
+			Mesher.TransitionCellWidth,
+			PositionX.GetData(),
+			PositionY.GetData(),
+			PositionZ.GetData(),
+			NormalX.GetData(),
+			NormalY.GetData(),
+			NormalZ.GetData());
+
+		const int32 FirstVertex = Mesh->Vertices.Num();
+		Mesh->Vertices.Reserve(FirstVertex + NumEdges);
+		Mesh->Normals.Reserve(FirstVertex + NumEdges);
+
+		for (int32 Index = 0; Index < NumEdges; Index++)
+		{
+			Mesh->Vertices.Add_EnsureNoGrow(FVector3f(PositionX[Index], PositionY[Index], PositionZ[Index]));
+			Mesh->Normals.Add_EnsureNoGrow(FVector3f(NormalX[Index], NormalY[Index], NormalZ[Index]));
+
+			EdgeToVertexMap[Edges[Index]] = FirstVertex + Index;
+		}
+	}
+
+	void BuildRegularCells()
+	{
+		VOXEL_FUNCTION_COUNTER_NUM(ChunkSize * ChunkSize * ChunkSize);
+
+		using namespace Voxel::Transvoxel;
+
+		TVoxelArray<uint8> CellCodes;
+		FVoxelUtilities::SetNumFast(CellCodes, ChunkSize * ChunkSize * ChunkSize);
+
+		ispc::VoxelTransvoxelMesher_ComputeCellCodes(
+			Densities.GetData(),
+			ChunkSize,
+			CellCodes.GetData());
+
+		int32 CellIndex = 0;
+		for (int32 Z = 0; Z < ChunkSize; Z++)
+		{
+			for (int32 Y = 0; Y < ChunkSize; Y++)
+			{
+				for (int32 X = 0; X < ChunkSize; X++)
+				{
+					const int32 CellCode = CellCodes[CellIndex++];
+					if (CellCode == 0 ||
+						CellCode == 255)
+					{
+						continue;
+					}
+
+					const FCellVertices CellVertices = CellCodeToCellVertices[CellCode];
+					const FCellIndices CellIndices = CellClassToCellIndices[GetCellClass(CellCode)];
+
+					TVoxelStaticArray<int32, 12> VertexIndices{ NoInit };
+					for (int32 Index = 0; Index < CellVertices.NumVertices(); Index++)
+					{
+						const FVertexData VertexData = CellVertices.GetVertexData(Index);
+
+						const int32 CornerIndex = GetCornerIndex(
+							X + bool(VertexData.IndexA & 1),
+							Y + bool(VertexData.IndexA & 2),
+							Z + bool(VertexData.IndexA & 4));
+
+						VertexIndices[Index] = EdgeToVertex[VertexData.EdgeIndex][CornerIndex];
+						checkVoxelSlow(VertexIndices[Index] != -1);
+					}
+
+					for (int32 Index = 0; Index < CellIndices.NumTriangles(); Index++)
+					{
+						AddTriangle(
+							VertexIndices[CellIndices.GetIndex(3 * Index + 0)],
+							VertexIndices[CellIndices.GetIndex(3 * Index + 1)],
+							VertexIndices[CellIndices.GetIndex(3 * Index + 2)],
+							false);
+					}
+				}
+			}
+		}
+	}
+
+	void BuildTransitionCells(const int32 Face)
+	{
+		VOXEL_FUNCTION_COUNTER_NUM(ChunkSize * ChunkSize);
+
+		using namespace Voxel::Transvoxel::Transition;
+
+		const int32 Axis = Face / 2;
+		const bool bIsMax = Face % 2 == 1;
+		const int32 AxisU = (Axis + 1) % 3;
+		const int32 AxisV = (Axis + 2) % 3;
+		const int32 Depth = bIsMax ? ChunkSize : 0;
+
+		const int32 Size = 2 * ChunkSize + 1;
+		const TConstVoxelArrayView<float> TransitionDensities = Mesher.TransitionDensities[Face];
+		check(TransitionDensities.Num() == Size * Size);
+
+		// High res edges, 2 per sample
+		TVoxelArray<int32> HighResEdgeToVertex;
+		FVoxelUtilities::SetNumFast(HighResEdgeToVertex, 2 * Size * Size);
+		FVoxelUtilities::SetAll(HighResEdgeToVertex, -1);
+
+		// Bit N of the cell code is set if sample CellCodeToSample[N] is inside
+		constexpr int32 CellCodeToSample[] = { 0, 1, 2, 5, 8, 7, 6, 3, 4 };
+
+		for (int32 CellV = 0; CellV < ChunkSize; CellV++)
+		{
+			for (int32 CellU = 0; CellU < ChunkSize; CellU++)
+			{
+				// Samples 9 A B C are the low res corners, with the same values as samples 0 2 6 8
+				TVoxelStaticArray<int32, 13> SampleIndices{ NoInit };
+				TVoxelStaticArray<float, 13> SampleValues{ NoInit };
+				for (int32 Index = 0; Index < 9; Index++)
+				{
+					SampleIndices[Index] = (2 * CellU + Index % 3) + (2 * CellV + Index / 3) * Size;
+					SampleValues[Index] = TransitionDensities[SampleIndices[Index]];
+				}
+				for (int32 Index = 0; Index < 4; Index++)
+				{
+					SampleIndices[9 + Index] = SampleIndices[2 * (Index % 2) + 6 * (Index / 2)];
+					SampleValues[9 + Index] = SampleValues[2 * (Index % 2) + 6 * (Index / 2)];
+				}
+
+				int32 CellCode = 0;
+				for (int32 Index = 0; Index < 9; Index++)
+				{
+					if (SampleValues[CellCodeToSample[Index]] < 0.f)
+					{
+						CellCode |= 1 << Index;
+					}
+				}
+
+				if (CellCode == 0 ||
+					CellCode == 511)
+				{
+					continue;
+				}
+
+				const FCellClass CellClass = CellCodeToCellClass[CellCode];
+				const FTransitionCellData& CellData = CellClassToTransitionCellData[CellClass.Index];
+				const FVertexDatas& VertexDatas = CellCodeToVertexDatas[CellCode];
+
+				TVoxelStaticArray<int32, 12> VertexIndices{ NoInit };
+				for (int32 Index = 0; Index < CellData.NumVertices; Index++)
+				{
+					const FVertexData VertexData = VertexDatas[Index];
+					const int32 IndexA = VertexData.IndexA;
+					const int32 IndexB = VertexData.GetIndexB();
+
+					const float DensityA = SampleValues[IndexA];
+					const float DensityB = SampleValues[IndexB];
+					const float Alpha = DensityA / (DensityA - DensityB);
+
+					if (IndexA < 9)
+					{
+						// High res vertex, on the chunk face
+						const bool bAlongU = VertexData.EdgeIndex < 2;
+
+						int32& Vertex = HighResEdgeToVertex[2 * SampleIndices[IndexA] + (bAlongU ? 0 : 1)];
+						if (Vertex == -1)
+						{
+							FIntVector HighResPosition;
+							HighResPosition[Axis] = 2 * Depth;
+							HighResPosition[AxisU] = 2 * CellU + IndexA % 3;
+							HighResPosition[AxisV] = 2 * CellV + IndexA / 3;
+
+							// Edges along the border of the face are shared with the adjacent transition face, if any
+							const int32 Across = HighResPosition[bAlongU ? AxisV : AxisU];
+							const bool bIsOnBorder =
+								Across == 0 ||
+								Across == 2 * ChunkSize;
+
+							int32* BorderVertex = nullptr;
+							if (bIsOnBorder)
+							{
+								BorderVertex = &BorderHighResEdgeToVertex.FindOrAdd(
+									GetHighResEdgeKey(HighResPosition, bAlongU ? AxisU : AxisV),
+									[](int32& NewVertex) { NewVertex = -1; });
+							}
+
+							if (BorderVertex &&
+								*BorderVertex != -1)
+							{
+								Vertex = *BorderVertex;
+							}
+							else
+							{
+								FVector3f Position = FVector3f(HighResPosition) / 2.f;
+								Position[bAlongU ? AxisU : AxisV] += Alpha / 2.f;
+
+								Vertex = AddVertex(Position, GetNormal(Position));
+
+								if (BorderVertex)
+								{
+									*BorderVertex = Vertex;
+								}
+							}
+						}
+						VertexIndices[Index] = Vertex;
+					}
+					else
+					{
+						// Low res vertex, shared with the regular cells
+						const int32 Corner = IndexA - 9;
+						const int32 EdgeAxis = VertexData.EdgeIndex == 4 ? AxisU : AxisV;
+
+						FIntVector CornerPosition;
+						CornerPosition[Axis] = Depth;
+						CornerPosition[AxisU] = CellU + Corner % 2;
+						CornerPosition[AxisV] = CellV + Corner / 2;
+
+						int32& Vertex = EdgeToVertex[EdgeAxis][GetCornerIndex(CornerPosition)];
+						if (Vertex == -1)
+						{
+							// Can happen if the transition densities don't exactly match the regular densities
+							FVector3f Position = FVector3f(CornerPosition);
+							Position[EdgeAxis] += Alpha;
+
+							Vertex = AddVertex(ApplyTransitionOffset(Position), GetNormal(Position));
+						}
+						VertexIndices[Index] = Vertex;
+					}
+				}
+
+				// The tables expect the low res face on the +Axis side of the high res face: max face cells are mirrored
+				const bool bFlip = CellClass.bIsInverted != bIsMax;
+
+				for (int32 Index = 0; Index < CellData.NumTriangles; Index++)
+				{
+					AddTriangle(
+						VertexIndices[CellData.Indices[3 * Index + 0]],
+						VertexIndices[CellData.Indices[3 * Index + 1]],
+						VertexIndices[CellData.Indices[3 * Index + 2]],
+						bFlip);
+				}
+			}
+		}
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+TSharedRef<FVoxelTransvoxelMesh> FVoxelTransvoxelMesher::CreateMesh() const
+{
+	VOXEL_FUNCTION_COUNTER_NUM(ChunkSize * ChunkSize * ChunkSize);
+	check(ChunkSize > 0);
+	check(0.f <= TransitionCellWidth && TransitionCellWidth < 1.f);
+
+	const int32 NumDensities = FMath::Cube(ChunkSize + 3);
+
+	TVoxelArray<float> ConvertedDensities;
+	TConstVoxelArrayView<float> FloatDensities = Densities;
+
+	if (Densities_Int16.Num() > 0)
+	{
+		check(Densities.Num() == 0);
+		check(Densities_Int16.Num() == NumDensities);
+
+		FVoxelUtilities::SetNumFast(ConvertedDensities, NumDensities);
+
+		ispc::VoxelTransvoxelMesher_ConvertDensities(
+			Densities_Int16.GetData(),
+			ConvertedDensities.GetData(),
+			NumDensities);
+
+		FloatDensities = ConvertedDensities;
+	}
+
+	if (!ensure(FloatDensities.Num() == NumDensities))
+	{
+		return MakeShared<FVoxelTransvoxelMesh>();
+	}
+
+	FVoxelTransvoxelMesherImpl Impl(*this, FloatDensities, GetTransitionMask());
+	Impl.Build();
+	return Impl.Mesh;
+}
+
+TVoxelArray<TSharedPtr<FVoxelTransvoxelMesh>> FVoxelTransvoxelMesher::CreateMeshes(const TConstVoxelArrayView<FVoxelTransvoxelMesher> Meshers)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Meshers.Num());
+
+	TVoxelArray<TSharedPtr<FVoxelTransvoxelMesh>> Meshes;
+	Meshes.SetNum(Meshers.Num());
+
+	Voxel::ParallelFor(Meshes, [&](TSharedPtr<FVoxelTransvoxelMesh>& Mesh, const int32 Index)
+	{
+		Mesh = Meshers[Index].CreateMesh();
+	});
+
+	return Meshes;
+}
@@ -2,6 +2,9 @@
 
 #include "VoxelZipReader.h"
 
+// Inflating through the shared mz_zip_archive isn't thread-safe, so we keep our own decompressor per thread
+thread_local TUniquePtr<voxel::tinfl_decompressor> GVoxelZipReaderInflator;
+
 TSharedPtr<FVoxelZipReader> FVoxelZipReader::Create(
 	const int64 TotalSize,
 	const FReadLambda& ReadLambda)
@@ -61,7 +64,29 @@ TSharedPtr<FVoxelZipReader> FVoxelZipReader::Create(
 		FString Path(UTF8String);
 		Path.TrimToNullTerminator();
 
+		FEntry Entry;
+		{
+			voxel::mz_zip_archive_file_stat FileStat;
+			if (ensure(mz_zip_reader_file_stat(
+				&Result->Archive,
+				Index,
+				&FileStat)))
+			{
+				Entry.LocalHeaderOffset = FileStat.m_local_header_ofs;
+				Entry.CompressedSize = FileStat.m_comp_size;
+				Entry.UncompressedSize = FileStat.m_uncomp_size;
+				Entry.CRC = FileStat.m_crc32;
+				Entry.Method = FileStat.m_method;
+				Entry.bIsSupported =
+					FileStat.m_is_supported &&
+					!FileStat.m_is_encrypted &&
+					(FileStat.m_method == 0 || FileStat.m_method == MZ_DEFLATED);
+			}
+			Result->CheckError();
+		}
+
 		ensure(Result->IndexToPath.Add(Path) == Index);
+		ensure(Result->IndexToEntry.Add(Entry) == Index);
 
 		if (ensure(!Result->PathToIndex.Contains(Path)))
 		{
@@ -107,36 +132,173 @@ bool FVoxelZipReader::TryLoad(
 		return false;
 	}
 
-	voxel::mz_zip_archive_file_stat FileStat;
-	if (!ensure(mz_zip_reader_file_stat(
-		&Archive,
-		*IndexPtr,
-		&FileStat)))
+	if (OutCompressedSize)
 	{
-		CheckError();
-		return false;
+		*OutCompressedSize = IndexToEntry[*IndexPtr].CompressedSize;
 	}
 
-	if (OutCompressedSize)
+	return TryLoadImpl(*IndexPtr, OutData, bAllowParallel);
+}
+
+TVoxelArray<TVoxelFuture<FVoxelZipReader::FLoadResult>> FVoxelZipReader::LoadAsync(const TConstVoxelArrayView<FString> Paths) const
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Paths.Num());
+
+	TVoxelArray<TVoxelFuture<FLoadResult>> Futures;
+	Futures.Reserve(Paths.Num());
+
+	for (const FString& Path : Paths)
 	{
-		*OutCompressedSize = FileStat.m_comp_size;
+		const int32* IndexPtr = PathToIndex.Find(Path);
+		if (!ensure(IndexPtr))
+		{
+			Futures.Add(FLoadResult());
+			continue;
+		}
+
+		Futures.Add(Voxel::AsyncTask([This = AsShared(), Index = *IndexPtr]
+		{
+			VOXEL_SCOPE_COUNTER_FORMAT("FVoxelZipReader::LoadAsync %s", *This->IndexToPath[Index]);
+
+			FLoadResult Result;
+			Result.CompressedSize = This->IndexToEntry[Index].CompressedSize;
+			// We are already running in parallel
+			Result.bSuccess = This->TryLoadImpl(Index, Result.Data, false);
+			return Result;
+		}));
 	}
 
-	FVoxelUtilities::SetNumFast(OutData, FileStat.m_uncomp_size);
+	return Futures;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+bool FVoxelZipReader::TryLoadImpl(
+	const int32 Index,
+	TVoxelArray64<uint8>& OutData,
+	const bool bAllowParallel) const
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	// See mz_zip_reader_extract_to_mem_no_alloc
+	constexpr int32 LocalHeaderSize = 30;
+	constexpr int32 LocalHeaderFilenameLengthOffset = 26;
+	constexpr int32 LocalHeaderExtraLengthOffset = 28;
+	constexpr uint32 LocalHeaderSignature = 0x04034b50;
 
-	if (!ensure(mz_zip_reader_extract_to_mem_no_alloc(
-		&Archive,
-		*IndexPtr,
-		OutData.GetData(),
-		OutData.Num(),
-		0,
-		nullptr,
-		0)))
+	const FEntry& Entry = IndexToEntry[Index];
+	if (!ensure(Entry.bIsSupported))
 	{
-		CheckError();
+		RaiseError();
 		return false;
 	}
-	CheckError();
+
+	// Directory or empty file
+	if (Entry.CompressedSize == 0)
+	{
+		OutData.Reset();
+		return true;
+	}
+
+	FVoxelUtilities::SetNumFast(OutData, Entry.UncompressedSize);
+
+	int64 DataOffset;
+	{
+		TVoxelStaticArray<uint8, LocalHeaderSize> LocalHeader{ NoInit };
+		if (!ensure(ReadLambda(
+			Entry.LocalHeaderOffset,
+			TVoxelArrayView64<uint8>(LocalHeader.GetData(), LocalHeaderSize))))
+		{
+			RaiseError();
+			return false;
+		}
+
+		const auto ReadUInt16 = [&](const int32 Offset)
+		{
+			uint16 Value;
+			FMemory::Memcpy(&Value, &LocalHeader[Offset], sizeof(Value));
+			return Value;
+		};
+
+		uint32 Signature;
+		FMemory::Memcpy(&Signature, LocalHeader.GetData(), sizeof(Signature));
+
+		if (!ensure(Signature == LocalHeaderSignature))
+		{
+			RaiseError();
+			return false;
+		}
+
+		DataOffset =
+			Entry.LocalHeaderOffset +
+			LocalHeaderSize +
+			ReadUInt16(LocalHeaderFilenameLengthOffset) +
+			ReadUInt16(LocalHeaderExtraLengthOffset);
+	}
+
+	if (Entry.Method == 0)
+	{
+		if (!ensure(Entry.CompressedSize == Entry.UncompressedSize) ||
+			!ensure(ReadLambda(DataOffset, OutData)))
+		{
+			RaiseError();
+			return false;
+		}
+	}
+	else
+	{
+		checkVoxelSlow(Entry.Method == MZ_DEFLATED);
+
+		TVoxelArray64<uint8> DeflatedData;
+		FVoxelUtilities::SetNumFast(DeflatedData, Entry.CompressedSize);
+
+		if (!ensure(ReadLambda(DataOffset, DeflatedData)))
+		{
+			RaiseError();
+			return false;
+		}
+
+		VOXEL_SCOPE_COUNTER_FORMAT("Inflate %lldB", Entry.UncompressedSize);
+
+		if (!GVoxelZipReaderInflator)
+		{
+			GVoxelZipReaderInflator = MakeUnique<voxel::tinfl_decompressor>();
+		}
+
+		voxel::tinfl_decompressor* Inflator = GVoxelZipReaderInflator.Get();
+		tinfl_init(Inflator);
+
+		size_t InSize = DeflatedData.Num();
+		size_t OutSize = OutData.Num();
+
+		const voxel::tinfl_status Status = voxel::tinfl_decompress(
+			Inflator,
+			DeflatedData.GetData(),
+			&InSize,
+			OutData.GetData(),
+			OutData.GetData(),
+			&OutSize,
+			voxel::TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF);
+
+		if (!ensure(Status == voxel::TINFL_STATUS_DONE) ||
+			!ensure(int64(OutSize) == Entry.UncompressedSize))
+		{
+			RaiseError();
+			return false;
+		}
+	}
+
+	{
+		VOXEL_SCOPE_COUNTER_FORMAT("CRC %lldB", OutData.Num());
+
+		if (!ensure(voxel::mz_crc32(MZ_CRC32_INIT, OutData.GetData(), OutData.Num()) == Entry.CRC))
+		{
+			RaiseError();
+			return false;
+		}
+	}
 
 	if (!FVoxelUtilities::IsCompressedData(OutData))
 	{
@@ -46,6 +46,12 @@ TSharedRef<FVoxelZipWriter> FVoxelZipWriter::Create(TVoxelArray64<uint8>& BulkDa
 bool FVoxelZipWriter::Finalize()
 {
 	VOXEL_FUNCTION_COUNTER();
+
+	{
+		VOXEL_SCOPE_LOCK(AsyncCriticalSection);
+		ensure(NumAsyncEntriesWritten_RequiresLock == NumAsyncEntriesSubmitted_RequiresLock);
+	}
+
 	VOXEL_SCOPE_LOCK(CriticalSection);
 
 	ensure(mz_zip_writer_finalize_archive(&Archive));
@@ -103,19 +109,196 @@ void FVoxelZipWriter::WriteCompressed_Oodle(
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
+FVoxelFuture FVoxelZipWriter::WriteCompressedAsync(
+	const FString& Path,
+	TVoxelArray64<uint8> Data)
+{
+	const TSharedRef<FAsyncEntry> Entry = MakeAsyncEntry(Path);
+
+	Voxel::AsyncTask([This = AsShared(), Entry, Data = MoveTemp(Data)]() mutable
+	{
+		VOXEL_SCOPE_COUNTER_FORMAT("FVoxelZipWriter::WriteCompressedAsync %s %lldB", *Entry->Path, Data.Num());
+
+		Entry->UncompressedSize = Data.Num();
+		{
+			VOXEL_SCOPE_COUNTER("MemCrc32");
+			Entry->Crc32 = FCrc::MemCrc32(Data.GetData(), Data.Num());
+		}
+
+		// Same as mz_zip_writer_add_mem_ex_v2, which doesn't compress tiny files
+		bool bCompressed = Data.Num() > 3;
+		if (bCompressed)
+		{
+			VOXEL_SCOPE_COUNTER_FORMAT("Deflate %lldB", Data.Num());
+
+			TVoxelArray64<uint8>& DeflatedData = Entry->Data;
+			DeflatedData.Reserve(Data.Num() / 2);
+
+			bCompressed = voxel::tdefl_compress_mem_to_output(
+				Data.GetData(),
+				Data.Num(),
+				[](const void* Buffer, const int Length, void* User) -> voxel::mz_bool
+				{
+					static_cast<TVoxelArray64<uint8>*>(User)->Append(static_cast<const uint8*>(Buffer), Length);
+					return true;
+				},
+				&DeflatedData,
+				voxel::tdefl_create_comp_flags_from_zip_params(
+					voxel::MZ_DEFAULT_LEVEL,
+					-MZ_DEFAULT_WINDOW_BITS,
+					voxel::MZ_DEFAULT_STRATEGY));
+
+			// Store incompressible data as is
+			bCompressed &= DeflatedData.Num() < Data.Num();
+		}
+
+		if (bCompressed)
+		{
+			Entry->LevelAndFlags = voxel::MZ_DEFAULT_LEVEL | voxel::MZ_ZIP_FLAG_COMPRESSED_DATA;
+		}
+		else
+		{
+			Entry->LevelAndFlags = voxel::MZ_NO_COMPRESSION;
+			Entry->UncompressedSize = 0;
+			Entry->Data = MoveTemp(Data);
+		}
+
+		This->OnAsyncEntryReady(Entry);
+	});
+
+	return Entry->Promise;
+}
+
+FVoxelFuture FVoxelZipWriter::WriteCompressedAsync_Oodle(
+	const FString& Path,
+	TVoxelArray64<uint8> Data,
+	const FOodleDataCompression::ECompressor Compressor,
+	const FOodleDataCompression::ECompressionLevel CompressionLevel)
+{
+	const TSharedRef<FAsyncEntry> Entry = MakeAsyncEntry(Path);
+
+	Voxel::AsyncTask([This = AsShared(), Entry, Data = MoveTemp(Data), Compressor, CompressionLevel]
+	{
+		VOXEL_SCOPE_COUNTER_FORMAT("FVoxelZipWriter::WriteCompressedAsync_Oodle %s %lldB", *Entry->Path, Data.Num());
+
+		// We are already running in parallel
+		Entry->Data = FVoxelUtilities::Compress(Data, false, Compressor, CompressionLevel);
+		Entry->LevelAndFlags = voxel::MZ_NO_COMPRESSION;
+		{
+			VOXEL_SCOPE_COUNTER("MemCrc32");
+			Entry->Crc32 = FCrc::MemCrc32(Entry->Data.GetData(), Entry->Data.Num());
+		}
+
+		This->OnAsyncEntryReady(Entry);
+	});
+
+	return Entry->Promise;
+}
+
+void FVoxelZipWriter::SetDeterministicAsyncWrites(const bool bNewDeterministicAsyncWrites)
+{
+	VOXEL_SCOPE_LOCK(AsyncCriticalSection);
+
+	// Indices would be mixed up otherwise
+	ensure(NumAsyncEntriesWritten_RequiresLock == NumAsyncEntriesSubmitted_RequiresLock);
+
+	bDeterministicAsyncWrites_RequiresLock = bNewDeterministicAsyncWrites;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+TSharedRef<FVoxelZipWriter::FAsyncEntry> FVoxelZipWriter::MakeAsyncEntry(const FString& Path)
+{
+	const TSharedRef<FAsyncEntry> Entry = MakeShared<FAsyncEntry>();
+	Entry->Path = Path;
+
+	VOXEL_SCOPE_LOCK(AsyncCriticalSection);
+	Entry->SubmitIndex = NumAsyncEntriesSubmitted_RequiresLock++;
+	return Entry;
+}
+
+void FVoxelZipWriter::OnAsyncEntryReady(const TSharedRef<FAsyncEntry>& Entry)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	{
+		VOXEL_SCOPE_LOCK(AsyncCriticalSection);
+
+		const int64 Index = bDeterministicAsyncWrites_RequiresLock
+			? Entry->SubmitIndex
+			: NumAsyncEntriesReady_RequiresLock;
+
+		NumAsyncEntriesReady_RequiresLock++;
+		IndexToReadyAsyncEntry_RequiresLock.Add_CheckNew(Index, Entry);
+
+		if (bIsWritingAsyncEntries_RequiresLock)
+		{
+			// The current writer will pick it up
+			return;
+		}
+		bIsWritingAsyncEntries_RequiresLock = true;
+	}
+
+	// Only one thread at a time gets here: write every entry that is ready, in order
+	while (true)
+	{
+		TSharedPtr<FAsyncEntry> EntryToWrite;
+		{
+			VOXEL_SCOPE_LOCK(AsyncCriticalSection);
+
+			if (!IndexToReadyAsyncEntry_RequiresLock.RemoveAndCopyValue(NumAsyncEntriesWritten_RequiresLock, EntryToWrite))
+			{
+				bIsWritingAsyncEntries_RequiresLock = false;
+				return;
+			}
+
+			NumAsyncEntriesWritten_RequiresLock++;
+		}
+		check(EntryToWrite);
+
+		WriteImpl(
+			EntryToWrite->Path,
+			EntryToWrite->Data,
+			EntryToWrite->LevelAndFlags,
+			EntryToWrite->UncompressedSize,
+			EntryToWrite->Crc32);
+
+		EntryToWrite->Data.Empty();
+		EntryToWrite->Promise.Set();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
 void FVoxelZipWriter::WriteImpl(
 	const FString& Path,
 	const TConstVoxelArrayView64<uint8> Data,
 	const int32 Compression)
 {
-	VOXEL_SCOPE_COUNTER_FORMAT("FVoxelZipWriter::WriteImpl %lldB", Data.Num());
-
 	const uint32 Crc32 = INLINE_LAMBDA
 	{
 		VOXEL_SCOPE_COUNTER("MemCrc32");
 		return FCrc::MemCrc32(Data.GetData(), Data.Num());
 	};
 
+	WriteImpl(Path, Data, Compression, 0, Crc32);
+}
+
+void FVoxelZipWriter::WriteImpl(
+	const FString& Path,
+	const TConstVoxelArrayView64<uint8> Data,
+	const int32 LevelAndFlags,
+	const int64 UncompressedSize,
+	const uint32 Crc32)
+{
+	VOXEL_SCOPE_COUNTER_FORMAT("FVoxelZipWriter::WriteImpl %lldB", Data.Num());
+
+	const int32 Compression = LevelAndFlags & 0xF;
+
 	// Write data outside the critical section
 	struct FPendingWrite
 	{
@@ -163,8 +346,8 @@ void FVoxelZipWriter::WriteImpl(
 			Data.Num(),
 			nullptr,
 			0,
-			Compression,
-			0,
+			LevelAndFlags,
+			UncompressedSize,
 			Crc32));
 
 		WriteLambdaOverride_RequiresLock = {};
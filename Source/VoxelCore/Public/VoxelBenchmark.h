@@ -0,0 +1,120 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "VoxelMinimal.h"
+
+class FJsonObject;
+
+struct VOXELCORE_API FVoxelBenchmarkSettings
+{
+	// Only run benchmarks whose name contains Filter
+	FString Filter;
+	// Thread counts to sweep, 0 means no limit
+	TVoxelArray<int32> NumThreads = { 0 };
+
+	int32 NumWarmupRuns = 3;
+	int32 MinNumSamples = 10;
+	int32 MaxNumSamples = 1000;
+	// Keep sampling until that much time has been spent measuring
+	double MinTime = 0.5;
+	// Fast lambdas are run several times per sample so that a sample is at least this long
+	double MinSampleTime = 100e-6;
+
+	static FVoxelBenchmarkSettings FromCommandLine(const TCHAR* CommandLine);
+};
+
+struct VOXELCORE_API FVoxelBenchmarkResult
+{
+	FString Name;
+	int32 Size = 0;
+	int32 NumThreads = 0;
+
+	int32 NumSamples = 0;
+	// All times are in seconds, per call
+	double Min = 0;
+	double Mean = 0;
+	double Median = 0;
+	double P95 = 0;
+	// Median absolute deviation
+	double MAD = 0;
+
+	FString GetKey() const;
+
+	TSharedRef<FJsonObject> ToJson() const;
+	static TOptional<FVoxelBenchmarkResult> FromJson(const FJsonObject& JsonObject);
+};
+
+class VOXELCORE_API FVoxelBenchmarkContext
+{
+public:
+	const FVoxelBenchmarkSettings& Settings;
+	const int32 Size;
+
+	FVoxelBenchmarkContext(
+		const FVoxelBenchmarkSettings& Settings,
+		const int32 Size)
+		: Settings(Settings)
+		, Size(Size)
+	{
+	}
+
+	// Measure Lambda, can only be called once per benchmark
+	void Measure(TFunctionRef<void()> Lambda);
+	// Initialize is called before every sample and isn't timed
+	// Samples are never batched: each sample is a single call to Lambda
+	void Measure(
+		TFunctionRef<void()> Initialize,
+		TFunctionRef<void()> Lambda);
+
+private:
+	TVoxelArray<double> Samples;
+
+	void MeasureImpl(
+		TFunctionRef<void()> Initialize,
+		TFunctionRef<void()> Lambda,
+		bool bAllowBatching);
+
+	friend class FVoxelBenchmarkRegistry;
+};
+
+class VOXELCORE_API FVoxelBenchmarkRegistry
+{
+public:
+	using FBenchmark = TFunction<void(FVoxelBenchmarkContext& Context)>;
+
+	static void Register(
+		const FString& Name,
+		const TConstVoxelArrayView<int32> Sizes,
+		FBenchmark Benchmark);
+
+	static TVoxelArray<FVoxelBenchmarkResult> Run(const FVoxelBenchmarkSettings& Settings);
+
+public:
+	static FString ToJson(TConstVoxelArrayView<FVoxelBenchmarkResult> Results);
+	static FString ToCsv(TConstVoxelArrayView<FVoxelBenchmarkResult> Results);
+	static bool FromJson(
+		const FString& Json,
+		TVoxelArray<FVoxelBenchmarkResult>& OutResults);
+
+	// A result is a regression if its median is more than Threshold slower than the baseline
+	// and if the difference is larger than the noise, estimated from the MADs
+	// Returns the number of regressions
+	static int32 Compare(
+		TConstVoxelArrayView<FVoxelBenchmarkResult> Baseline,
+		TConstVoxelArrayView<FVoxelBenchmarkResult> Results,
+		double Threshold);
+};
+
+// Sizes are passed as Context.Size, benchmarks without sizes are run once with Size = 0
+// VOXEL_BENCHMARK("RadixSort", 1024, 1024 * 1024)
+// {
+//     Context.Measure([&] { ... });
+// }
+#define VOXEL_BENCHMARK(Name, ...) \
+	static void VOXEL_APPEND_LINE(VoxelBenchmark)(FVoxelBenchmarkContext& Context); \
+	VOXEL_RUN_ON_STARTUP_GAME() \
+	{ \
+		FVoxelBenchmarkRegistry::Register(TEXT(Name), TVoxelArray<int32>{ __VA_ARGS__ }, VOXEL_APPEND_LINE(VoxelBenchmark)); \
+	} \
+	static void VOXEL_APPEND_LINE(VoxelBenchmark)(FVoxelBenchmarkContext& Context)
@@ -0,0 +1,78 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "VoxelMinimal.h"
+
+// Region represented as a set of boxes, used to coalesce invalidations before building an AABB tree
+// Boxes can overlap, but no box is contained in another one after Add or Compact
+// Boxes are stored as SoA to allow vectorizing intersection tests
+class VOXELCORE_API FVoxelBoxSet
+{
+public:
+	FVoxelBoxSet() = default;
+	explicit FVoxelBoxSet(TConstVoxelArrayView<FVoxelBox> Boxes);
+	explicit FVoxelBoxSet(const TVoxelChunkedArray<FVoxelBox>& Boxes);
+
+	FORCEINLINE int32 Num() const
+	{
+		checkVoxelSlow(MinX.Num() == MinY.Num());
+		checkVoxelSlow(MinX.Num() == MinZ.Num());
+		checkVoxelSlow(MinX.Num() == MaxX.Num());
+		checkVoxelSlow(MinX.Num() == MaxY.Num());
+		checkVoxelSlow(MinX.Num() == MaxZ.Num());
+		return MinX.Num();
+	}
+	FORCEINLINE bool IsEmpty() const
+	{
+		return Num() == 0;
+	}
+	FORCEINLINE FVoxelBox GetBox(const int32 Index) const
+	{
+		return FVoxelBox(
+			FVector(MinX[Index], MinY[Index], MinZ[Index]),
+			FVector(MaxX[Index], MaxY[Index], MaxZ[Index]));
+	}
+
+	int64 GetAllocatedSize() const;
+	FVoxelOptionalBox GetBounds() const;
+	TVoxelArray<FVoxelBox> GetBoxes() const;
+	// Sum of the box volumes, larger than the region volume if boxes overlap
+	double GetVolume() const;
+
+	// True if Box overlaps or touches any box
+	bool Intersects(const FVoxelBox& Box) const;
+
+public:
+	// Skipped if Box is already contained, removes the boxes contained in Box
+	void Add(const FVoxelBox& Box);
+	void Add(const FVoxelBoxSet& Other);
+
+	// Boxes overlapping Box are split in up to 6 boxes
+	void Subtract(const FVoxelBox& Box);
+	void Subtract(const FVoxelBoxSet& Other);
+
+	// Remove contained boxes and merge boxes whose union is exactly a box
+	// The region covered is unchanged
+	void Compact();
+
+	// Merge the boxes adding the least volume until there are at most MaxNumBoxes boxes
+	// Stops early once merging would add more than MaxAddedVolumeRatio * GetVolume(), leaving more than MaxNumBoxes boxes
+	// Returns an upper bound of the volume added to the region
+	double Approximate(
+		int32 MaxNumBoxes,
+		double MaxAddedVolumeRatio);
+
+private:
+	TVoxelArray<double> MinX;
+	TVoxelArray<double> MinY;
+	TVoxelArray<double> MinZ;
+	TVoxelArray<double> MaxX;
+	TVoxelArray<double> MaxY;
+	TVoxelArray<double> MaxZ;
+
+	void Reserve(int32 Number);
+	void AddUnchecked(const FVoxelBox& Box);
+	void RemoveAtSwap(int32 Index);
+	void SetBoxes(TConstVoxelArrayView<FVoxelBox> Boxes);
+};
@@ -6,10 +6,22 @@
 
 struct VOXELCORE_API FVoxelChaosTriangleMeshCooker
 {
+	struct FMesh
+	{
+		TConstVoxelArrayView<int32> Indices;
+		TConstVoxelArrayView<FVector3f> Vertices;
+		TConstVoxelArrayView<uint16> FaceMaterials;
+	};
+
+	// If voxel.collision.CookCacheSizeMB is set, cooked meshes are cached by content hash
+	// The returned mesh might then be shared with other callers and must not be modified
 	static TRefCountPtr<Chaos::FTriangleMeshImplicitObject> Create(
 		TConstVoxelArrayView<int32> Indices,
 		TConstVoxelArrayView<FVector3f> Vertices,
 		TConstVoxelArrayView<uint16> FaceMaterials);
 
+	// Cook many meshes in parallel
+	static TVoxelArray<TRefCountPtr<Chaos::FTriangleMeshImplicitObject>> Create(TConstVoxelArrayView<FMesh> Meshes);
+
 	static int64 GetAllocatedSize(const Chaos::FTriangleMeshImplicitObject& TriangleMesh);
-};
\ No newline at end of file
+};
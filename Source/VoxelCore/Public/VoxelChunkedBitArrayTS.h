@@ -4,66 +4,104 @@
 
 #include "VoxelMinimal.h"
 
+// Readers never lock: chunks are stored in a two-level directory and are never moved nor freed until destruction
+// SetNumChunks publishes new pages and chunks with release semantics, readers acquire them
 struct VOXELCORE_API FVoxelChunkedBitArrayTS
 {
 public:
 	static constexpr int32 ChunkSize = 32 * 1024;
+	// 8M bits per page, 2KB per page
+	static constexpr int32 ChunksPerPageLog2 = 8;
+	static constexpr int32 ChunksPerPage = 1 << ChunksPerPageLog2;
+	// Enough pages to address every int32 bit index, 2KB of inline directory
+	static constexpr int32 MaxNumPages = 256;
+	static constexpr int32 MaxNumChunks = MAX_int32 / ChunkSize;
+	checkStatic(MaxNumChunks <= MaxNumPages * ChunksPerPage);
+
 	using FChunk = TVoxelStaticBitArray<ChunkSize>;
+	using FPage = TVoxelStaticArray<TVoxelAtomic<FChunk*>, ChunksPerPage>;
 
-	FVoxelChunkedBitArrayTS() = default;
+	FVoxelChunkedBitArrayTS();
+	~FVoxelChunkedBitArrayTS();
 	UE_NONCOPYABLE(FVoxelChunkedBitArrayTS);
 
 public:
 	int64 GetAllocatedSize() const;
+	// Not safe to call concurrently with itself
 	void SetNumChunks(int32 NewNumChunks);
 
 	template<typename LambdaType>
 	requires LambdaHasSignature_V<LambdaType, void(int32)>
 	void ForAllSetBits(LambdaType Lambda) const
 	{
-		VOXEL_FUNCTION_COUNTER_NUM(Chunks.Num() * ChunkSize);
-		VOXEL_SCOPE_READ_LOCK(CriticalSection);
+		const int32 NumChunks = NumChunks_Atomic.Get(std::memory_order_acquire);
+		VOXEL_FUNCTION_COUNTER_NUM(NumChunks * ChunkSize);
 
-		for (int32 ChunkIndex = 0; ChunkIndex < Chunks.Num(); ChunkIndex++)
+		for (int32 ChunkIndex = 0; ChunkIndex < NumChunks; ChunkIndex++)
 		{
-			checkVoxelSlow(Chunks[ChunkIndex]);
+			const FChunk& Chunk = GetChunk(ChunkIndex);
 
-			for (const int32 ChunkOffset : Chunks[ChunkIndex]->IterateSetBits())
+			for (const int32 ChunkOffset : Chunk.IterateSetBits())
 			{
 				Lambda(ChunkIndex * ChunkSize + ChunkOffset);
 			}
 		}
 	}
+	// Lambda will be called from multiple threads, one task per chunk
+	// Set bits in a chunk are visited in order
+	template<typename LambdaType>
+	requires LambdaHasSignature_V<LambdaType, void(int32)>
+	void ParallelForAllSetBits(LambdaType Lambda) const
+	{
+		const int32 NumChunks = NumChunks_Atomic.Get(std::memory_order_acquire);
+		VOXEL_FUNCTION_COUNTER_NUM(NumChunks * ChunkSize);
+
+		Voxel::ParallelFor(NumChunks, [&](const int32 ChunkIndex)
+		{
+			const FChunk& Chunk = GetChunk(ChunkIndex);
+
+			for (const int32 ChunkOffset : Chunk.IterateSetBits())
+			{
+				Lambda(ChunkIndex * ChunkSize + ChunkOffset);
+			}
+		});
+	}
 
 public:
 	FORCEINLINE int32 NumBits() const
 	{
-		return ChunkSize * Chunks.Num();
+		return ChunkSize * NumChunks_Atomic.Get(std::memory_order_acquire);
 	}
 
 	FORCEINLINE bool Set_ReturnOld(const int32 Index, const bool bValue)
 	{
-		VOXEL_SCOPE_READ_LOCK(CriticalSection);
-
 		const int32 ChunkIndex = FVoxelUtilities::GetChunkIndex<ChunkSize>(Index);
 		const int32 ChunkOffset = FVoxelUtilities::GetChunkOffset<ChunkSize>(Index);
 
-		checkVoxelSlow(Chunks[ChunkIndex]);
-		return Chunks[ChunkIndex]->AtomicSet_ReturnOld(ChunkOffset, bValue);
+		return GetChunk(ChunkIndex).AtomicSet_ReturnOld(ChunkOffset, bValue);
 	}
 
 	FORCEINLINE const bool operator[](const int32 Index) const
 	{
-		VOXEL_SCOPE_READ_LOCK(CriticalSection);
-
 		const int32 ChunkIndex = FVoxelUtilities::GetChunkIndex<ChunkSize>(Index);
 		const int32 ChunkOffset = FVoxelUtilities::GetChunkOffset<ChunkSize>(Index);
 
-		checkVoxelSlow(Chunks[ChunkIndex]);
-		return (*Chunks[ChunkIndex])[ChunkOffset];
+		return GetChunk(ChunkIndex)[ChunkOffset];
 	}
 
 private:
-	FVoxelSharedCriticalSection CriticalSection;
-	TVoxelArray<TUniquePtr<FChunk>> Chunks;
-};
\ No newline at end of file
+	TVoxelAtomic<int32> NumChunks_Atomic;
+	TVoxelStaticArray<TVoxelAtomic<FPage*>, MaxNumPages> Pages{ NoInit };
+
+	FORCEINLINE FChunk& GetChunk(const int32 ChunkIndex) const
+	{
+		checkVoxelSlow(0 <= ChunkIndex && ChunkIndex < MaxNumChunks);
+
+		const FPage* Page = Pages[ChunkIndex >> ChunksPerPageLog2].Get(std::memory_order_acquire);
+		checkVoxelSlow(Page);
+
+		FChunk* Chunk = (*Page)[ChunkIndex & (ChunksPerPage - 1)].Get(std::memory_order_acquire);
+		checkVoxelSlow(Chunk);
+		return *Chunk;
+	}
+};
@@ -35,8 +35,11 @@ protected:
 	const FVoxelDependencyRef DependencyRef;
 	FVoxelChunkedBitArrayTS ReferencingTrackers;
 
-	template<typename LambdaType>
-	void InvalidateTrackers(LambdaType ShouldInvalidate);
+	// AddToQueue records the invalidation in the invalidation queues, ShouldInvalidate checks referencing trackers
+	template<typename QueueLambdaType, typename LambdaType>
+	void InvalidateTrackers(
+		QueueLambdaType AddToQueue,
+		LambdaType ShouldInvalidate);
 
 	friend FVoxelDependencyTracker;
 	friend FVoxelDependencyCollector;
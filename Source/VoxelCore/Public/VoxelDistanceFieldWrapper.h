@@ -37,6 +37,18 @@ public:
 
 			return FMath::Clamp<int32>(FMath::FloorToInt(RescaledDistance * 255.0f + .5f), 0, 255);
 		}
+		// Vectorized QuantizeDistance, returns the min/max quantized value
+		FInt32Interval QuantizeDistances(
+			TConstVoxelArrayView<float> Distances,
+			TVoxelArrayView<uint8> OutDistances) const;
+
+		// Distances further than this from the surface all quantize to 0 or 255
+		FORCEINLINE float GetMaxEncodedDistance() const
+		{
+			return DistanceFieldToVolumeScaleBias.X / 2.f / LocalToVolumeScale;
+		}
+
+		FBox GetBrickBounds(const FIntVector& Position) const;
 
 		float GetLocalToVolumeScale() const
 		{
@@ -56,6 +68,8 @@ public:
 	private:
 		float LocalToVolumeScale = 0.f;
 		FVector2D DistanceFieldToVolumeScaleBias = FVector2D::ZeroVector;
+		FBox DistanceFieldVolumeBounds = FBox(ForceInit);
+		FVector VoxelSize = FVector::ZeroVector;
 		FIntVector IndirectionSize = FIntVector::ZeroValue;
 		TVoxelArray<TSharedPtr<FBrick>> Bricks;
 
@@ -74,4 +88,18 @@ public:
 
 	void SetSize(const FIntVector& Mip0IndirectionSize);
 	TSharedRef<FDistanceFieldVolumeData> Build() const;
+
+public:
+	// Conservative range of the distances inside Bounds, in local space. Negative distances are inside
+	// Bricks entirely outside of the encoded band are skipped without computing their distances
+	using FGetDistanceRange = TFunctionRef<FFloatInterval(const FBox& Bounds)>;
+	// Compute the local space distances at Positions. Called in parallel
+	using FComputeDistances = TFunctionRef<void(TConstVoxelArrayView<FVector3f> Positions, TVoxelArrayView<float> OutDistances)>;
+
+	// Generate the bricks of all mips in parallel
+	// Bricks that end up uniformly far or fully inside are not added
+	// SetSize must be called first
+	void BuildBricks(
+		FGetDistanceRange GetDistanceRange,
+		FComputeDistances ComputeDistances);
 };
\ No newline at end of file
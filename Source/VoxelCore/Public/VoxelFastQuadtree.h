@@ -97,6 +97,9 @@ public:
 	static constexpr int32 MinDepth = 2;
 	static constexpr int32 MaxDepth = 30;
 
+	// A full subtree of height 6 has ~5.5k nodes
+	static constexpr int32 DefaultTaskHeight = 6;
+
 public:
 	const int32 Depth;
 
@@ -153,6 +156,24 @@ public:
 		return Nodes[NodeRef.Index];
 	}
 
+	FORCEINLINE bool IsLeaf(const FNodeRef NodeRef) const
+	{
+		if (NodeRef.Height == 0)
+		{
+			return true;
+		}
+
+		const FChildren& Children = IndexToChildren[NodeRef.Index];
+		for (const int32 ChildIndex : Children)
+		{
+			if (ChildIndex != -1)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
 public:
 	FORCENOINLINE int32 CreateChild(const FNodeRef NodeRef, const int32 Child)
 	{
@@ -337,6 +358,154 @@ public:
 		}
 	}
 
+	template<typename LambdaType, typename ReturnType = LambdaReturnType_T<LambdaType>>
+		requires
+		(
+			(std::is_void_v<ReturnType> || std::is_same_v<ReturnType, EVoxelIterateTree>) &&
+			LambdaHasSignature_V<LambdaType, ReturnType(const FNodeRef&)>
+		)
+	FORCEINLINE void ParallelTraverse(LambdaType Lambda, const int32 TaskHeight = DefaultTaskHeight) const
+	{
+		this->ParallelTraverse(Root(), Lambda, TaskHeight);
+	}
+
+	// Lambda will be called from multiple threads
+	// Nodes above TaskHeight are visited on the calling thread, every subtree rooted at TaskHeight is processed in its own task
+	// Parents are always visited before their children
+	// Stop is best-effort: tasks already running will stop on their next node
+	template<typename LambdaType, typename ReturnType = LambdaReturnType_T<LambdaType>>
+		requires
+		(
+			(std::is_void_v<ReturnType> || std::is_same_v<ReturnType, EVoxelIterateTree>) &&
+			LambdaHasSignature_V<LambdaType, ReturnType(const FNodeRef&)>
+		)
+	FORCENOINLINE void ParallelTraverse(const FNodeRef InNodeRef, LambdaType Lambda, const int32 TaskHeight = DefaultTaskHeight) const
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		TVoxelAtomic<bool> bStop = false;
+
+		const auto Visit = [&](const FNodeRef& NodeRef)
+		{
+			if constexpr (std::is_void_v<ReturnType>)
+			{
+				Lambda(NodeRef);
+				return EVoxelIterateTree::Continue;
+			}
+			else
+			{
+				if (bStop.Get(std::memory_order_relaxed))
+				{
+					return EVoxelIterateTree::Stop;
+				}
+
+				const EVoxelIterateTree Result = Lambda(NodeRef);
+				if (Result == EVoxelIterateTree::Stop)
+				{
+					bStop.Set(true, std::memory_order_relaxed);
+				}
+				return Result;
+			}
+		};
+
+		TVoxelArray<FNodeRef> TaskNodeRefs;
+
+		this->Traverse(InNodeRef, [&](const FNodeRef& NodeRef)
+		{
+			if (NodeRef.Height <= TaskHeight)
+			{
+				TaskNodeRefs.Add(NodeRef);
+				return EVoxelIterateTree::SkipChildren;
+			}
+
+			return Visit(NodeRef);
+		});
+
+		if (bStop.Get())
+		{
+			return;
+		}
+
+		if (TaskNodeRefs.Num() == 1)
+		{
+			this->Traverse(TaskNodeRefs[0], Visit);
+			return;
+		}
+
+		FVoxelParallelTaskScope Scope;
+
+		for (const FNodeRef& TaskNodeRef : TaskNodeRefs)
+		{
+			Scope.AddTask([this, &Visit, TaskNodeRef]
+			{
+				VOXEL_SCOPE_COUNTER("TVoxelFastQuadtree::ParallelTraverse Task");
+				this->Traverse(TaskNodeRef, Visit);
+			});
+		}
+	}
+
+public:
+	struct FDiff
+	{
+		// Nodes of the new tree that are not in the old tree
+		TVoxelArray<FNodeRef> AddedNodes;
+		// Nodes of the old tree that are not in the new tree
+		TVoxelArray<FNodeRef> RemovedNodes;
+		// Nodes in both trees that were a leaf in one tree but not in the other
+		// Key is the old node, Value the new one
+		TVoxelArray<TPair<FNodeRef, FNodeRef>> ResizedNodes;
+
+		void Append(FDiff&& Other)
+		{
+			AddedNodes.Append(MoveTemp(Other.AddedNodes));
+			RemovedNodes.Append(MoveTemp(Other.RemovedNodes));
+			ResizedNodes.Append(MoveTemp(Other.ResizedNodes));
+		}
+	};
+
+	// Compare two trees with the same depth
+	// Node refs in the result are only valid in the tree they come from
+	FORCENOINLINE static FDiff ParallelDiff(
+		const TVoxelFastQuadtree& OldTree,
+		const TVoxelFastQuadtree& NewTree,
+		const int32 TaskHeight = DefaultTaskHeight)
+	{
+		VOXEL_FUNCTION_COUNTER_NUM(FMath::Max(OldTree.NumNodes(), NewTree.NumNodes()));
+		check(OldTree.Depth == NewTree.Depth);
+
+		FDiff Diff;
+		TVoxelArray<FDiffPair> TaskPairs;
+		DiffImpl(OldTree, NewTree, FDiffPair{ OldTree.Root(), NewTree.Root() }, TaskHeight, Diff, &TaskPairs);
+
+		if (TaskPairs.Num() == 0)
+		{
+			return Diff;
+		}
+
+		TVoxelArray<FDiff> TaskDiffs;
+		TaskDiffs.SetNum(TaskPairs.Num());
+		{
+			FVoxelParallelTaskScope Scope;
+
+			for (int32 Index = 0; Index < TaskPairs.Num(); Index++)
+			{
+				Scope.AddTask([&, Index]
+				{
+					VOXEL_SCOPE_COUNTER("TVoxelFastQuadtree::ParallelDiff Task");
+					DiffImpl(OldTree, NewTree, TaskPairs[Index], TaskHeight, TaskDiffs[Index], nullptr);
+				});
+			}
+		}
+
+		VOXEL_SCOPE_COUNTER("Merge");
+
+		for (FDiff& TaskDiff : TaskDiffs)
+		{
+			Diff.Append(MoveTemp(TaskDiff));
+		}
+		return Diff;
+	}
+
 	FORCENOINLINE FNodeRef FindOrAddLeaf(const FIntPoint& Position)
 	{
 		FNodeRef NodeRef = Root();
@@ -353,6 +522,94 @@ public:
 		return NodeRef;
 	}
 
+private:
+	// One of the two refs is invalid if the node only exists in one tree
+	struct FDiffPair
+	{
+		FNodeRef OldNodeRef;
+		FNodeRef NewNodeRef;
+	};
+
+	static void DiffImpl(
+		const TVoxelFastQuadtree& OldTree,
+		const TVoxelFastQuadtree& NewTree,
+		const FDiffPair& InPair,
+		const int32 TaskHeight,
+		FDiff& OutDiff,
+		TVoxelArray<FDiffPair>* OutTaskPairs)
+	{
+		constexpr int32 InvalidIndex = FNodeRef::InvalidIndex;
+
+		TVoxelStaticArray<FDiffPair, 4 * MaxDepth> PairsToTraverse{ NoInit };
+
+		int32 NumPairsToTraverse = 1;
+		PairsToTraverse[0] = InPair;
+
+		while (NumPairsToTraverse > 0)
+		{
+			const FDiffPair Pair = PairsToTraverse[--NumPairsToTraverse];
+			const bool bInOld = Pair.OldNodeRef.Index != InvalidIndex;
+			const bool bInNew = Pair.NewNodeRef.Index != InvalidIndex;
+			checkVoxelSlow(bInOld || bInNew);
+
+			const FNodeRef& NodeRef = bInOld ? Pair.OldNodeRef : Pair.NewNodeRef;
+			checkVoxelSlow(!bInOld || !bInNew || (Pair.OldNodeRef.Height == Pair.NewNodeRef.Height && Pair.OldNodeRef.Center == Pair.NewNodeRef.Center));
+
+			if (OutTaskPairs &&
+				NodeRef.Height <= TaskHeight)
+			{
+				OutTaskPairs->Add(Pair);
+				continue;
+			}
+
+			if (!bInOld)
+			{
+				OutDiff.AddedNodes.Add(Pair.NewNodeRef);
+			}
+			if (!bInNew)
+			{
+				OutDiff.RemovedNodes.Add(Pair.OldNodeRef);
+			}
+
+			if (NodeRef.Height == 0)
+			{
+				continue;
+			}
+
+			bool bOldIsLeaf = true;
+			bool bNewIsLeaf = true;
+			for (int32 Child = 0; Child < 4; Child++)
+			{
+				const int32 OldChildIndex = bInOld ? OldTree.IndexToChildren[Pair.OldNodeRef.Index][Child] : -1;
+				const int32 NewChildIndex = bInNew ? NewTree.IndexToChildren[Pair.NewNodeRef.Index][Child] : -1;
+
+				bOldIsLeaf &= OldChildIndex == -1;
+				bNewIsLeaf &= NewChildIndex == -1;
+
+				if (OldChildIndex == -1 &&
+					NewChildIndex == -1)
+				{
+					continue;
+				}
+
+				const FIntPoint ChildCenter = NodeRef.GetChildCenter(Child);
+
+				PairsToTraverse[NumPairsToTraverse++] = FDiffPair
+				{
+					FNodeRef(OldChildIndex == -1 ? InvalidIndex : OldChildIndex, NodeRef.Height - 1, ChildCenter),
+					FNodeRef(NewChildIndex == -1 ? InvalidIndex : NewChildIndex, NodeRef.Height - 1, ChildCenter)
+				};
+			}
+
+			if (bInOld &&
+				bInNew &&
+				bOldIsLeaf != bNewIsLeaf)
+			{
+				OutDiff.ResizedNodes.Add({ Pair.OldNodeRef, Pair.NewNodeRef });
+			}
+		}
+	}
+
 private:
 	TVoxelSparseArray<FChildren> IndexToChildren;
 	TVoxelArray<NodeType> Nodes;
@@ -21,8 +21,26 @@ public:
 
 	virtual bool Import() = 0;
 
+	// Called in parallel from multiple threads
+	// Data is TileSize.X * TileSize.Y pixels of BitDepth / 8 bytes, row-major
+	using FOnTile = TFunction<void(const FIntPoint& TileMin, const FIntPoint& TileSize, TConstVoxelArrayView64<uint8> Data)>;
+
+	// Stream the heightmap tile by tile instead of loading it whole
+	// Peak memory is around 2 * TileSize rows, no matter the height of the image
+	// Size and BitDepth are set before the first tile is emitted, Data is left empty
+	virtual bool ImportTiles(int32 TileSize, const FOnTile& OnTile) = 0;
+
 	static TSharedPtr<FVoxelHeightmapImporter> MakeImporter(const FString& Path);
 	static bool Import(const FString& Path, FString& OutError, FIntPoint& OutSize, int32& OutBitDepth, TArray64<uint8>& OutData);
+
+protected:
+	using FReadRows = TFunctionRef<bool(int32 StartY, int32 NumRows, TVoxelArrayView64<uint8> OutData)>;
+
+	// Rows are read band by band on the calling thread, while the tiles of the previous band are emitted in parallel
+	bool ImportTilesImpl(
+		int32 TileSize,
+		FReadRows ReadRows,
+		const FOnTile& OnTile) const;
 };
 
 class VOXELCORE_API FVoxelHeightmapImporter_PNG : public FVoxelHeightmapImporter
@@ -31,6 +49,8 @@ public:
 	using FVoxelHeightmapImporter::FVoxelHeightmapImporter;
 
 	virtual bool Import() override;
+	// Decodes the png row by row, interlaced pngs are not supported
+	virtual bool ImportTiles(int32 TileSize, const FOnTile& OnTile) override;
 };
 
 class VOXELCORE_API FVoxelHeightmapImporter_Raw : public FVoxelHeightmapImporter
@@ -39,4 +59,9 @@ public:
 	using FVoxelHeightmapImporter::FVoxelHeightmapImporter;
 
 	virtual bool Import() override;
+	// Uses range reads, the file is never fully loaded
+	virtual bool ImportTiles(int32 TileSize, const FOnTile& OnTile) override;
+
+private:
+	bool SetSizeFromFileSize(int64 FileSize);
 };
\ No newline at end of file
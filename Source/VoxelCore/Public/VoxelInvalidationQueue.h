@@ -4,6 +4,8 @@
 
 #include "VoxelMinimal.h"
 
+class FVoxelAABBTree;
+class FVoxelAABBTree2D;
 class FVoxelDependencyTracker;
 
 namespace Voxel
@@ -27,14 +29,75 @@ public:
 private:
 	FVoxelInvalidationQueue() = default;
 
-	FVoxelSharedCriticalSection CriticalSection;
+	// Invalidations are merged per dependency: FindInvalidation does one lookup per dependency the tracker references
+	// Boxes contained in a previous invalidation are skipped, and once there are too many of them they're moved to AABB trees
+	// Trees are kept sorted by decreasing size, and a tree is merged with the previous one if it's at least half its size:
+	// there are O(log N) trees and each box is rebuilt O(log N) times
+	static constexpr int32 MaxBoxesPerDependency = 64;
+	static constexpr int32 MaxTreesPerDependency = 8;
+
+	struct FInvalidation2D
+	{
+		FVoxelBox2D Bounds = FVoxelBox2D::InvertedInfinite;
+		TVoxelArray<FVoxelBox2D> Boxes;
+		TVoxelArray<TSharedRef<const FVoxelAABBTree2D>> Trees;
+		// Number of boxes in each tree
+		TVoxelArray<int32> TreeNums;
+		TSharedPtr<const FVoxelInvalidationCallstack> Callstack;
 
-	struct FInvalidation
+		void Add(const FVoxelBox2D& NewBounds);
+		void Add(const TSharedRef<const FVoxelAABBTree2D>& Tree);
+		bool Intersects(const FVoxelBox2D& OtherBounds) const;
+
+	private:
+		void AddTree(const TSharedRef<const FVoxelAABBTree2D>& Tree);
+		bool Contains(const FVoxelBox2D& OtherBounds) const;
+	};
+	struct FInvalidation3D
 	{
-		TVoxelUniqueFunction<bool(const FVoxelDependencyTracker&)> ShouldInvalidate;
-		TSharedRef<const FVoxelInvalidationCallstack> Callstack;
+		FVoxelFastBox Bounds;
+		TVoxelArray<FVoxelFastBox> Boxes;
+		TVoxelArray<TSharedRef<const FVoxelAABBTree>> Trees;
+		TSharedPtr<const FVoxelInvalidationCallstack> Callstack;
+
+		void Add(const FVoxelBox& NewBounds);
+		void Add(const TSharedRef<const FVoxelAABBTree>& Tree);
+		bool Intersects(const FVoxelFastBox& OtherBounds) const;
+
+	private:
+		void AddTree(const TSharedRef<const FVoxelAABBTree>& Tree);
+		bool Contains(const FVoxelBox& OtherBounds) const;
 	};
-	TVoxelArray<FInvalidation> Invalidations_RequiresLock;
+
+	FVoxelSharedCriticalSection CriticalSection;
+	TVoxelMap<FVoxelDependencyRef, TSharedRef<const FVoxelInvalidationCallstack>> DependencyToCallstack_RequiresLock;
+	TVoxelMap<FVoxelDependencyRef, FInvalidation2D> Dependency2DToInvalidation_RequiresLock;
+	TVoxelMap<FVoxelDependencyRef, FInvalidation3D> Dependency3DToInvalidation_RequiresLock;
+
+	void Invalidate(
+		FVoxelDependencyRef DependencyRef,
+		const TSharedRef<const FVoxelInvalidationCallstack>& Callstack);
+
+	void Invalidate(
+		FVoxelDependencyRef DependencyRef,
+		const FVoxelBox2D& Bounds,
+		const TSharedRef<const FVoxelInvalidationCallstack>& Callstack);
+	void Invalidate(
+		FVoxelDependencyRef DependencyRef,
+		const TSharedRef<const FVoxelAABBTree2D>& Tree,
+		const TSharedRef<const FVoxelInvalidationCallstack>& Callstack);
+
+	void Invalidate(
+		FVoxelDependencyRef DependencyRef,
+		const FVoxelBox& Bounds,
+		const TSharedRef<const FVoxelInvalidationCallstack>& Callstack);
+	void Invalidate(
+		FVoxelDependencyRef DependencyRef,
+		const TSharedRef<const FVoxelAABBTree>& Tree,
+		const TSharedRef<const FVoxelInvalidationCallstack>& Callstack);
 
 	friend class FVoxelDependencyBase;
+	friend class FVoxelDependency;
+	friend class FVoxelDependency2D;
+	friend class FVoxelDependency3D;
 };
\ No newline at end of file
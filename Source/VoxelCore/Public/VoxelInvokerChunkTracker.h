@@ -0,0 +1,71 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "VoxelMinimal.h"
+
+struct FVoxelChunkInvoker
+{
+	FSphere Sphere = FSphere(ForceInit);
+	// Invokers with a higher priority are kept first when there are too many chunks
+	int32 Priority = 0;
+};
+
+struct FVoxelInvokerChunkDelta
+{
+	TVoxelArray<FIntVector> AddedChunks;
+	TVoxelArray<FIntVector> RemovedChunks;
+
+	FORCEINLINE bool IsEmpty() const
+	{
+		return
+			AddedChunks.Num() == 0 &&
+			RemovedChunks.Num() == 0;
+	}
+};
+
+// Incremental version of FVoxelUtilities::ComputeInvokerChunks
+// Chunks are ref counted by the invokers covering them, and only the chunks between the old and the new sphere
+// of each invoker are visited: an invoker moving by less than a chunk costs one span test per column
+class VOXELCORE_API FVoxelInvokerChunkTracker
+{
+public:
+	FVoxelInvokerChunkTracker(
+		const FTransform& LocalToWorld,
+		double ChunkSize,
+		int32 MaxNumChunks);
+
+	FORCEINLINE int32 NumChunks() const
+	{
+		return ChunkToNumInvokers.Num();
+	}
+	FORCEINLINE bool HasChunk(const FIntVector& Chunk) const
+	{
+		return ChunkToNumInvokers.Contains(Chunk);
+	}
+	// Number of invokers ignored by the last Update because of MaxNumChunks
+	FORCEINLINE int32 GetNumRejectedInvokers() const
+	{
+		return NumRejectedInvokers;
+	}
+
+	TVoxelArray<FIntVector> GetChunks() const;
+
+	// Invokers are identified by their key: invokers not in NewInvokers anymore are removed
+	// If the invokers cover more than MaxNumChunks chunks, the lowest priority invokers are ignored
+	// A chunk is never in both AddedChunks and RemovedChunks
+	void Update(
+		const TVoxelMap<uint64, FVoxelChunkInvoker>& NewInvokers,
+		FVoxelInvokerChunkDelta& OutDelta);
+
+private:
+	const FMatrix WorldToLocal;
+	const double WorldToLocalScale;
+	const double ChunkSize;
+	const int32 MaxNumChunks;
+
+	int32 NumRejectedInvokers = 0;
+	// Accepted invokers only, in chunk space
+	TVoxelMap<uint64, FSphere> IdToChunkSphere;
+	TVoxelMap<FIntVector, int32> ChunkToNumInvokers;
+};
@@ -7,14 +7,21 @@
 struct VOXELCORE_API FVoxelJumpFlood
 {
 public:
+	// Positions that are not seeds should be MAX_int32
 	static void JumpFlood2D(
 		const FIntPoint& Size,
 		TVoxelArrayView<FIntPoint> InOutClosestPosition);
 
-private:
-	static void JumpFlood2DImpl(
+	// SoA version, faster as it doesn't need to split/merge the positions
+	static void JumpFlood2D(
+		const FIntPoint& Size,
+		TVoxelArray<int32>& InOutClosestX,
+		TVoxelArray<int32>& InOutClosestY);
+
+	// Will also write the distance to the closest seed, or MAX_flt if there's none
+	static void JumpFlood2D(
 		const FIntPoint& Size,
-		TConstVoxelArrayView<FIntPoint> InData,
-		TVoxelArrayView<FIntPoint> OutData,
-		int32 Step);
-};
\ No newline at end of file
+		TVoxelArray<int32>& InOutClosestX,
+		TVoxelArray<int32>& InOutClosestY,
+		TVoxelArrayView<float> OutDistances);
+};
@@ -0,0 +1,79 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "VoxelMinimal.h"
+
+// Index/vertex reordering passes for voxel meshes, run before Nanite building or collision cooking
+// Passes don't use any global state and can be run on many chunks at once with Voxel::ParallelFor
+struct VOXELCORE_API FVoxelMeshOptimizer
+{
+public:
+	// Merge vertices whose positions round to the same point on a grid of size Tolerance
+	// Triangles that become degenerate are removed
+	// Returns NewToOldVertex, use RemapVertices to apply it to other vertex attributes
+	static TVoxelArray<int32> WeldVertices(
+		TVoxelArray<int32>& Indices,
+		TVoxelArray<FVector3f>& Vertices,
+		float Tolerance);
+
+	// Tipsify, see Sander et al. 2007, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"
+	// Reorders triangles to improve post-transform vertex cache hits
+	static void OptimizeVertexCache(
+		TVoxelArrayView<int32> Indices,
+		int32 NumVertices,
+		int32 CacheSize = 16);
+
+	// Reorders the clusters found by OptimizeVertexCache front to back from the outside,
+	// reducing overdraw without hurting vertex cache locality much
+	static void OptimizeOverdraw(
+		TVoxelArrayView<int32> Indices,
+		TConstVoxelArrayView<FVector3f> Vertices,
+		int32 CacheSize = 16);
+
+	// Reorders vertices in the order they're first referenced by Indices
+	// Unreferenced vertices are removed
+	// Returns NewToOldVertex, use RemapVertices to apply it to the vertex attributes
+	static TVoxelArray<int32> OptimizeVertexFetch(
+		TVoxelArrayView<int32> Indices,
+		int32 NumVertices);
+
+	// Sort triangles along a Morton curve of their centroid
+	// Makes consecutive triangles spatially close, which helps Nanite clustering and BVH builds
+	static void SortTrianglesSpatially(
+		TVoxelArrayView<int32> Indices,
+		TConstVoxelArrayView<FVector3f> Vertices);
+
+	// Average number of vertex shader invocations per triangle with a FIFO cache of CacheSize
+	// 0.5 is ideal on regular grids, 3 is the worst case
+	static float ComputeACMR(
+		TConstVoxelArrayView<int32> Indices,
+		int32 NumVertices,
+		int32 CacheSize = 16);
+
+public:
+	template<typename T>
+	static void RemapVertices(
+		TVoxelArray<T>& Vertices,
+		const TConstVoxelArrayView<int32> NewToOldVertex)
+	{
+		VOXEL_FUNCTION_COUNTER_NUM(NewToOldVertex.Num());
+
+		TVoxelArray<T> NewVertices;
+		FVoxelUtilities::SetNumFast(NewVertices, NewToOldVertex.Num());
+
+		Voxel::ParallelFor(NewVertices, [&](T& Vertex, const int32 Index)
+		{
+			Vertex = Vertices[NewToOldVertex[Index]];
+		});
+
+		Vertices = MoveTemp(NewVertices);
+	}
+
+private:
+	static void Tipsify(
+		TVoxelArrayView<int32> Indices,
+		int32 NumVertices,
+		int32 CacheSize,
+		TVoxelArray<int32>* OutClusterStarts);
+};
@@ -35,6 +35,7 @@
 
 #include "VoxelCoreMinimal.h"
 
+#include "VoxelMinimal/VoxelArena.h"
 #include "VoxelMinimal/VoxelArchive.h"
 #include "VoxelMinimal/VoxelAsset.h"
 #include "VoxelMinimal/VoxelAtomic.h"
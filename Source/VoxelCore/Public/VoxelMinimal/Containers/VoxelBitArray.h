@@ -119,29 +119,39 @@ public:
 public:
 	void BitwiseOr(const TVoxelBitArray& Other)
 	{
-		VOXEL_FUNCTION_COUNTER_NUM(Num(), 128);
 		checkVoxelSlow(Num() == Other.Num());
 
 		EnsurePartialSlackBitsCleared();
 		Other.EnsurePartialSlackBitsCleared();
 
-		for (int32 WordIndex = 0; WordIndex < NumWords(); WordIndex++)
-		{
-			GetWord(WordIndex) |= Other.GetWord(WordIndex);
-		}
+		View().BitwiseOr(Other.View());
 	}
 	void BitwiseAnd(const TVoxelBitArray& Other)
 	{
-		VOXEL_FUNCTION_COUNTER_NUM(Num(), 128);
 		checkVoxelSlow(Num() == Other.Num());
 
 		EnsurePartialSlackBitsCleared();
 		Other.EnsurePartialSlackBitsCleared();
 
-		for (int32 WordIndex = 0; WordIndex < NumWords(); WordIndex++)
-		{
-			GetWord(WordIndex) &= Other.GetWord(WordIndex);
-		}
+		View().BitwiseAnd(Other.View());
+	}
+	void BitwiseXor(const TVoxelBitArray& Other)
+	{
+		checkVoxelSlow(Num() == Other.Num());
+
+		EnsurePartialSlackBitsCleared();
+		Other.EnsurePartialSlackBitsCleared();
+
+		View().BitwiseXor(Other.View());
+	}
+	void BitwiseAndNot(const TVoxelBitArray& Other)
+	{
+		checkVoxelSlow(Num() == Other.Num());
+
+		EnsurePartialSlackBitsCleared();
+		Other.EnsurePartialSlackBitsCleared();
+
+		View().BitwiseAndNot(Other.View());
 	}
 
 public:
@@ -176,6 +186,18 @@ public:
 	{
 		return View().CountSetBits();
 	}
+	FORCEINLINE int32 FindFirstSetBit() const
+	{
+		return View().FindFirstSetBit();
+	}
+	FORCEINLINE int32 FindFirstUnsetBit() const
+	{
+		return View().FindFirstUnsetBit();
+	}
+	FORCEINLINE TVoxelArray<int32> GetSetBitIndices() const
+	{
+		return View().GetSetBitIndices();
+	}
 
 public:
 	FORCEINLINE int64 GetAllocatedSize() const
@@ -170,6 +170,15 @@ public:
 	TVoxelOptional<bool> TryGetAll() const;
 	bool AllEqual(bool bValue) const;
 	int32 CountSetBits() const;
+	int32 CountSetBits(int32 StartIndex, int32 NumToCount) const;
+
+	// Returns -1 if not found
+	int32 FindFirstSetBit() const;
+	int32 FindFirstUnsetBit() const;
+
+	TVoxelArray<int32> GetSetBitIndices() const;
+	// Indices of the bits set in this and not set in Other
+	TVoxelArray<int32> GetSetBitIndices_AndNot(const FConstVoxelBitArrayView& Other) const;
 
 public:
 	FORCEINLINE bool TestRange(
@@ -295,6 +304,9 @@ public:
 public:
 	void BitwiseOr(const FConstVoxelBitArrayView& Other) const;
 	void BitwiseAnd(const FConstVoxelBitArrayView& Other) const;
+	void BitwiseXor(const FConstVoxelBitArrayView& Other) const;
+	// this &= ~Other
+	void BitwiseAndNot(const FConstVoxelBitArrayView& Other) const;
 
 	// Values will be zeroed
 	TVoxelArray<FVoxelIntBox2D> GreedyMeshing2D(const FIntPoint& Size) const;
@@ -430,6 +430,63 @@ public:
 		}
 	}
 
+	// Much faster than adding elements one by one for large arrays: keys are hashed and deduplicated in parallel,
+	// and the hash table is built in one go
+	// Keeps the first value of each key, in the order of Keys
+	void BuildFromArrays(
+		const TConstVoxelArrayView<KeyType> Keys,
+		const TConstVoxelArrayView<ValueType> Values)
+	{
+		VOXEL_FUNCTION_COUNTER_NUM(Keys.Num(), 1024);
+		check(Keys.Num() == Values.Num());
+
+		Reset();
+
+		if (Keys.Num() < FVoxelUtilities::ParallelHashTableThreshold)
+		{
+			this->Reserve(Keys.Num());
+
+			for (int32 Index = 0; Index < Keys.Num(); Index++)
+			{
+				const KeyType& Key = Keys[Index];
+				const uint32 Hash = this->HashValue(Key);
+
+				if (!this->FindHashed(Hash, Key))
+				{
+					this->AddHashed_CheckNew_EnsureNoGrow(Hash, Key, Values[Index]);
+				}
+			}
+			return;
+		}
+
+		FVoxelUtilities::SetNumFast(HashTable, FMath::Max(GetHashSize(Keys.Num()), 256));
+		Elements.Reserve(Keys.Num());
+
+		FElement* RESTRICT ElementData = Elements.GetData();
+
+		const int32 NumElements = FVoxelUtilities::BuildHashTable(
+			HashTable,
+			Keys.Num(),
+			[&](const int32 Index)
+			{
+				return HashValue(Keys[Index]);
+			},
+			[&](const int32 IndexA, const int32 IndexB)
+			{
+				return Keys[IndexA] == Keys[IndexB];
+			},
+			[&](const int32 ElementIndex, const int32 Index, const int32 NextElementIndex)
+			{
+				FElement& Element = *new (&ElementData[ElementIndex]) FElement(Keys[Index], Values[Index]);
+				Element.NextElementIndex = NextElementIndex;
+			});
+
+		// Elements were constructed in place
+		Elements.AddUninitialized(NumElements);
+
+		CheckInvariants();
+	}
+
 	TVoxelArray<KeyType> KeyArray() const
 	{
 		VOXEL_FUNCTION_COUNTER_NUM(Num(), 1024);
@@ -218,7 +218,20 @@ public:
 	}
 	void Append(const TConstVoxelArrayView<Type> Array)
 	{
-		this->Append<Type>(Array);
+		if (Array.Num() < FVoxelUtilities::ParallelHashTableThreshold)
+		{
+			this->Append<Type>(Array);
+			return;
+		}
+
+		VOXEL_FUNCTION_COUNTER_NUM(Array.Num(), 1024);
+
+		TVoxelSet Result;
+		Result.BuildParallel(Num() + Array.Num(), [&](const int32 Index) -> const Type&
+		{
+			return Index < Num() ? Elements[Index].Value : Array[Index - Num()];
+		});
+		*this = MoveTemp(Result);
 	}
 	template<typename OtherType>
 	requires std::is_constructible_v<Type, OtherType>
@@ -269,6 +282,21 @@ public:
 
 		VOXEL_FUNCTION_COUNTER_NUM(Other.Num(), 1024);
 
+		if (Other.Num() >= FVoxelUtilities::ParallelHashTableThreshold)
+		{
+			const TVoxelArray<int32> Indices = FVoxelUtilities::CompactIndices(Other.Num(), [&](const int32 Index)
+			{
+				return this->Contains(Other.Elements[Index].Value);
+			});
+
+			TVoxelSet Result;
+			Result.BuildParallel(Indices.Num(), [&](const int32 Index) -> const Type&
+			{
+				return Other.Elements[Indices[Index]].Value;
+			});
+			return Result;
+		}
+
 		TVoxelSet Result;
 		Result.Reserve(Other.Num());
 
@@ -287,6 +315,16 @@ public:
 	{
 		VOXEL_FUNCTION_COUNTER_NUM(Num() + Other.Num(), 1024);
 
+		if (Num() + Other.Num() >= FVoxelUtilities::ParallelHashTableThreshold)
+		{
+			TVoxelSet Result;
+			Result.BuildParallel(Num() + Other.Num(), [&](const int32 Index) -> const Type&
+			{
+				return Index < Num() ? Elements[Index].Value : Other.Elements[Index - Num()].Value;
+			});
+			return Result;
+		}
+
 		TVoxelSet Result;
 		Result.Reserve(Num() + Other.Num());
 
@@ -305,6 +343,21 @@ public:
 	{
 		VOXEL_FUNCTION_COUNTER_NUM(Num(), 1024);
 
+		if (Num() >= FVoxelUtilities::ParallelHashTableThreshold)
+		{
+			const TVoxelArray<int32> Indices = FVoxelUtilities::CompactIndices(Num(), [&](const int32 Index)
+			{
+				return !Other.Contains(Elements[Index].Value);
+			});
+
+			TVoxelSet Result;
+			Result.BuildParallel(Indices.Num(), [&](const int32 Index) -> const Type&
+			{
+				return Elements[Indices[Index]].Value;
+			});
+			return Result;
+		}
+
 		TVoxelSet Result;
 		Result.Reserve(Num()); // Worst case is no elements of this are in Other
 
@@ -421,6 +474,26 @@ public:
 
 		Rehash();
 	}
+	// Much faster than Append for large arrays: values are hashed and deduplicated in parallel,
+	// and the hash table is built in one go
+	// Keeps the first occurrence of each value, in the order of Values
+	void BuildFromArray(const TConstVoxelArrayView<Type> Values)
+	{
+		VOXEL_FUNCTION_COUNTER_NUM(Values.Num(), 1024);
+
+		Reset();
+
+		if (Values.Num() < FVoxelUtilities::ParallelHashTableThreshold)
+		{
+			this->Append<Type>(Values);
+			return;
+		}
+
+		this->BuildParallel(Values.Num(), [&](const int32 Index) -> const Type&
+		{
+			return Values[Index];
+		});
+	}
 
 	friend FArchive& operator<<(FArchive& Ar, TVoxelSet& Set)
 	{
@@ -894,6 +967,47 @@ private:
 
 		Rehash();
 	}
+	template<typename LambdaType>
+	void BuildParallel(const int32 NumValues, LambdaType GetValue)
+	{
+		checkVoxelSlow(Num() == 0);
+
+		if (NumValues == 0)
+		{
+			return;
+		}
+
+		FVoxelUtilities::SetNumFast(HashTable, FMath::Max(GetHashSize(NumValues), 256));
+		Elements.Reserve(NumValues);
+
+		FElement* RESTRICT ElementData = Elements.GetData();
+
+		const int32 NumElements = FVoxelUtilities::BuildHashTable(
+			HashTable,
+			NumValues,
+			[&](const int32 Index)
+			{
+				return HashValue(GetValue(Index));
+			},
+			[&](const int32 IndexA, const int32 IndexB)
+			{
+				return GetValue(IndexA) == GetValue(IndexB);
+			},
+			[&](const int32 ElementIndex, const int32 Index, const int32 NextElementIndex)
+			{
+				new (&ElementData[ElementIndex]) FElement
+				{
+					GetValue(Index),
+					NextElementIndex
+				};
+			});
+
+		// Elements were constructed in place
+		Elements.AddUninitialized(NumElements);
+
+		CheckInvariants();
+	}
+
 	FORCENOINLINE void Rehash()
 	{
 		VOXEL_FUNCTION_COUNTER_NUM(Elements.Num(), 1024);
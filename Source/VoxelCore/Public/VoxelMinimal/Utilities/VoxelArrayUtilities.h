@@ -10,6 +10,8 @@
 #include "VoxelMinimal/Containers/VoxelArray.h"
 #include "VoxelMinimal/Containers/VoxelArrayView.h"
 
+struct FPackedNormal;
+
 namespace FVoxelUtilities
 {
 	FORCEINLINE bool MemoryEqual(const void* Buf1, const void* Buf2, const SIZE_T Count)
@@ -576,6 +578,43 @@ namespace FVoxelUtilities
 		TConstVoxelArrayView<float> Y,
 		TConstVoxelArrayView<float> Z);
 
+	// Will re-normalize Vectors
+	// Slower than MakeOctahedrons, but picks the quantized octahedron closest to each vector
+	VOXELCORE_API TVoxelArray<FVoxelOctahedron> MakeOctahedrons_Precise(TConstVoxelArrayView<FVector3f> Vectors);
+
+	VOXELCORE_API TVoxelArray<FVector3f> GetUnitVectors(TConstVoxelArrayView<FVoxelOctahedron> Octahedrons);
+
+	VOXELCORE_API void GetUnitVectors(
+		TConstVoxelArrayView<FVoxelOctahedron> Octahedrons,
+		TVoxelArrayView<float> OutX,
+		TVoxelArrayView<float> OutY,
+		TVoxelArrayView<float> OutZ);
+
+	// Octahedrons quantized to NumBits per axis, packed as X | Y << NumBits
+	// Same as Nanite's normal encoding with NormalBits = NumBits
+	// Will re-normalize Vectors
+	VOXELCORE_API TVoxelArray<uint32> MakeQuantizedOctahedrons(
+		TConstVoxelArrayView<FVector3f> Vectors,
+		int32 NumBits);
+
+	// If NumBits is 8 this only repacks the octahedrons, without re-encoding
+	VOXELCORE_API TVoxelArray<uint32> MakeQuantizedOctahedrons(
+		TConstVoxelArrayView<FVoxelOctahedron> Octahedrons,
+		int32 NumBits);
+
+	// Same as above, writing to an existing buffer to avoid allocating
+	VOXELCORE_API void MakeQuantizedOctahedrons(
+		TConstVoxelArrayView<FVoxelOctahedron> Octahedrons,
+		int32 NumBits,
+		TVoxelArrayView<uint32> OutQuantizedOctahedrons);
+
+	VOXELCORE_API TVoxelArray<FVector3f> GetUnitVectors(
+		TConstVoxelArrayView<uint32> QuantizedOctahedrons,
+		int32 NumBits);
+
+	VOXELCORE_API TVoxelArray<FPackedNormal> MakePackedNormals(TConstVoxelArrayView<FVoxelOctahedron> Octahedrons);
+	VOXELCORE_API TVoxelArray<FVoxelOctahedron> MakeOctahedrons(TConstVoxelArrayView<FPackedNormal> Normals);
+
 	// Will replace -0 by +0
 	VOXELCORE_API void FixupSignBit(TVoxelArrayView<float> Data);
 
@@ -583,6 +622,61 @@ namespace FVoxelUtilities
 	//////////////////////////////////////////////////////////////////////////////
 	//////////////////////////////////////////////////////////////////////////////
 
+	// Stable LSD radix sort, 8 bits per pass
+	// Passes where all keys share the same digit are skipped
+	VOXELCORE_API void RadixSort(TVoxelArrayView<uint32> Keys);
+	VOXELCORE_API void RadixSort(TVoxelArrayView<uint64> Keys);
+
+	// Values are reordered along with Keys
+	VOXELCORE_API void RadixSort(
+		TVoxelArrayView<uint32> Keys,
+		TVoxelArrayView<int32> Values);
+	VOXELCORE_API void RadixSort(
+		TVoxelArrayView<uint64> Keys,
+		TVoxelArrayView<int32> Values);
+
+	// Data and OutData can be the same
+	// Returns the sum of Data
+	VOXELCORE_API int32 ExclusiveScan(
+		TConstVoxelArrayView<int32> Data,
+		TVoxelArrayView<int32> OutData);
+	VOXELCORE_API int32 InclusiveScan(
+		TConstVoxelArrayView<int32> Data,
+		TVoxelArrayView<int32> OutData);
+
+	// All values must be < NumBins
+	VOXELCORE_API TVoxelArray<int32> Histogram(
+		TConstVoxelArrayView<uint32> Data,
+		int32 NumBins);
+
+	// Returns the indices of the non-zero elements of Mask, in order
+	VOXELCORE_API TVoxelArray<int32> CompactIndices(TConstVoxelArrayView<uint8> Mask);
+	// Returns the indices for which Predicate is true, in order
+	// Predicate is called in parallel
+	VOXELCORE_API TVoxelArray<int32> CompactIndices(
+		int32 Num,
+		TFunctionRef<bool(int32 Index)> Predicate);
+
+	// Below that TVoxelSet/TVoxelMap are built one element at a time
+	constexpr int32 ParallelHashTableThreshold = 16 * 1024;
+
+	// Fill the hash table of a TVoxelSet/TVoxelMap in parallel, see TVoxelSet::BuildFromArray
+	// Elements are partitioned by bucket so that each thread owns a disjoint range of HashTable
+	// Duplicates are removed, keeping the first occurrence
+	// Emplace is called once per unique element, with ElementIndex increasing with Index
+	// All lambdas are called in parallel, Equal only on elements with the same hash
+	// Returns the number of unique elements
+	VOXELCORE_API int32 BuildHashTable(
+		TVoxelArrayView<int32> HashTable,
+		int32 Num,
+		TFunctionRef<uint32(int32 Index)> GetHash,
+		TFunctionRef<bool(int32 IndexA, int32 IndexB)> Equal,
+		TFunctionRef<void(int32 ElementIndex, int32 Index, int32 NextElementIndex)> Emplace);
+
+	//////////////////////////////////////////////////////////////////////////////
+	//////////////////////////////////////////////////////////////////////////////
+	//////////////////////////////////////////////////////////////////////////////
+
 	VOXELCORE_API bool IsCompressedData(TConstVoxelArrayView64<uint8> CompressedData);
 
 	VOXELCORE_API TVoxelArray64<uint8> Compress(
@@ -21,6 +21,7 @@ namespace FVoxelUtilities
 	//////////////////////////////////////////////////////////////////////////////
 	//////////////////////////////////////////////////////////////////////////////
 
+	// See FVoxelInvokerChunkTracker to update the chunks incrementally when invokers move
 	VOXELCORE_API bool ComputeInvokerChunks(
 		TVoxelSet<FIntVector>& OutChunks,
 		TVoxelArray<FSphere> Invokers,
@@ -125,6 +125,14 @@ namespace Voxel
 		return FVoxelFuture::Execute(EVoxelFutureThread::AsyncThread, MoveTemp(Lambda));
 	}
 
+	// Lambda can access UObjects without being on the game thread, see EVoxelFutureThread::GCSafeThread
+	template<typename LambdaType, typename ReturnType = LambdaReturnType_T<LambdaType>>
+	requires LambdaHasSignature_V<LambdaType, ReturnType()>
+	FORCEINLINE TVoxelFutureType<ReturnType> GCSafeTask(LambdaType Lambda)
+	{
+		return FVoxelFuture::Execute(EVoxelFutureThread::GCSafeThread, MoveTemp(Lambda));
+	}
+
 	//////////////////////////////////////////////////////////////////////////////
 	//////////////////////////////////////////////////////////////////////////////
 	//////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,338 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "VoxelCoreMinimal.h"
+#include "VoxelMinimal/VoxelAtomic.h"
+#include "VoxelMinimal/Containers/VoxelMap.h"
+#include "VoxelMinimal/Containers/VoxelSet.h"
+#include "VoxelMinimal/Containers/VoxelArray.h"
+
+// Fill arena memory with garbage on allocation and free to catch use-after-free
+#ifndef VOXEL_ARENA_POISON
+#define VOXEL_ARENA_POISON VOXEL_DEBUG
+#endif
+
+DECLARE_VOXEL_MEMORY_STAT(VOXELCORE_API, STAT_VoxelArenaMemory, "Voxel Arena Memory");
+DECLARE_VOXEL_MEMORY_STAT(VOXELCORE_API, STAT_VoxelArenaCachedMemory, "Voxel Arena Cached Memory");
+
+extern VOXELCORE_API const uint32 GVoxelArenaTLS;
+
+// Scoped bump allocator for transient data, avoiding malloc contention in tasks
+// While alive, the arena is the current arena of its thread and is used by TVoxelArenaArray/TVoxelArenaMap/TVoxelArenaSet
+// Containers using the arena must be destroyed before it, and must not be resized from other threads
+// Chunks are cached per thread and reused by the next arena
+//
+// {
+//     FVoxelArena Arena;
+//     TVoxelArenaArray<int32> Indices;
+//     TVoxelArenaMap<FName, int32> NameToCount;
+// }
+class VOXELCORE_API FVoxelArena
+{
+public:
+	static constexpr int64 ChunkSize = 64 * 1024;
+	// Allocations larger than this get their own chunk, which isn't cached
+	static constexpr int64 MaxSmallAllocationSize = ChunkSize / 4;
+
+	FVoxelArena();
+	~FVoxelArena();
+	UE_NONCOPYABLE(FVoxelArena);
+
+	VOXEL_ALLOCATED_SIZE_TRACKER(STAT_VoxelArenaMemory);
+
+	FORCEINLINE int64 GetAllocatedSize() const
+	{
+		return AllocatedSize;
+	}
+	// Number of bytes in use, including alignment padding
+	FORCEINLINE int64 GetUsedSize() const
+	{
+		return UsedSize;
+	}
+	// Max number of bytes in use at once, including alignment padding
+	FORCEINLINE int64 GetHighWaterMark() const
+	{
+		return HighWaterMark;
+	}
+
+	// Innermost arena alive on this thread, if any
+	FORCEINLINE static FVoxelArena* GetCurrent()
+	{
+		return static_cast<FVoxelArena*>(FPlatformTLS::GetTlsValue(GVoxelArenaTLS));
+	}
+
+public:
+	FORCEINLINE void* Allocate(const int64 Size, const uint32 Alignment)
+	{
+		checkVoxelSlow(Size > 0);
+		checkVoxelSlow(FMath::IsPowerOfTwo(Alignment));
+		checkVoxelSlow(ThreadId == FPlatformTLS::GetCurrentThreadId());
+
+		uint8* Result = Align(Current, Alignment);
+		if (Size > MaxSmallAllocationSize ||
+			Result + Size > End)
+		{
+			return AllocateSlow(Size, Alignment);
+		}
+
+		UsedSize += Result + Size - Current;
+		HighWaterMark = FMath::Max(HighWaterMark, UsedSize);
+		LastAllocation = Result;
+		LastAllocationStart = Current;
+		Current = Result + Size;
+
+#if VOXEL_ARENA_POISON
+		FMemory::Memset(Result, 0xCD, Size);
+		NumLiveAllocations++;
+#endif
+
+		return Result;
+	}
+	// Small allocations are only reclaimed if Pointer is the last allocation
+	FORCEINLINE void Free(void* Pointer, const int64 Size)
+	{
+		checkVoxelSlow(Pointer);
+		checkVoxelSlow(ThreadId == FPlatformTLS::GetCurrentThreadId());
+
+#if VOXEL_ARENA_POISON
+		FMemory::Memset(Pointer, 0xDD, Size);
+		NumLiveAllocations--;
+#endif
+
+		if (Size > MaxSmallAllocationSize)
+		{
+			FreeLarge(Pointer, Size);
+			return;
+		}
+
+		if (static_cast<uint8*>(Pointer) + Size != Current)
+		{
+			return;
+		}
+
+		// Also reclaim the alignment padding if we know it
+		uint8* NewCurrent = static_cast<uint8*>(Pointer);
+		if (Pointer == LastAllocation)
+		{
+			NewCurrent = LastAllocationStart;
+		}
+
+		UsedSize -= Current - NewCurrent;
+		Current = NewCurrent;
+		LastAllocation = nullptr;
+	}
+	// Grows or shrinks in place if Pointer is the last allocation
+	// NumBytesToCopy is the number of bytes actually used in the old allocation
+	void* Reallocate(
+		void* Pointer,
+		int64 OldSize,
+		int64 NewSize,
+		uint32 Alignment,
+		int64 NumBytesToCopy);
+
+private:
+	const uint32 ThreadId;
+	FVoxelArena* const PreviousArena;
+
+	uint8* Current = nullptr;
+	uint8* End = nullptr;
+	// Position of Current before the last allocation, used to reclaim its alignment padding when freeing it
+	uint8* LastAllocation = nullptr;
+	uint8* LastAllocationStart = nullptr;
+
+	int64 UsedSize = 0;
+	int64 HighWaterMark = 0;
+	int64 AllocatedSize = 0;
+#if VOXEL_ARENA_POISON
+	int64 NumLiveAllocations = 0;
+#endif
+
+	struct FChunk
+	{
+		uint8* Data = nullptr;
+		int64 Size = 0;
+	};
+	TVoxelInlineArray<FChunk, 4> Chunks;
+
+	FORCEINLINE static uint8* Align(uint8* Pointer, const uint32 Alignment)
+	{
+		return reinterpret_cast<uint8*>(::Align(reinterpret_cast<UPTRINT>(Pointer), Alignment));
+	}
+
+	void* AllocateSlow(int64 Size, uint32 Alignment);
+	void FreeLarge(void* Pointer, int64 Size);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+// Allocates from the arena that was current when the container was constructed
+// Falls back to the heap if there was none
+class FVoxelArenaAllocator
+{
+public:
+	using SizeType = int32;
+
+	enum { NeedsElementType = true };
+	enum { RequireRangeCheck = true };
+
+	template<typename ElementType>
+	class ForElementType
+	{
+	public:
+		static constexpr uint32 Alignment = FMath::Max<uint32>(alignof(ElementType), 8);
+
+		ForElementType()
+			: Arena(FVoxelArena::GetCurrent())
+		{
+		}
+		FORCEINLINE ~ForElementType()
+		{
+			Free();
+		}
+		UE_NONCOPYABLE(ForElementType);
+
+		FORCEINLINE void MoveToEmpty(ForElementType& Other)
+		{
+			checkVoxelSlow(this != &Other);
+
+			Free();
+
+			Arena = Other.Arena;
+			Data = Other.Data;
+			AllocatedSize = Other.AllocatedSize;
+
+			Other.Data = nullptr;
+			Other.AllocatedSize = 0;
+		}
+
+		FORCEINLINE ElementType* GetAllocation() const
+		{
+			return Data;
+		}
+		void ResizeAllocation(
+			const SizeType PreviousNumElements,
+			const SizeType NumElements,
+			const SIZE_T NumBytesPerElement)
+		{
+			const int64 NewSize = int64(NumElements) * NumBytesPerElement;
+
+			if (!Arena)
+			{
+				Data = static_cast<ElementType*>(FMemory::Realloc(Data, NewSize, Alignment));
+				AllocatedSize = Data ? NewSize : 0;
+				return;
+			}
+
+			Data = static_cast<ElementType*>(Arena->Reallocate(
+				Data,
+				AllocatedSize,
+				NewSize,
+				Alignment,
+				int64(PreviousNumElements) * NumBytesPerElement));
+
+			AllocatedSize = Data ? NewSize : 0;
+		}
+
+		FORCEINLINE SizeType CalculateSlackReserve(
+			const SizeType NumElements,
+			const SIZE_T NumBytesPerElement) const
+		{
+			return DefaultCalculateSlackReserve(NumElements, NumBytesPerElement, false, Alignment);
+		}
+		FORCEINLINE SizeType CalculateSlackShrink(
+			const SizeType NumElements,
+			const SizeType NumAllocatedElements,
+			const SIZE_T NumBytesPerElement) const
+		{
+			return DefaultCalculateSlackShrink(NumElements, NumAllocatedElements, NumBytesPerElement, false, Alignment);
+		}
+		FORCEINLINE SizeType CalculateSlackGrow(
+			const SizeType NumElements,
+			const SizeType NumAllocatedElements,
+			const SIZE_T NumBytesPerElement) const
+		{
+			return DefaultCalculateSlackGrow(NumElements, NumAllocatedElements, NumBytesPerElement, false, Alignment);
+		}
+
+		FORCEINLINE SIZE_T GetAllocatedSize(
+			const SizeType NumAllocatedElements,
+			const SIZE_T NumBytesPerElement) const
+		{
+			return NumAllocatedElements * NumBytesPerElement;
+		}
+		FORCEINLINE bool HasAllocation() const
+		{
+			return Data != nullptr;
+		}
+		FORCEINLINE SizeType GetInitialCapacity() const
+		{
+			return 0;
+		}
+
+	private:
+		FVoxelArena* Arena;
+		ElementType* Data = nullptr;
+		int64 AllocatedSize = 0;
+
+		FORCEINLINE void Free()
+		{
+			if (!Data)
+			{
+				return;
+			}
+
+			if (Arena)
+			{
+				Arena->Free(Data, AllocatedSize);
+			}
+			else
+			{
+				FMemory::Free(Data);
+			}
+
+			Data = nullptr;
+			AllocatedSize = 0;
+		}
+	};
+
+	using ForAnyElementType = ForElementType<FScriptContainerElement>;
+};
+
+template<>
+struct TAllocatorTraits<FVoxelArenaAllocator> : TAllocatorTraitsBase<FVoxelArenaAllocator>
+{
+	enum { SupportsMove = true };
+	enum { IsZeroConstruct = false };
+};
+
+struct FVoxelArenaMapAllocator
+{
+	static constexpr int32 MinHashSize = 0;
+
+	using FHashArray = TVoxelArray<int32, FVoxelArenaAllocator>;
+
+	template<typename KeyType, typename ValueType>
+	using TElementArray = TVoxelArray<TVoxelMapElement<KeyType, ValueType>, FVoxelArenaAllocator>;
+};
+
+struct FVoxelArenaSetAllocator
+{
+	static constexpr int32 MinHashSize = 0;
+
+	using FHashArray = TVoxelArray<int32, FVoxelArenaAllocator>;
+
+	template<typename Type>
+	using TElementArray = TVoxelArray<TVoxelSetElement<Type>, FVoxelArenaAllocator>;
+};
+
+template<typename T>
+using TVoxelArenaArray = TVoxelArray<T, FVoxelArenaAllocator>;
+
+template<typename KeyType, typename ValueType>
+using TVoxelArenaMap = TVoxelMap<KeyType, ValueType, FVoxelArenaMapAllocator>;
+
+template<typename Type>
+using TVoxelArenaSet = TVoxelSet<Type, FVoxelArenaSetAllocator>;
@@ -82,5 +82,6 @@ private:
 	friend class FVoxelDependencyBase;
 	friend class FVoxelDependencyManager;
 	friend class FVoxelDependencyCollector;
+	friend class FVoxelInvalidationQueue;
 };
 checkStatic(sizeof(FVoxelDependencyTracker) == 128);
\ No newline at end of file
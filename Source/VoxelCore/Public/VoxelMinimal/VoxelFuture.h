@@ -82,6 +82,10 @@ enum class EVoxelFutureThread : uint8
 	GameThread,
 	RenderThread,
 	AsyncThread,
+	// Background worker holding a GC scope guard: UObjects can be accessed, but GC is blocked until the task completes
+	// Use instead of GameThread for tasks that only need UObjects to not be garbage collected under them
+	// Must not wait on the game thread, as the game thread might be waiting on the guard to collect garbage
+	GCSafeThread,
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -284,9 +288,11 @@ public:
 	Define(GameThread, _Async);
 	Define(RenderThread,);
 	Define(AsyncThread,);
+	Define(GCSafeThread,);
 
 #undef Define
 
+	// Continuations only accessing UObjects should use Then_GCSafeThread instead to not add to the game thread budget
 	template<typename LambdaType, typename ReturnType = LambdaReturnType_T<LambdaType>>
 	requires LambdaHasSignature_V<LambdaType, ReturnType()>
 	FORCEINLINE TVoxelFutureType<ReturnType> Then_GameThread(LambdaType Continuation) const
@@ -498,6 +504,7 @@ public:
 	Define(GameThread, _Async);
 	Define(RenderThread,);
 	Define(AsyncThread,);
+	Define(GCSafeThread,);
 
 #undef Define
 
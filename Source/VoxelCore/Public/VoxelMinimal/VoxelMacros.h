@@ -93,11 +93,12 @@ class VOXELCORE_API FVoxelGCScopeGuard
 public:
 	FVoxelGCScopeGuard();
 	~FVoxelGCScopeGuard();
+	UE_NONCOPYABLE(FVoxelGCScopeGuard);
 
 private:
-	struct FImpl;
-
-	TPimplPtr<FImpl> Impl;
+	// FGCScopeGuard is constructed in-place, this is taken once per GC-safe task and shouldn't malloc
+	bool bIsLocked = false;
+	TTypeCompatibleBytes<uint64> GuardStorage;
 };
 
 VOXELCORE_API bool Voxel_CanAccessUObject();
@@ -3,7 +3,11 @@
 #pragma once
 
 #include "VoxelCoreMinimal.h"
+#include "VoxelMinimal/VoxelAtomic.h"
 #include "VoxelMinimal/VoxelObjectHelpers.h"
+#include "VoxelMinimal/Containers/VoxelArrayView.h"
+
+extern VOXELCORE_API FVoxelCounter64 GVoxelGCEpoch;
 
 class VOXELCORE_API alignas(8) FVoxelObjectPtr
 {
@@ -33,6 +37,30 @@ public:
 	FString GetPathName() const;
 	FString GetReadableName() const;
 
+public:
+	// Incremented before every garbage collection
+	// Objects resolved during an epoch won't be deleted before the epoch changes,
+	// but they might be marked as garbage in the meantime
+	FORCEINLINE static uint64 GetGCEpoch()
+	{
+		return GVoxelGCEpoch.Get();
+	}
+
+	// Resolve all the pointers under a single GC guard
+	static void ResolveBatch(
+		TConstVoxelArrayView<FVoxelObjectPtr> ObjectPtrs,
+		TVoxelArrayView<UObject*> OutObjects);
+	// Only resolves if a garbage collection happened since InOutEpoch, and sets InOutEpoch to the current epoch
+	// InOutEpoch should start at 0, and ObjectPtrs/OutObjects must be the same as in the previous call
+	// Returns true if the pointers were resolved
+	static bool ResolveBatch(
+		TConstVoxelArrayView<FVoxelObjectPtr> ObjectPtrs,
+		TVoxelArrayView<UObject*> OutObjects,
+		uint64& InOutEpoch);
+	static void GetFNameBatch(
+		TConstVoxelArrayView<FVoxelObjectPtr> ObjectPtrs,
+		TVoxelArrayView<FName> OutNames);
+
 public:
 	FORCEINLINE bool IsExplicitlyNull() const
 	{
@@ -137,6 +165,25 @@ public:
 		return Object;
 	}
 
+	FORCEINLINE static void ResolveBatch(
+		const TConstVoxelArrayView<TVoxelObjectPtr> ObjectPtrs,
+		const TVoxelArrayView<ObjectType*> OutObjects)
+	{
+		FVoxelObjectPtr::ResolveBatch(
+			ObjectPtrs.template ReinterpretAs<FVoxelObjectPtr>(),
+			OutObjects.template ReinterpretAs<UObject*>());
+	}
+	FORCEINLINE static bool ResolveBatch(
+		const TConstVoxelArrayView<TVoxelObjectPtr> ObjectPtrs,
+		const TVoxelArrayView<ObjectType*> OutObjects,
+		uint64& InOutEpoch)
+	{
+		return FVoxelObjectPtr::ResolveBatch(
+			ObjectPtrs.template ReinterpretAs<FVoxelObjectPtr>(),
+			OutObjects.template ReinterpretAs<UObject*>(),
+			InOutEpoch);
+	}
+
 public:
 	template<typename ChildType>
 	requires
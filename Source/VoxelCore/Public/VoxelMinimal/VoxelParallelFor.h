@@ -20,6 +20,8 @@
 #include "Async/ParallelFor.h"
 #endif
 
+extern VOXELCORE_API int32 GVoxelParallelForMaxNumThreads;
+
 namespace Voxel
 {
 	namespace Internal
@@ -0,0 +1,102 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+#if PLATFORM_CPU_X86_FAMILY
+#if PLATFORM_WINDOWS
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+// Built-in profiler recording VOXEL_SCOPE_COUNTER scopes, independently of Unreal Insights
+// Scopes are written to per-thread ring buffers, see voxel.Profiler.Start/Stop/Export/Dump
+#ifndef VOXEL_PROFILER
+#define VOXEL_PROFILER 1
+#endif
+
+#if VOXEL_PROFILER
+// Read by every scope on every thread, written by the console commands
+extern VOXELCORE_API std::atomic<bool> GVoxelProfilerEnabled;
+
+class VOXELCORE_API FVoxelProfiler
+{
+public:
+	FORCEINLINE static bool IsEnabled()
+	{
+		return GVoxelProfilerEnabled.load(std::memory_order_relaxed);
+	}
+	FORCEINLINE static uint64 GetTimestamp()
+	{
+#if PLATFORM_CPU_X86_FAMILY
+		return __rdtsc();
+#else
+		return FPlatformTime::Cycles64();
+#endif
+	}
+
+	// Called when a scope ends, lock-free
+	static void AddScope(
+		FName Name,
+		uint64 StartTimestamp,
+		uint64 EndTimestamp);
+
+public:
+	// Clears all the recorded scopes
+	static void Start();
+	static void Stop();
+
+	// Chrome trace event format, can be opened in chrome://tracing or ui.perfetto.dev
+	static bool ExportChromeTrace(const FString& Path);
+	// Log per-scope duration histograms, sorted by total time
+	static void DumpStats(int32 MaxNumScopes);
+};
+
+struct FVoxelProfilerScope
+{
+	FName Name;
+	uint64 StartTimestamp = 0;
+
+	FVoxelProfilerScope() = default;
+	UE_NONCOPYABLE(FVoxelProfilerScope);
+
+	FORCEINLINE void Begin(const FName NewName)
+	{
+		Name = NewName;
+		StartTimestamp = FVoxelProfiler::GetTimestamp();
+	}
+	FORCEINLINE ~FVoxelProfilerScope()
+	{
+		if (!Name.IsNone())
+		{
+			FVoxelProfiler::AddScope(Name, StartTimestamp, FVoxelProfiler::GetTimestamp());
+		}
+	}
+};
+
+#define VOXEL_PROFILER_SCOPE_COND(Condition, Description) \
+	FVoxelProfilerScope VOXEL_APPEND_LINE(__VoxelProfilerScope); \
+	if (FVoxelProfiler::IsEnabled() && (Condition)) \
+	{ \
+		static const FString StaticProfilerDescription = Description; \
+		static const FName StaticProfilerName = FName(*StaticProfilerDescription); \
+		VOXEL_APPEND_LINE(__VoxelProfilerScope).Begin(StaticProfilerName); \
+	}
+
+#define VOXEL_PROFILER_SCOPE_FNAME_COND(Condition, Description) \
+	FVoxelProfilerScope VOXEL_APPEND_LINE(__VoxelProfilerScope); \
+	if (FVoxelProfiler::IsEnabled() && (Condition)) \
+	{ \
+		VOXEL_APPEND_LINE(__VoxelProfilerScope).Begin(Description); \
+	}
+
+#define VOXEL_PROFILER_IS_ENABLED() FVoxelProfiler::IsEnabled()
+#else
+#define VOXEL_PROFILER_SCOPE_COND(Condition, Description)
+#define VOXEL_PROFILER_SCOPE_FNAME_COND(Condition, Description)
+#define VOXEL_PROFILER_IS_ENABLED() false
+#endif
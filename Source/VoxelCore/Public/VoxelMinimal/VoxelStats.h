@@ -6,6 +6,7 @@
 #include "Stats/Stats.h"
 #include "Stats/StatsMisc.h"
 #include "VoxelMacros.h"
+#include "VoxelMinimal/VoxelProfiler.h"
 #include "HAL/LowLevelMemStats.h"
 
 #define VOXEL_STATS (STATS && CPUPROFILERTRACE_ENABLED)
@@ -48,7 +49,7 @@ FORCEINLINE bool AreVoxelStatsEnabled()
 
 #define VOXEL_TRACE_ENABLED VOXEL_APPEND_LINE(__bTraceEnabled)
 
-#define VOXEL_SCOPE_COUNTER_COND(Condition, Description) \
+#define VOXEL_TRACE_SCOPE_COND(Condition, Description) \
 	VOXEL_LLM_SCOPE(); \
 	const bool VOXEL_TRACE_ENABLED = AreVoxelStatsEnabled() && (Condition); \
 	if (VOXEL_TRACE_ENABLED) \
@@ -65,7 +66,7 @@ FORCEINLINE bool AreVoxelStatsEnabled()
 		} \
 	};
 
-#define VOXEL_SCOPE_COUNTER_FNAME_COND(Condition, Description) \
+#define VOXEL_TRACE_SCOPE_FNAME_COND(Condition, Description) \
 	VOXEL_LLM_SCOPE(); \
 	const bool VOXEL_TRACE_ENABLED = AreVoxelStatsEnabled() && (Condition); \
 	if (VOXEL_TRACE_ENABLED) \
@@ -87,10 +88,22 @@ FORCEINLINE bool AreVoxelStatsEnabled()
 	return false;
 }
 
-#define VOXEL_SCOPE_COUNTER_COND(Condition, Description)
-#define VOXEL_SCOPE_COUNTER_FNAME_COND(Condition, Description)
+#define VOXEL_TRACE_SCOPE_COND(Condition, Description)
+#define VOXEL_TRACE_SCOPE_FNAME_COND(Condition, Description)
 #endif
 
+// Scopes are sent both to Unreal Insights and to the built-in profiler, see VoxelProfiler.h
+#define VOXEL_SCOPE_COUNTER_COND(Condition, Description) \
+	VOXEL_TRACE_SCOPE_COND(Condition, Description) \
+	VOXEL_PROFILER_SCOPE_COND(Condition, Description)
+
+// Description is usually formatted, only evaluate it once
+#define VOXEL_SCOPE_COUNTER_FNAME_COND(Condition, Description) \
+	const bool VOXEL_APPEND_LINE(__VoxelScopeEnabled) = (AreVoxelStatsEnabled() || VOXEL_PROFILER_IS_ENABLED()) && (Condition); \
+	const FName VOXEL_APPEND_LINE(__VoxelScopeName) = VOXEL_APPEND_LINE(__VoxelScopeEnabled) ? FName(Description) : FName(); \
+	VOXEL_TRACE_SCOPE_FNAME_COND(VOXEL_APPEND_LINE(__VoxelScopeEnabled), VOXEL_APPEND_LINE(__VoxelScopeName)) \
+	VOXEL_PROFILER_SCOPE_FNAME_COND(VOXEL_APPEND_LINE(__VoxelScopeEnabled), VOXEL_APPEND_LINE(__VoxelScopeName))
+
 VOXELCORE_API FString VoxelStats_CleanupFunctionName(const FString& FunctionName);
 VOXELCORE_API FName VARARGS VoxelStats_PrintfImpl(const TCHAR* Format, ...);
 VOXELCORE_API FName VoxelStats_AddNum(const FString& Format, int32 Num);
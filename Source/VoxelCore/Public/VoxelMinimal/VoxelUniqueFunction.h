@@ -3,21 +3,149 @@
 #pragma once
 
 #include "VoxelCoreMinimal.h"
+#include "Misc/GeneratedTypeName.h"
+#include "VoxelMinimal/VoxelAtomic.h"
 #include "VoxelMinimal/Utilities/VoxelLambdaUtilities.h"
 
-template<typename>
+// Track how often each lambda type spills to the heap, see voxel.UniqueFunction.DumpSpills
+#ifndef VOXEL_UNIQUE_FUNCTION_STATS
+#define VOXEL_UNIQUE_FUNCTION_STATS !UE_BUILD_SHIPPING
+#endif
+
+// Functors up to this size are stored inline. Pointer-sized functors are always stored inline
+// Keep the default to 0 so that TVoxelUniqueFunction stays 16 bytes: it is embedded in promise continuations and dependency trackers
+// Use an explicit InlineSize where it is worth the memory, see FVoxelTaskContext::FTaskLambda
+#ifndef VOXEL_UNIQUE_FUNCTION_INLINE_SIZE
+#define VOXEL_UNIQUE_FUNCTION_INLINE_SIZE 0
+#endif
+
+#if VOXEL_UNIQUE_FUNCTION_STATS
+extern VOXELCORE_API bool GVoxelTrackUniqueFunctionSpills;
+
+// One per functor type, ie one per lambda call site
+struct VOXELCORE_API FVoxelUniqueFunctionCallSite
+{
+	FString Name;
+	int32 FunctorSize = 0;
+	int32 InlineSize = 0;
+	FVoxelCounter64 NumBinds;
+	FVoxelCounter64 NumSpills;
+
+	static FVoxelUniqueFunctionCallSite& Register(
+		const TCHAR* Name,
+		int32 FunctorSize,
+		int32 InlineSize);
+};
+#endif
+
+template<typename, int32 InlineSize = VOXEL_UNIQUE_FUNCTION_INLINE_SIZE>
 class TVoxelUniqueFunction;
 
 template<typename>
 constexpr bool IsVoxelUniqueFunction_V = false;
 
+template<typename T, int32 InlineSize>
+constexpr bool IsVoxelUniqueFunction_V<TVoxelUniqueFunction<T, InlineSize>> = true;
+
+// Functors that can be moved with a memcpy
+// Specialize for functors that are bitwise relocatable without being trivially copyable
 template<typename T>
-constexpr bool IsVoxelUniqueFunction_V<TVoxelUniqueFunction<T>> = true;
+constexpr bool IsVoxelTriviallyRelocatable_V = std::is_trivially_copyable_v<T>;
 
 template<typename ReturnType, typename... ArgTypes>
-class TVoxelUniqueFunction<ReturnType(ArgTypes...)>
+struct TVoxelUniqueFunctionOps
+{
+	ReturnType (*Call)(void* Storage, ArgTypes&...);
+	// null if there's nothing to destroy
+	void (*Destroy)(void* Storage);
+	// Move constructs the functor into NewStorage then destroys the old one
+	// null if the functor can be memcpy-ed
+	void (*Relocate)(void* NewStorage, void* OldStorage);
+	int32 FunctorSize;
+	int32 FunctorAlignment;
+	bool bIsHeap;
+
+	// Used when moving an inline functor to a function too small to store it
+	const TVoxelUniqueFunctionOps* HeapOps;
+};
+
+template<typename FunctorType, typename ReturnType, typename... ArgTypes>
+struct TVoxelUniqueFunctionImpl
+{
+	using FOps = TVoxelUniqueFunctionOps<ReturnType, ArgTypes...>;
+
+	// Heap functors store their pointer in the inline storage
+	FORCEINLINE static FunctorType*& GetHeapFunctor(void* Storage)
+	{
+		return *static_cast<FunctorType**>(Storage);
+	}
+
+	static ReturnType CallInline(void* Storage, ArgTypes&... Args)
+	{
+		return VoxelCall<FunctorType, ReturnType, ArgTypes...>(Storage, Args...);
+	}
+	static ReturnType CallHeap(void* Storage, ArgTypes&... Args)
+	{
+		return VoxelCall<FunctorType, ReturnType, ArgTypes...>(GetHeapFunctor(Storage), Args...);
+	}
+
+	static void DestroyInline(void* Storage)
+	{
+		static_cast<FunctorType*>(Storage)->~FunctorType();
+	}
+	static void DestroyHeap(void* Storage)
+	{
+		FunctorType* Functor = GetHeapFunctor(Storage);
+		Functor->~FunctorType();
+		FMemory::Free(Functor);
+	}
+
+	static void RelocateInline(void* NewStorage, void* OldStorage)
+	{
+		FunctorType& OldFunctor = *static_cast<FunctorType*>(OldStorage);
+		new (NewStorage) FunctorType(MoveTemp(OldFunctor));
+		OldFunctor.~FunctorType();
+	}
+
+	static constexpr FOps HeapOps
+	{
+		&CallHeap,
+		&DestroyHeap,
+		// The heap pointer is always memcpy-ed
+		nullptr,
+		sizeof(FunctorType),
+		alignof(FunctorType),
+		true,
+		nullptr
+	};
+	static constexpr FOps InlineOps
+	{
+		&CallInline,
+		std::is_trivially_destructible_v<FunctorType> ? nullptr : &DestroyInline,
+		IsVoxelTriviallyRelocatable_V<FunctorType> ? nullptr : &RelocateInline,
+		sizeof(FunctorType),
+		alignof(FunctorType),
+		false,
+		&HeapOps
+	};
+};
+
+// Move-only function with inline storage for small functors
+// Moving an inline functor is a memcpy if it is trivially relocatable (see IsVoxelTriviallyRelocatable_V),
+// otherwise it is move constructed then destroyed. Heap functors are always moved by pointer
+template<int32 InlineSize, typename ReturnType, typename... ArgTypes>
+class TVoxelUniqueFunction<ReturnType(ArgTypes...), InlineSize>
 {
 public:
+	static constexpr int32 StorageSize = FMath::Max<int32>(InlineSize, sizeof(void*));
+	// Only over-align when there is real inline storage, to keep the default 16 bytes
+	static constexpr int32 StorageAlignment = InlineSize > int32(sizeof(void*)) ? 16 : alignof(void*);
+
+	template<typename FunctorType>
+	static constexpr bool CanStoreInline =
+		sizeof(FunctorType) <= StorageSize &&
+		alignof(FunctorType) <= StorageAlignment;
+
 	TVoxelUniqueFunction() = default;
 	TVoxelUniqueFunction(decltype(nullptr)) {}
 
@@ -39,105 +167,177 @@ public:
 	TVoxelUniqueFunction(const TVoxelUniqueFunction& Other) = delete;
 
 	FORCEINLINE TVoxelUniqueFunction(TVoxelUniqueFunction&& Other)
-		: Callable(Other.Callable)
-		, Allocation(Other.Allocation)
 	{
-		Other.Callable = nullptr;
-		Other.Allocation = nullptr;
+		this->MoveFrom(Other);
+	}
+	// Inline functors that don't fit are moved to the heap
+	template<int32 OtherInlineSize>
+	requires (OtherInlineSize != InlineSize)
+	FORCEINLINE TVoxelUniqueFunction(TVoxelUniqueFunction<ReturnType(ArgTypes...), OtherInlineSize>&& Other)
+	{
+		this->MoveFrom(Other);
 	}
 	FORCEINLINE ~TVoxelUniqueFunction()
 	{
-		if (Callable)
+		if (Ops)
 		{
 			Unbind();
 		}
-		checkVoxelSlow(!Callable);
-		checkVoxelSlow(!Allocation);
+		checkVoxelSlow(!Ops);
 	}
 
 	TVoxelUniqueFunction& operator=(const TVoxelUniqueFunction& Other) = delete;
 	FORCEINLINE TVoxelUniqueFunction& operator=(TVoxelUniqueFunction&& Other)
 	{
-		if (Callable)
+		checkVoxelSlow(this != &Other);
+
+		if (Ops)
 		{
 			Unbind();
 		}
-		checkVoxelSlow(!Callable);
-		checkVoxelSlow(!Allocation);
-
-		Callable = Other.Callable;
-		Allocation = Other.Allocation;
 
-		Other.Callable = nullptr;
-		Other.Allocation = nullptr;
+		this->MoveFrom(Other);
+		return *this;
+	}
+	template<int32 OtherInlineSize>
+	requires (OtherInlineSize != InlineSize)
+	FORCEINLINE TVoxelUniqueFunction& operator=(TVoxelUniqueFunction<ReturnType(ArgTypes...), OtherInlineSize>&& Other)
+	{
+		if (Ops)
+		{
+			Unbind();
+		}
 
+		this->MoveFrom(Other);
 		return *this;
 	}
 
 	FORCEINLINE ReturnType operator()(ArgTypes... Args) const
 	{
-		checkVoxelSlow(Callable && Allocation);
-		return (*Callable)(Allocation, Args...);
+		checkVoxelSlow(Ops);
+		return (*Ops->Call)(const_cast<uint8*>(Storage), Args...);
 	}
 
 	FORCEINLINE operator bool() const
 	{
-		checkVoxelSlow((Callable != nullptr) == (Allocation != nullptr));
-		return Callable != nullptr;
+		return Ops != nullptr;
 	}
 
-private:
-	struct FStorageBase
+	// True if the functor didn't fit in the inline storage
+	FORCEINLINE bool IsHeapAllocated() const
 	{
-		void (*Destroy)(void*);
-		uint64 Padding;
-	};
-	template<typename FunctorType>
-	struct TStorage : FStorageBase
+		return Ops && Ops->bIsHeap;
+	}
+
+private:
+	using FOps = TVoxelUniqueFunctionOps<ReturnType, ArgTypes...>;
+
+	// The callable is stored in Ops to keep the default instantiation at 16 bytes
+	const FOps* Ops = nullptr;
+	alignas(StorageAlignment) uint8 Storage[StorageSize];
+
+	template<typename InFunctorType>
+	FORCEINLINE void Bind(InFunctorType&& Functor)
 	{
-		FunctorType Functor;
+		checkVoxelSlow(!Ops);
 
-		explicit TStorage(FunctorType&& Functor)
-			: Functor(MoveTempIfPossible(Functor))
+		using FunctorType = std::decay_t<InFunctorType>;
+		using FImpl = TVoxelUniqueFunctionImpl<FunctorType, ReturnType, ArgTypes...>;
+
+#if VOXEL_UNIQUE_FUNCTION_STATS
+		if (GVoxelTrackUniqueFunctionSpills)
 		{
+			static FVoxelUniqueFunctionCallSite& CallSite = FVoxelUniqueFunctionCallSite::Register(
+				GetGeneratedTypeName<FunctorType>(),
+				sizeof(FunctorType),
+				InlineSize);
+
+			CallSite.NumBinds.Increment();
+
+			if constexpr (!CanStoreInline<FunctorType>)
+			{
+				CallSite.NumSpills.Increment();
+			}
 		}
+#endif
 
-		static void CallDestroy(void* RawStorage)
+		if constexpr (CanStoreInline<FunctorType>)
 		{
-			static_cast<TStorage*>(RawStorage)->~TStorage();
-			FMemory::Free(RawStorage);
+			new (Storage) FunctorType(MoveTempIfPossible(Functor));
+			Ops = &FImpl::InlineOps;
 		}
-	};
+		else
+		{
+			void* Allocation = FMemory::Malloc(sizeof(FunctorType), alignof(FunctorType));
+			FImpl::GetHeapFunctor(Storage) = new (Allocation) FunctorType(MoveTempIfPossible(Functor));
+			Ops = &FImpl::HeapOps;
+		}
+	}
+	FORCEINLINE void Unbind()
+	{
+		checkVoxelSlow(Ops);
 
-	ReturnType(*Callable)(void*, ArgTypes&...) = nullptr;
-	void* Allocation = nullptr;
+		if (Ops->Destroy)
+		{
+			(*Ops->Destroy)(Storage);
+		}
 
-	template<typename FunctorType>
-	FORCEINLINE void Bind(FunctorType&& Functor)
-	{
-		checkVoxelSlow(!Callable);
-		checkVoxelSlow(!Allocation);
+		Ops = nullptr;
+	}
 
-		using FStorage = TStorage<FunctorType>;
+	template<int32 OtherInlineSize>
+	FORCEINLINE void MoveFrom(TVoxelUniqueFunction<ReturnType(ArgTypes...), OtherInlineSize>& Other)
+	{
+		checkVoxelSlow(!Ops);
 
-		FStorage* Storage = new FStorage(MoveTempIfPossible(Functor));
-		Storage->Destroy = &FStorage::CallDestroy;
+		const FOps* OtherOps = Other.Ops;
+		if (!OtherOps)
+		{
+			return;
+		}
 
-		Callable = &VoxelCall<FunctorType, ReturnType, ArgTypes...>;
+		if (OtherOps->bIsHeap)
+		{
+			FMemory::Memcpy(Storage, Other.Storage, sizeof(void*));
+			Ops = OtherOps;
+		}
+		else if (
+			OtherInlineSize == InlineSize ||
+			(OtherOps->FunctorSize <= StorageSize && OtherOps->FunctorAlignment <= StorageAlignment))
+		{
+			RelocateInline(*OtherOps, Storage, Other.Storage);
+			Ops = OtherOps;
+		}
+		else
+		{
+			void* Allocation = FMemory::Malloc(OtherOps->FunctorSize, OtherOps->FunctorAlignment);
+			RelocateInline(*OtherOps, Allocation, Other.Storage);
+			*reinterpret_cast<void**>(Storage) = Allocation;
+			Ops = OtherOps->HeapOps;
+		}
 
-		checkStatic(offsetof(FStorage, Functor) == sizeof(FStorageBase));
-		Allocation = reinterpret_cast<uint8*>(Storage) + sizeof(FStorageBase);
+		Other.Ops = nullptr;
 	}
-	FORCEINLINE void Unbind()
-	{
-		checkVoxelSlow(Callable);
-		checkVoxelSlow(Allocation);
 
-		FStorageBase* Storage = reinterpret_cast<FStorageBase*>(static_cast<uint8*>(Allocation) - sizeof(FStorageBase));
-		checkVoxelSlow(Storage->Destroy);
-		(*Storage->Destroy)(Storage);
+	FORCEINLINE static void RelocateInline(
+		const FOps& FunctorOps,
+		void* NewStorage,
+		void* OldStorage)
+	{
+		checkVoxelSlow(!FunctorOps.bIsHeap);
 
-		Callable = nullptr;
-		Allocation = nullptr;
+		if (FunctorOps.Relocate)
+		{
+			(*FunctorOps.Relocate)(NewStorage, OldStorage);
+		}
+		else
+		{
+			FMemory::Memcpy(NewStorage, OldStorage, FunctorOps.FunctorSize);
+		}
 	}
-};
\ No newline at end of file
+
+	template<typename, int32>
+	friend class TVoxelUniqueFunction;
+};
+
+checkStatic(sizeof(TVoxelUniqueFunction<void()>) == 16);
@@ -32,6 +32,9 @@ public:
 	static constexpr int32 NormalBits = 8;
 
 	bool bCompressVertices = false;
+	// If true, clusters will be grouped & simplified into a LOD DAG so that distant meshes render fewer triangles
+	// Simplified clusters only reference vertices of the original mesh
+	bool bBuildLODs = true;
 	uint32 UniqueId = -1;
 	int32 ChunkIndex = -1;
 
@@ -63,7 +66,10 @@ private:
 
 	bool Build(FBuildData& BuildData);
 
-	TVoxelArray<TUniquePtr<FCluster>> CreateClusters() const;
+	TVoxelArray<TUniquePtr<FCluster>> CreateClusters(TConstVoxelArrayView<int32> Indices) const;
+	void BuildLODs(
+		TVoxelArray<TUniquePtr<FCluster>>& Clusters,
+		const FVoxelBox& Bounds) const;
 
 	TVoxelArray<TVoxelArray<TUniquePtr<FCluster>>> CreatePages(
 		TVoxelArray<TUniquePtr<FCluster>>& Clusters,
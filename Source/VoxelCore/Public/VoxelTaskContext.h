@@ -9,6 +9,24 @@ extern VOXELCORE_API bool GVoxelNoAsync;
 extern VOXELCORE_API FVoxelTaskContext* GVoxelGlobalTaskContext;
 extern FVoxelTaskContext* GVoxelSynchronousTaskContext;
 
+extern VOXELCORE_API float GVoxelGameTasksTimeBudgetMs;
+extern VOXELCORE_API bool GVoxelRunGCSafeTasksOnGameThread;
+
+DECLARE_VOXEL_COUNTER(VOXELCORE_API, STAT_VoxelNumDeferredGameTasks, "Num Deferred Game Tasks");
+
+struct FVoxelGameTasksStats
+{
+	// Last tick
+	int32 NumTasksProcessed = 0;
+	int32 NumTasksDeferred = 0;
+	double TimeSpent = 0;
+
+	// Since startup
+	int64 NumTicks = 0;
+	int64 NumTicksOverBudget = 0;
+	int32 MaxTasksDeferred = 0;
+};
+
 class VOXELCORE_API FVoxelTaskContextStrongRef
 {
 public:
@@ -42,6 +60,9 @@ class VOXELCORE_API FVoxelTaskContext
 {
 public:
 	using FLambdaWrapper = TVoxelUniqueFunction<TVoxelUniqueFunction<void()>(TVoxelUniqueFunction<void()>)>;
+	// Tasks usually capture a few shared pointers and arrays, store them inline to avoid a malloc per task
+	// 48 bytes of inline storage makes a task exactly one cache line
+	using FTaskLambda = TVoxelUniqueFunction<void(), 48>;
 
 	const FName Name;
 	bool bSynchronous = false;
@@ -51,6 +72,8 @@ public:
 	FLambdaWrapper LambdaWrapper;
 	TVoxelAtomic<double> TotalTime;
 	TSharedPtr<FVoxelDebugDrawGroup> DrawGroup;
+	// Max time spent running this context game tasks per frame, 0 to only use voxel.GameTasks.TimeBudgetMs
+	float GameTasksTimeBudgetMs = 0.f;
 
 private:
 	static constexpr int32 MaxLaunchedTasks = 256;
@@ -63,9 +86,12 @@ public:
 	VOXEL_COUNT_INSTANCES();
 
 public:
+	// GameTaskCostMs is an optional estimate of how long Lambda takes on the game thread
+	// Used to defer game tasks to the next frame instead of going over the time budget
 	void Dispatch(
 		EVoxelFutureThread Thread,
-		TVoxelUniqueFunction<void()> Lambda);
+		FTaskLambda Lambda,
+		float GameTaskCostMs = 0.f);
 
 	void CancelTasks();
 	void DumpToLog() const;
@@ -95,6 +121,9 @@ public:
 	{
 		return NumPendingTasks.Get();
 	}
+	int32 GetNumQueuedGameTasks() const;
+
+	static FVoxelGameTasksStats GetGameTasksStats();
 
 public:
 	// Wrap another future created in a different task context
@@ -136,26 +165,46 @@ private:
 	VOXEL_ATOMIC_PADDING;
 
 private:
-	using FTaskArray = TVoxelChunkedArray<TVoxelUniqueFunction<void()>, MaxLaunchedTasks * sizeof(TVoxelUniqueFunction<void()>) / 2>;
+	using FTaskArray = TVoxelChunkedArray<FTaskLambda, MaxLaunchedTasks * sizeof(FTaskLambda) / 2>;
 
 	int32 MaxBackgroundTasks = MaxLaunchedTasks;
 
+	struct FGameTask
+	{
+		FTaskLambda Lambda;
+		float CostMs = 0.f;
+	};
+	using FGameTaskArray = TVoxelChunkedArray<FGameTask>;
+
 	FVoxelCriticalSection GameTasksCriticalSection;
-	TVoxelChunkedArray<TVoxelUniqueFunction<void()>> GameTasks_RequiresLock;
+	FGameTaskArray GameTasks_RequiresLock;
+	// Chunk popped from GameTasks_RequiresLock, kept across frames when going over budget
+	TUniquePtr<FGameTaskArray::FChunkView> CurrentGameTasks_RequiresLock;
+	int32 CurrentGameTaskIndex_RequiresLock = 0;
 
 	FVoxelCriticalSection AsyncTasksCriticalSection;
 	FTaskArray AsyncTasks_RequiresLock;
+	// Kept apart so that the GC guard is taken by LaunchTask instead of wrapping the lambda
+	FTaskArray GCSafeTasks_RequiresLock;
 
 	bool bIsProcessingGameTasks = false;
 
 	explicit FVoxelTaskContext(FName Name);
 
 	void LaunchTasks();
-	void LaunchTask(TVoxelUniqueFunction<void()> Task);
+	void LaunchTask(FTaskLambda Task, bool bGCSafe);
+
+	int32 GetNumQueuedGameTasks_RequiresLock() const;
+	FGameTask* PeekGameTask_RequiresLock();
 
-	void ProcessGameTasks(
+	// Tasks are processed until EndTime, at least one task is processed if bAnyTaskProcessed is false
+	// Only tasks queued before the call are processed
+	// Returns the number of tasks processed
+	int32 ProcessGameTasks(
+		double EndTime,
+		bool bIgnoreContextBudget,
 		bool& bAnyTaskProcessed,
-		TVoxelChunkedArray<TVoxelUniqueFunction<void()>>& OutGameTasksToDelete);
+		FGameTaskArray& OutGameTasksToDelete);
 
 private:
 	FVoxelCriticalSection CriticalSection;
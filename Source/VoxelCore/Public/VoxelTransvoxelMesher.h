@@ -0,0 +1,64 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "VoxelMinimal.h"
+
+struct VOXELCORE_API FVoxelTransvoxelMesh
+{
+	TVoxelArray<int32> Indices;
+	TVoxelArray<FVector3f> Vertices;
+	TVoxelArray<FVector3f> Normals;
+
+	FORCEINLINE int32 NumTriangles() const
+	{
+		return Indices.Num() / 3;
+	}
+
+	int64 GetAllocatedSize() const;
+};
+
+// CPU Transvoxel extractor, see http://transvoxel.org/
+// Cell classification and edge interpolation are done in ISPC, triangles are assembled on the CPU
+// Vertices are shared between cells, normals are computed from the density gradient
+struct VOXELCORE_API FVoxelTransvoxelMesher
+{
+public:
+	int32 ChunkSize = 32;
+	float VoxelSize = 1.f;
+	// Width of the transition cells, relative to a regular cell
+	float TransitionCellWidth = 0.5f;
+
+	// (ChunkSize + 3)^3 densities starting at -1, the extra border is used to compute gradients
+	// Negative densities are inside
+	// Only one of Densities/Densities_Int16 should be set
+	TConstVoxelArrayView<float> Densities;
+	TConstVoxelArrayView<int16> Densities_Int16;
+
+	// Densities of the higher resolution neighbor on each face, used to stitch LOD seams
+	// Faces are -X +X -Y +Y -Z +Z
+	// Each face has (2 * ChunkSize + 1)^2 densities indexed by U + V * (2 * ChunkSize + 1),
+	// with U along (Axis + 1) % 3 and V along (Axis + 2) % 3
+	// Leave empty to not generate transition cells on that face
+	// Transition faces meeting at a chunk edge or corner share their border vertices,
+	// their densities must match along that edge
+	TVoxelStaticArray<TConstVoxelArrayView<float>, 6> TransitionDensities;
+
+	TSharedRef<FVoxelTransvoxelMesh> CreateMesh() const;
+
+	static TVoxelArray<TSharedPtr<FVoxelTransvoxelMesh>> CreateMeshes(TConstVoxelArrayView<FVoxelTransvoxelMesher> Meshers);
+
+private:
+	FORCEINLINE int32 GetTransitionMask() const
+	{
+		int32 Mask = 0;
+		for (int32 Face = 0; Face < 6; Face++)
+		{
+			if (TransitionDensities[Face].Num() > 0)
+			{
+				Mask |= 1 << Face;
+			}
+		}
+		return Mask;
+	}
+};
@@ -5,9 +5,12 @@
 #include "VoxelMinimal.h"
 #include "VoxelZipBase.h"
 
-class VOXELCORE_API FVoxelZipReader : public FVoxelZipBase
+class VOXELCORE_API FVoxelZipReader
+	: public FVoxelZipBase
+	, public TSharedFromThis<FVoxelZipReader>
 {
 public:
+	// Must be thread-safe if TryLoad or LoadAsync are called from multiple threads
 	using FReadLambda = TFunction<bool(int64 Offset, TVoxelArrayView64<uint8> OutData)>;
 
 	static TSharedPtr<FVoxelZipReader> Create(
@@ -30,17 +33,46 @@ public:
 		return PathToIndex.Contains(Path);
 	}
 
+	// Thread-safe
 	bool TryLoad(
 		const FString& Path,
 		TVoxelArray64<uint8>& OutData,
 		bool bAllowParallel = true,
 		int64* OutCompressedSize = nullptr) const;
 
+public:
+	struct FLoadResult
+	{
+		bool bSuccess = false;
+		int64 CompressedSize = 0;
+		TVoxelArray64<uint8> Data;
+	};
+
+	// Read, inflate & decompress all the files in parallel
+	// Futures are in the same order as Paths
+	TVoxelArray<TVoxelFuture<FLoadResult>> LoadAsync(TConstVoxelArrayView<FString> Paths) const;
+
 private:
+	struct FEntry
+	{
+		int64 LocalHeaderOffset = 0;
+		int64 CompressedSize = 0;
+		int64 UncompressedSize = 0;
+		uint32 CRC = 0;
+		uint16 Method = 0;
+		bool bIsSupported = false;
+	};
+
 	const FReadLambda ReadLambda;
 	TVoxelArray<FString> IndexToPath;
+	TVoxelArray<FEntry> IndexToEntry;
 	TVoxelMap<FString, int32> PathToIndex;
 
+	bool TryLoadImpl(
+		int32 Index,
+		TVoxelArray64<uint8>& OutData,
+		bool bAllowParallel) const;
+
 	explicit FVoxelZipReader(const FReadLambda& ReadLambda)
 		: ReadLambda(ReadLambda)
 	{
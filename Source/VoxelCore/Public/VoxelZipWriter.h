@@ -5,7 +5,9 @@
 #include "VoxelMinimal.h"
 #include "VoxelZipBase.h"
 
-class VOXELCORE_API FVoxelZipWriter : public FVoxelZipBase
+class VOXELCORE_API FVoxelZipWriter
+	: public FVoxelZipBase
+	, public TSharedFromThis<FVoxelZipWriter>
 {
 public:
 	using FWriteLambda = TFunction<void(int64 Offset, TConstVoxelArrayView64<uint8> Data)>;
@@ -36,6 +38,46 @@ public:
 		FOodleDataCompression::ECompressor Compressor = FOodleDataCompression::ECompressor::Leviathan,
 		FOodleDataCompression::ECompressionLevel CompressionLevel = FOodleDataCompression::ECompressionLevel::Optimal3);
 
+public:
+	// Thread-safe. Data is compressed on a worker thread, and a single writer then streams finished entries to disk
+	// The future completes once the entry is written: wait for all of them before calling Finalize
+	FVoxelFuture WriteCompressedAsync(
+		const FString& Path,
+		TVoxelArray64<uint8> Data);
+
+	FVoxelFuture WriteCompressedAsync_Oodle(
+		const FString& Path,
+		TVoxelArray64<uint8> Data,
+		FOodleDataCompression::ECompressor Compressor = FOodleDataCompression::ECompressor::Leviathan,
+		FOodleDataCompression::ECompressionLevel CompressionLevel = FOodleDataCompression::ECompressionLevel::Optimal3);
+
+	// If true (default), async entries are written in submission order and the archive is deterministic
+	// If false, entries are written as soon as they are compressed
+	void SetDeterministicAsyncWrites(bool bNewDeterministicAsyncWrites);
+
+private:
+	struct FAsyncEntry
+	{
+		FString Path;
+		int64 SubmitIndex = 0;
+		TVoxelArray64<uint8> Data;
+		int32 LevelAndFlags = 0;
+		int64 UncompressedSize = 0;
+		uint32 Crc32 = 0;
+		FVoxelPromise Promise;
+	};
+
+	FVoxelCriticalSection AsyncCriticalSection;
+	bool bDeterministicAsyncWrites_RequiresLock = true;
+	bool bIsWritingAsyncEntries_RequiresLock = false;
+	int64 NumAsyncEntriesSubmitted_RequiresLock = 0;
+	int64 NumAsyncEntriesReady_RequiresLock = 0;
+	int64 NumAsyncEntriesWritten_RequiresLock = 0;
+	TVoxelMap<int64, TSharedPtr<FAsyncEntry>> IndexToReadyAsyncEntry_RequiresLock;
+
+	TSharedRef<FAsyncEntry> MakeAsyncEntry(const FString& Path);
+	void OnAsyncEntryReady(const TSharedRef<FAsyncEntry>& Entry);
+
 private:
 	const FWriteLambda WriteLambda;
 
@@ -52,6 +94,15 @@ private:
 		TConstVoxelArrayView64<uint8> Data,
 		int32 Compression);
 
+	// If LevelAndFlags has MZ_ZIP_FLAG_COMPRESSED_DATA, Data is raw deflate data
+	// and UncompressedSize/Crc32 describe the uncompressed data
+	void WriteImpl(
+		const FString& Path,
+		TConstVoxelArrayView64<uint8> Data,
+		int32 LevelAndFlags,
+		int64 UncompressedSize,
+		uint32 Crc32);
+
 	void WriteToDisk(
 		int64 Offset,
 		TConstVoxelArrayView64<uint8> Data) const;